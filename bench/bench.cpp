@@ -0,0 +1,508 @@
+/**
+ * @file bench.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Benchmark suite of the comparators and tokenizers, built and run by `make bench`.
+ * @date 2022-04-24
+ *
+ * Every comparator of `distance/` is timed for single calls of compare() and for the batch functions, and every
+ * tokenizer of `preprocessing/` is timed for single strings and batches. Cases sweep the length, alphabet size, and
+ * similarity of generated strings. Results are written as JSON (see writeJson()), and can be compared to the report
+ * of a previous run to catch regressions. Run `bench --help` for options.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <thread>
+
+#include "benchmark.h"
+
+#include "stringcompare/distance/bloom.h"
+#include "stringcompare/distance/characterdifference.h"
+#include "stringcompare/distance/cosine.h"
+#include "stringcompare/distance/dameraulevenshtein.h"
+#include "stringcompare/distance/dice.h"
+#include "stringcompare/distance/filter.h"
+#include "stringcompare/distance/hamming.h"
+#include "stringcompare/distance/jaccard.h"
+#include "stringcompare/distance/jaro.h"
+#include "stringcompare/distance/jarowinkler.h"
+#include "stringcompare/distance/lcs.h"
+#include "stringcompare/distance/levenshtein.h"
+#include "stringcompare/distance/overlap.h"
+#include "stringcompare/distance/utf8.h"
+#include "stringcompare/preprocessing/bloomfilter.h"
+#include "stringcompare/preprocessing/tokenizer.h"
+#include "stringcompare/utils/stringcolumn.h"
+
+#ifndef STRINGCOMPARE_BENCH_FLAGS
+#define STRINGCOMPARE_BENCH_FLAGS "unknown"
+#endif
+
+#if defined(__clang__)
+#define STRINGCOMPARE_BENCH_COMPILER "clang " __clang_version__
+#elif defined(__GNUC__)
+#define STRINGCOMPARE_BENCH_COMPILER "gcc " __VERSION__
+#else
+#define STRINGCOMPARE_BENCH_COMPILER "unknown"
+#endif
+
+using namespace std;
+using namespace stringcompare;
+using namespace bench;
+
+/**
+ * @brief Datasets of one configuration.
+ *
+ * Single calls and elementwise comparisons run over `elementwise`, and pairwise comparisons over all pairs of
+ * `pairwise`, whose size is chosen so that each case takes a similar time across string lengths. Tokenizers run over
+ * `words`, which are strings split by spaces.
+ */
+struct Workload {
+    DataConfig config;
+    Dataset elementwise;
+    Dataset pairwise;
+    Dataset words;
+    StringColumn elementwise_left;
+    StringColumn elementwise_right;
+    StringColumn pairwise_left;
+    StringColumn pairwise_right;
+
+    Workload(const DataConfig& config, uint64_t seed) : config(config) {
+        // Each configuration has its own seed, so that its data does not depend on which other cases are run.
+        uint64_t config_seed = mix64(seed ^ mix64(config.length * 1000003 + config.alphabet * 1009
+            + (uint64_t)llround(config.similarity * 1000)));
+        DataGenerator generator(config_seed);
+
+        double length = max<size_t>(config.length, 1);
+        size_t n = clamp<size_t>(32768 / length, 32, 4096);
+        size_t n_pairwise = clamp<size_t>(1024 / sqrt(length), 16, 512);
+
+        elementwise = generator.pairs(n, config);
+        pairwise = elementwise.head(n_pairwise);
+        words = generator.pairs(n, config, true);
+        elementwise_left = StringColumn(elementwise.left);
+        elementwise_right = StringColumn(elementwise.right);
+        pairwise_left = StringColumn(pairwise.left);
+        pairwise_right = StringColumn(pairwise.right);
+    }
+
+    size_t pairwiseItems() const {
+        return pairwise.size() * pairwise.size();
+    }
+};
+
+/**
+ * @brief Single calls and batch functions over vectors of strings, which all comparators provide.
+ */
+template<class C>
+void benchComparator(Runner& runner, const string& name, const C& comparator, const Workload& w) {
+    const Dataset& e = w.elementwise;
+    const Dataset& p = w.pairwise;
+    int nthreads = runner.options.nthreads;
+
+    runner.run(Case{ "distance", name, "single", w.config, e.size() }, [&]() {
+        double total = 0;
+        for (size_t i = 0; i < e.size(); i++) {
+            total += comparator.compare(e.left[i], e.right[i]);
+        }
+        return total;
+    });
+    runner.run(Case{ "distance", name, "elementwise", w.config, e.size() }, [&]() {
+        return comparator.elementwise(e.left, e.right, nthreads)[0];
+    });
+    runner.run(Case{ "distance", name, "pairwise", w.config, w.pairwiseItems() }, [&]() {
+        return comparator.pairwise(p.left, p.right, nthreads)[0][0];
+    });
+}
+
+/**
+ * @brief benchComparator() and the batch functions over string columns of StringComparator objects.
+ */
+template<class C>
+void benchStringComparator(Runner& runner, const string& name, const C& comparator, const Workload& w) {
+    int nthreads = runner.options.nthreads;
+
+    benchComparator(runner, name, comparator, w);
+    runner.run(Case{ "distance", name, "elementwise_column", w.config, w.elementwise.size() }, [&]() {
+        return comparator.elementwise(w.elementwise_left, w.elementwise_right, nthreads)[0];
+    });
+    runner.run(Case{ "distance", name, "pairwise_column", w.config, w.pairwiseItems() }, [&]() {
+        return comparator.pairwise(w.pairwise_left, w.pairwise_right, nthreads)[0][0];
+    });
+}
+
+/**
+ * @brief Token comparators, with pairwise comparisons of profiles tokenized ahead of time.
+ */
+template<class C>
+void benchTokenComparator(Runner& runner, const string& name, const C& comparator, const Workload& w) {
+    int nthreads = runner.options.nthreads;
+
+    benchStringComparator(runner, name, comparator, w);
+
+    Case c{ "distance", name, "pairwise_profiles", w.config, w.pairwiseItems() };
+    if (runner.selected(c)) {
+        shared_ptr<Vocabulary> vocabulary = make_shared<Vocabulary>();
+        TokenProfiles p1 = comparator.profiles(w.pairwise.left, vocabulary);
+        TokenProfiles p2 = comparator.profiles(w.pairwise.right, vocabulary);
+        runner.run(c, [&]() {
+            return comparator.pairwise(p1, p2, nthreads)[0][0];
+        });
+    }
+}
+
+/**
+ * @brief Bloom filter comparators, with pairwise comparisons of filters encoded ahead of time.
+ */
+template<class C>
+void benchBloomComparator(Runner& runner, const string& name, const C& comparator, const Workload& w) {
+    int nthreads = runner.options.nthreads;
+
+    benchStringComparator(runner, name, comparator, w);
+
+    Case c{ "distance", name, "pairwise_filters", w.config, w.pairwiseItems() };
+    if (runner.selected(c)) {
+        BloomFilters f1 = comparator.encoder.encodeMany(w.pairwise.left);
+        BloomFilters f2 = comparator.encoder.encodeMany(w.pairwise.right);
+        runner.run(c, [&]() {
+            return comparator.pairwise(f1, f2, nthreads)[0][0];
+        });
+    }
+}
+
+/**
+ * @brief Filter cascades, with pairwise comparisons under a score cutoff.
+ */
+template<class C>
+void benchFilterCascade(Runner& runner, const string& name, const FilterCascade<C>& comparator, double cutoff, const Workload& w) {
+    int nthreads = runner.options.nthreads;
+
+    benchStringComparator(runner, name, comparator, w);
+    runner.run(Case{ "distance", name, "pairwise_cutoff", w.config, w.pairwiseItems() }, [&]() {
+        return comparator.pairwise(w.pairwise.left, w.pairwise.right, cutoff, nthreads)[0][0];
+    });
+}
+
+/**
+ * @brief Hamming comparator whose compareMany() interleaves `BATCH_LANES` strings, one per lane, as
+ * Levenshtein::myersBatch() does.
+ *
+ * Only used as a reference: its `pairwise` cases are compared to those of Hamming, whose compareMany() is a scalar
+ * loop over the strings.
+ */
+class InterleavedHamming : public Hamming {
+public:
+
+    using Hamming::compareMany;
+
+    void compareMany(const string& s, const string* t, size_t count, double* out) const {
+        size_t m = s.size();
+        for (size_t i0 = 0; i0 < count; i0 += BATCH_LANES) {
+            size_t lanes = min<size_t>(BATCH_LANES, count - i0);
+            const char* text[BATCH_LANES];
+            size_t n[BATCH_LANES];
+            int dist[BATCH_LANES];
+            size_t common = 0;
+            for (size_t l = 0; l < BATCH_LANES; l++) {
+                text[l] = (l < lanes) ? t[i0 + l].data() : s.data();
+                n[l] = (l < lanes) ? min(m, t[i0 + l].size()) : 0;
+                dist[l] = 0;
+                common = max(common, n[l]);
+            }
+
+            for (size_t j = 0; j < common; j++) {
+                for (size_t l = 0; l < BATCH_LANES; l++) {
+                    // Finished lanes read their first character, which strings always have (possibly '\0').
+                    size_t k = (j < n[l]) ? j : 0;
+                    dist[l] += (j < n[l]) & (s[j] != text[l][k]);
+                }
+            }
+
+            for (size_t l = 0; l < lanes; l++) {
+                double len = max(m, t[i0 + l].size());
+                out[i0 + l] = (len == 0) ? similarity : hammingScore(dist[l] + len - n[l], len);
+            }
+        }
+    }
+
+};
+
+void benchComparators(Runner& runner, const Workload& w) {
+    benchStringComparator(runner, "Levenshtein", Levenshtein(), w);
+    benchStringComparator(runner, "DamerauLevenshtein", DamerauLevenshtein(), w);
+    benchStringComparator(runner, "DamerauLevenshtein(unrestricted)", DamerauLevenshtein(true, false, 100, true), w);
+    benchStringComparator(runner, "LCSDistance", LCSDistance(), w);
+    benchStringComparator(runner, "Hamming", Hamming(), w);
+    benchComparator(runner, "Hamming(interleaved)", InterleavedHamming(), w);
+    benchStringComparator(runner, "CharacterDifference", CharacterDifference(), w);
+    benchStringComparator(runner, "Jaro", Jaro(), w);
+    benchStringComparator(runner, "JaroWinkler", JaroWinkler(), w);
+    benchStringComparator(runner, "Utf8Comparator<Levenshtein>", Utf8Comparator<Levenshtein>(), w);
+    benchStringComparator(runner, "Utf8Comparator<JaroWinkler>", Utf8Comparator<JaroWinkler>(), w);
+
+    benchComparator(runner, "StaticLevenshtein", StaticLevenshtein<true, false>(), w);
+    benchComparator(runner, "StaticDamerauLevenshtein", StaticDamerauLevenshtein<true, false>(), w);
+    benchComparator(runner, "StaticLCSDistance", StaticLCSDistance<true, false>(), w);
+    benchComparator(runner, "StaticHamming", StaticHamming<true, false>(), w);
+    benchComparator(runner, "StaticCharacterDifference", StaticCharacterDifference<true, false>(), w);
+    benchComparator(runner, "StaticJaro", StaticJaro<false>(), w);
+    benchComparator(runner, "StaticJaroWinkler", StaticJaroWinkler<false>(), w);
+
+    benchTokenComparator(runner, "Jaccard", Jaccard(NGramTokenizer(2)), w);
+    benchTokenComparator(runner, "Dice", Dice(NGramTokenizer(2)), w);
+    benchTokenComparator(runner, "Cosine", Cosine(NGramTokenizer(2)), w);
+    benchTokenComparator(runner, "Overlap", Overlap(NGramTokenizer(2)), w);
+
+    benchBloomComparator(runner, "BloomDice", BloomDice(), w);
+    benchBloomComparator(runner, "BloomJaccard", BloomJaccard(), w);
+    benchBloomComparator(runner, "BloomHamming", BloomHamming(), w);
+
+    benchFilterCascade(runner, "FilterCascade<Levenshtein>", FilterCascade<Levenshtein>(), 0.3, w);
+    benchFilterCascade(runner, "FilterCascade<LCSDistance>", FilterCascade<LCSDistance>(), 0.3, w);
+    benchFilterCascade(runner, "FilterCascade<JaroWinkler>", FilterCascade<JaroWinkler>(), 0.2, w);
+}
+
+/**
+ * @brief Tokenization of single strings and of batches.
+ */
+void benchTokenizer(Runner& runner, const string& name, const Tokenizer& tokenizer, const Workload& w) {
+    const vector<string>& l = w.words.left;
+
+    runner.run(Case{ "preprocessing", name, "tokens", w.config, l.size() }, [&]() {
+        size_t total = 0;
+        for (const string& s : l) {
+            total += tokenizer.tokens(s).size();
+        }
+        return (double)total;
+    });
+    runner.run(Case{ "preprocessing", name, "tokenize", w.config, l.size() }, [&]() {
+        size_t total = 0;
+        for (const string& s : l) {
+            total += tokenizer.tokenize(s).total();
+        }
+        return (double)total;
+    });
+    runner.run(Case{ "preprocessing", name, "tokenize_ids", w.config, l.size() }, [&]() {
+        Vocabulary vocabulary;
+        size_t total = 0;
+        for (const string& s : l) {
+            total += tokenizer.tokenizeIds(s, vocabulary).total();
+        }
+        return (double)total;
+    });
+    runner.run(Case{ "preprocessing", name, "batch_tokenize", w.config, l.size() }, [&]() {
+        return (double)tokenizer.batchTokenize(l).size();
+    });
+    runner.run(Case{ "preprocessing", name, "batch_tokenize_ids", w.config, l.size() }, [&]() {
+        Vocabulary vocabulary;
+        return (double)tokenizer.batchTokenizeIds(l, vocabulary).size();
+    });
+}
+
+void benchBloomEncoder(Runner& runner, const string& name, const BloomEncoder& encoder, const Workload& w) {
+    const vector<string>& l = w.elementwise.left;
+
+    runner.run(Case{ "preprocessing", name, "encode", w.config, l.size() }, [&]() {
+        vector<uint64_t> filter(encoder.words());
+        uint64_t total = 0;
+        for (const string& s : l) {
+            encoder.encode(s, filter.data());
+            total += filter[0];
+        }
+        return (double)total;
+    });
+    runner.run(Case{ "preprocessing", name, "encode_many", w.config, l.size() }, [&]() {
+        return (double)encoder.encodeMany(l, runner.options.nthreads).data[0];
+    });
+}
+
+void benchPreprocessing(Runner& runner, const Workload& w) {
+    benchTokenizer(runner, "WhitespaceTokenizer", WhitespaceTokenizer(), w);
+    benchTokenizer(runner, "DelimTokenizer", DelimTokenizer(" ,"), w);
+    benchTokenizer(runner, "NGramTokenizer(2)", NGramTokenizer(2), w);
+    benchTokenizer(runner, "NGramTokenizer(3)", NGramTokenizer(3), w);
+    benchBloomEncoder(runner, "BloomEncoder", BloomEncoder(), w);
+}
+
+void usage() {
+    cout <<
+        "Usage: bench [<option> ...]\n"
+        "\n"
+        "Options:\n"
+        "    --output <path>          Write the JSON report to <path> instead of standard output.\n"
+        "    --filter <string>        Only run cases whose key contains <string>, such as Levenshtein/pairwise.\n"
+        "    --lengths <list>         Comma-separated string lengths. Defaults to 8,32,128,512.\n"
+        "    --alphabets <list>       Comma-separated alphabet sizes, at most 94. Defaults to 4,26,94.\n"
+        "    --similarities <list>    Comma-separated similarity levels. Defaults to 0.5,0.9.\n"
+        "    --quick                  Small sweep: lengths 16,128, alphabet 26, similarity 0.8, 3 repeats.\n"
+        "    --repeats <n>            Number of timed repeats of each case. Defaults to 5.\n"
+        "    --min-time <seconds>     Minimum duration of each repeat. Defaults to 0.02.\n"
+        "    --threads <n>            Number of threads of batch functions. Defaults to 1.\n"
+        "    --seed <n>               Seed of the generated data. Defaults to 42.\n"
+        "    --cpu-level <level>      Widest dispatched kernels: scalar, sse4.2, avx2 or avx512.\n"
+        "    --baseline <path>        Compare median times to a previous report.\n"
+        "    --tolerance <fraction>   Slowdown reported as a regression. Defaults to 0.1.\n"
+        "    --revision <string>      Revision recorded in the report.\n"
+        "    --list                   List the keys of the selected cases without running them.\n"
+        "    --quiet                  Do not print timings as cases run.\n"
+        "\n"
+        "The exit status is 1 when cases regress compared to the baseline.\n";
+}
+
+template<class T>
+vector<T> parseList(const string& s) {
+    vector<T> result;
+    stringstream in(s);
+    string item;
+    while (getline(in, item, ',')) {
+        istringstream value(item);
+        T x;
+        if (!(value >> x)) {
+            throw runtime_error("Invalid list: " + s);
+        }
+        result.push_back(x);
+    }
+
+    return result;
+}
+
+CpuLevel parseCpuLevel(const string& s) {
+    for (CpuLevel level : { CPU_SCALAR, CPU_SSE42, CPU_AVX2, CPU_AVX512 }) {
+        if (s == cpuLevelName(level)) {
+            return level;
+        }
+    }
+    throw runtime_error("Unknown CPU level: " + s);
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    vector<size_t> lengths = { 8, 32, 128, 512 };
+    vector<int> alphabets = { 4, 26, 94 };
+    vector<double> similarities = { 0.5, 0.9 };
+    uint64_t seed = 42;
+    string output;
+    string baseline;
+    string revision = "unknown";
+    double tolerance = 0.1;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            auto value = [&]() -> string {
+                if (i + 1 >= argc) {
+                    throw runtime_error("Missing value of " + arg + ".");
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--help" || arg == "-h") {
+                usage();
+                return 0;
+            }
+            else if (arg == "--output") {
+                output = value();
+            }
+            else if (arg == "--filter") {
+                options.filter = value();
+            }
+            else if (arg == "--lengths") {
+                lengths = parseList<size_t>(value());
+            }
+            else if (arg == "--alphabets") {
+                alphabets = parseList<int>(value());
+            }
+            else if (arg == "--similarities") {
+                similarities = parseList<double>(value());
+            }
+            else if (arg == "--quick") {
+                lengths = { 16, 128 };
+                alphabets = { 26 };
+                similarities = { 0.8 };
+                options.repeats = 3;
+            }
+            else if (arg == "--repeats") {
+                options.repeats = max(1, stoi(value()));
+            }
+            else if (arg == "--min-time") {
+                options.min_time = stod(value());
+            }
+            else if (arg == "--threads") {
+                options.nthreads = stoi(value());
+            }
+            else if (arg == "--seed") {
+                seed = stoull(value());
+            }
+            else if (arg == "--cpu-level") {
+                setCpuLevel(parseCpuLevel(value()));
+            }
+            else if (arg == "--baseline") {
+                baseline = value();
+            }
+            else if (arg == "--tolerance") {
+                tolerance = stod(value());
+            }
+            else if (arg == "--revision") {
+                revision = value();
+            }
+            else if (arg == "--list") {
+                options.list = true;
+            }
+            else if (arg == "--quiet") {
+                options.verbose = false;
+            }
+            else {
+                throw runtime_error("Unknown option: " + arg + ". See --help.");
+            }
+        }
+
+        Runner runner(options);
+        for (size_t length : lengths) {
+            for (int alphabet : alphabets) {
+                for (double similarity : similarities) {
+                    Workload w(DataConfig{ length, alphabet, similarity }, seed);
+                    benchComparators(runner, w);
+                    benchPreprocessing(runner, w);
+                }
+            }
+        }
+        if (options.list) {
+            return 0;
+        }
+
+        vector<pair<string, string>> context = {
+            { "date", utcDate() },
+            { "revision", revision },
+            { "compiler", STRINGCOMPARE_BENCH_COMPILER },
+            { "flags", STRINGCOMPARE_BENCH_FLAGS },
+            { "cpu_detected", cpuLevelName(detectCpuLevel()) },
+            { "cpu_level", cpuLevelName(cpuLevel()) },
+            { "hardware_threads", to_string(thread::hardware_concurrency()) },
+            { "threads", to_string(options.nthreads) },
+            { "repeats", to_string(options.repeats) },
+            { "min_time", to_string(options.min_time) },
+            { "seed", to_string(seed) }
+        };
+        if (output.empty()) {
+            writeJson(cout, context, runner.measurements);
+        }
+        else {
+            ofstream out(output);
+            if (!out) {
+                throw runtime_error("Could not open " + output + ".");
+            }
+            writeJson(out, context, runner.measurements);
+            cerr << "Wrote " << runner.measurements.size() << " measurements to " << output << "." << endl;
+        }
+
+        if (!baseline.empty() && compareToBaseline(baseline, runner.measurements, tolerance) > 0) {
+            return 1;
+        }
+    }
+    catch (const exception& e) {
+        cerr << "bench: " << e.what() << endl;
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,440 @@
+/**
+ * @file benchmark.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Benchmark harness: reproducible datasets, timing of cases, and JSON reports.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_BENCH_BENCHMARK_HPP_INCLUDED
+#define STRINGCOMPARE_BENCH_BENCHMARK_HPP_INCLUDED
+
+#include <stdint.h>
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "stringcompare/utils/cpu.h"
+
+using namespace std;
+
+namespace bench {
+
+    /**
+     * @brief Characters of generated strings. An alphabet of size `k` is made of the first `k` characters, so that
+     * small alphabets are lowercase letters.
+     */
+    const string ALPHABET = "etaoinshrdlucmfwypvbgkqjxzETAOINSHRDLUCMFWYPVBGKQJXZ0123456789!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+
+    /**
+     * @brief Parameters of a generated dataset.
+     *
+     * - `length`: length of the generated strings.
+     * - `alphabet`: number of distinct characters, at most ALPHABET.size().
+     * - `similarity`: probability that a character of a string is kept in the string it is compared to. Other
+     *   characters are substituted, deleted, or followed by an insertion.
+     */
+    struct DataConfig {
+        size_t length;
+        int alphabet;
+        double similarity;
+    };
+
+    /**
+     * @brief Pairs of strings `(left[i], right[i])`, where `right[i]` is an edited copy of `left[i]`.
+     */
+    struct Dataset {
+        vector<string> left;
+        vector<string> right;
+
+        size_t size() const {
+            return left.size();
+        }
+
+        /**
+         * @brief The first `n` pairs.
+         */
+        Dataset head(size_t n) const {
+            n = min(n, size());
+            return Dataset{ vector<string>(left.begin(), left.begin() + n), vector<string>(right.begin(), right.begin() + n) };
+        }
+    };
+
+    /**
+     * @brief Generator of datasets which are identical on every platform for a given seed.
+     *
+     * mt19937_64 is fully specified by the standard, while the standard distributions are not, so that random values
+     * are derived from its output directly.
+     */
+    class DataGenerator {
+    public:
+
+        explicit DataGenerator(uint64_t seed) : engine(seed) {}
+
+        /**
+         * @brief `n` pairs of strings.
+         *
+         * @param n Number of pairs.
+         * @param config Length, alphabet size, and similarity of the strings.
+         * @param words Whether to split strings into words of about 6 characters, separated by spaces.
+         */
+        Dataset pairs(size_t n, const DataConfig& config, bool words = false) {
+            if (config.alphabet < 1 || config.alphabet > (int)ALPHABET.size()) {
+                throw runtime_error("Alphabet size should be between 1 and " + to_string(ALPHABET.size()) + ".");
+            }
+
+            Dataset result;
+            result.left.reserve(n);
+            result.right.reserve(n);
+            for (size_t i = 0; i < n; i++) {
+                string s = randomString(config.length, config.alphabet, words);
+                result.right.push_back(edit(s, config.alphabet, config.similarity, words));
+                result.left.push_back(move(s));
+            }
+
+            return result;
+        }
+
+    private:
+
+        mt19937_64 engine;
+
+        size_t uniform(size_t n) {
+            return engine() % n;
+        }
+
+        double uniform() {
+            return (engine() >> 11) * 0x1.0p-53;
+        }
+
+        char randomChar(int alphabet, bool words) {
+            if (words && uniform(6) == 0) {
+                return ' ';
+            }
+            return ALPHABET[uniform(alphabet)];
+        }
+
+        string randomString(size_t length, int alphabet, bool words) {
+            string result(length, ' ');
+            for (size_t i = 0; i < length; i++) {
+                result[i] = randomChar(alphabet, words);
+            }
+
+            return result;
+        }
+
+        string edit(const string& s, int alphabet, double similarity, bool words) {
+            string result;
+            result.reserve(s.size() + s.size() / 4);
+            for (char c : s) {
+                if (uniform() < similarity) {
+                    result.push_back(c);
+                    continue;
+                }
+                switch (uniform(3)) {
+                case 0:
+                    result.push_back(randomChar(alphabet, words));
+                    break;
+                case 1:
+                    break;
+                default:
+                    result.push_back(c);
+                    result.push_back(randomChar(alphabet, words));
+                }
+            }
+
+            return result;
+        }
+
+    };
+
+    /**
+     * @brief A benchmark case: a function timed on a dataset, which processes `items` comparisons or strings per call.
+     */
+    struct Case {
+        string group;
+        string name;
+        string mode;
+        DataConfig config;
+        size_t items;
+
+        /**
+         * @brief Identifier of the case, such as `distance/Levenshtein/pairwise/length=32/alphabet=26/similarity=0.9`.
+         */
+        string key() const {
+            ostringstream result;
+            result << group << "/" << name << "/" << mode << "/length=" << config.length << "/alphabet=" << config.alphabet
+                << "/similarity=" << config.similarity;
+            return result.str();
+        }
+    };
+
+    /**
+     * @brief Timings of a case. Each repeat times `iterations` calls of its function.
+     */
+    struct Measurement {
+        Case bench_case;
+        size_t iterations;
+        vector<double> seconds;
+
+        /**
+         * @brief Nanoseconds per item of each repeat, in increasing order.
+         */
+        vector<double> nanoseconds() const {
+            vector<double> result;
+            for (double s : seconds) {
+                result.push_back(s * 1e9 / (iterations * bench_case.items));
+            }
+            sort(result.begin(), result.end());
+
+            return result;
+        }
+
+        double minimum() const {
+            return nanoseconds().front();
+        }
+
+        double median() const {
+            vector<double> ns = nanoseconds();
+            size_t k = ns.size() / 2;
+            return (ns.size() % 2 == 1) ? ns[k] : (ns[k - 1] + ns[k]) / 2;
+        }
+
+        double mean() const {
+            vector<double> ns = nanoseconds();
+            double total = 0;
+            for (double x : ns) {
+                total += x;
+            }
+            return total / ns.size();
+        }
+    };
+
+    /**
+     * @brief Options of a benchmark run.
+     *
+     * - `repeats`: number of timed repeats of each case.
+     * - `min_time`: minimum duration of a repeat, in seconds. Fast cases are called several times per repeat.
+     * - `nthreads`: number of threads of batch functions.
+     * - `filter`: only cases whose key() contains this string are run.
+     */
+    struct Options {
+        int repeats = 5;
+        double min_time = 0.02;
+        int nthreads = 1;
+        string filter;
+        bool list = false;
+        bool verbose = true;
+    };
+
+    /**
+     * @brief Values passed through doNotOptimize() are stored here, so that they are never optimized away.
+     */
+    inline volatile double sink = 0;
+
+    inline void doNotOptimize(double value) {
+        sink = value;
+    }
+
+    /**
+     * @brief Runs benchmark cases and collects their measurements.
+     */
+    class Runner {
+    public:
+
+        Options options;
+        vector<Measurement> measurements;
+
+        explicit Runner(const Options& options) : options(options) {}
+
+        bool selected(const Case& c) const {
+            return c.key().find(options.filter) != string::npos;
+        }
+
+        /**
+         * @brief Time a case.
+         *
+         * The function is called once to warm up caches and workspaces, and to choose the number of calls per repeat.
+         *
+         * @param c Benchmark case.
+         * @param f Function which runs the case and returns any value which depends on its results.
+         */
+        template<class F>
+        void run(const Case& c, const F& f) {
+            if (!selected(c)) {
+                return;
+            }
+            if (options.list) {
+                cout << c.key() << "\n";
+                return;
+            }
+
+            double warmup = timeCalls(f, 1);
+            size_t iterations = 1;
+            if (warmup < options.min_time) {
+                iterations = (size_t)ceil(options.min_time / max(warmup, 1e-9));
+            }
+
+            Measurement m{ c, iterations, {} };
+            for (int r = 0; r < options.repeats; r++) {
+                m.seconds.push_back(timeCalls(f, iterations));
+            }
+            measurements.push_back(m);
+
+            if (options.verbose) {
+                cerr << left << setw(88) << c.key() << right << setw(12) << fixed << setprecision(2) << m.median()
+                    << " ns/item" << endl;
+            }
+        }
+
+    private:
+
+        template<class F>
+        static double timeCalls(const F& f, size_t iterations) {
+            auto start = chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; i++) {
+                doNotOptimize(f());
+            }
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+            return elapsed.count();
+        }
+
+    };
+
+    inline string jsonString(const string& s) {
+        ostringstream result;
+        result << '"';
+        for (char c : s) {
+            if (c == '"' || c == '\\') {
+                result << '\\' << c;
+            }
+            else if ((unsigned char)c < 0x20) {
+                result << "\\u" << hex << setw(4) << setfill('0') << (int)c;
+            }
+            else {
+                result << c;
+            }
+        }
+        result << '"';
+
+        return result.str();
+    }
+
+    inline string utcDate() {
+        time_t now = time(nullptr);
+        tm utc;
+        gmtime_r(&now, &utc);
+        char buffer[32];
+        strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+
+        return buffer;
+    }
+
+    /**
+     * @brief Write measurements as JSON.
+     *
+     * The report holds a `context` object, which describes the build and the machine, and a `benchmarks` array with
+     * one object per case. Each benchmark object is written on a single line, so that reports are easy to diff and
+     * are read back by readMedians().
+     *
+     * @param out Output stream.
+     * @param context Pairs of keys and string values describing the run.
+     * @param measurements Measurements of the run.
+     */
+    inline void writeJson(ostream& out, const vector<pair<string, string>>& context, const vector<Measurement>& measurements) {
+        out << "{\n  \"context\": {\n";
+        for (size_t i = 0; i < context.size(); i++) {
+            out << "    " << jsonString(context[i].first) << ": " << jsonString(context[i].second)
+                << (i + 1 < context.size() ? ",\n" : "\n");
+        }
+        out << "  },\n  \"benchmarks\": [\n";
+        out << setprecision(6) << defaultfloat;
+        for (size_t i = 0; i < measurements.size(); i++) {
+            const Measurement& m = measurements[i];
+            const Case& c = m.bench_case;
+            out << "    {\"key\": " << jsonString(c.key()) << ", \"group\": " << jsonString(c.group) << ", \"name\": "
+                << jsonString(c.name) << ", \"mode\": " << jsonString(c.mode) << ", \"length\": " << c.config.length
+                << ", \"alphabet\": " << c.config.alphabet << ", \"similarity\": " << c.config.similarity
+                << ", \"items\": " << c.items << ", \"iterations\": " << m.iterations << ", \"repeats\": "
+                << m.seconds.size() << ", \"ns_per_item_min\": " << m.minimum() << ", \"ns_per_item_median\": "
+                << m.median() << ", \"ns_per_item_mean\": " << m.mean() << ", \"items_per_second\": "
+                << 1e9 / m.median() << "}" << (i + 1 < measurements.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+    }
+
+    /**
+     * @brief Median nanoseconds per item of each case of a report written by writeJson(), by case key.
+     */
+    inline map<string, double> readMedians(const string& path) {
+        ifstream in(path);
+        if (!in) {
+            throw runtime_error("Could not open " + path + ".");
+        }
+
+        map<string, double> result;
+        string line;
+        const string key_field = "\"key\": \"";
+        const string median_field = "\"ns_per_item_median\": ";
+        while (getline(in, line)) {
+            size_t k = line.find(key_field);
+            size_t m = line.find(median_field);
+            if (k == string::npos || m == string::npos) {
+                continue;
+            }
+            k += key_field.size();
+            string key = line.substr(k, line.find('"', k) - k);
+            result[key] = stod(line.substr(m + median_field.size()));
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Compare measurements to a baseline report, and print the ratio of median times of common cases.
+     *
+     * @param baseline Path of a report written by writeJson().
+     * @param measurements Measurements of the current run.
+     * @param tolerance Cases slower than the baseline by more than this fraction are reported as regressions.
+     * @return Number of regressions.
+     */
+    inline int compareToBaseline(const string& baseline, const vector<Measurement>& measurements, double tolerance) {
+        map<string, double> medians = readMedians(baseline);
+
+        int regressions = 0;
+        int compared = 0;
+        cerr << "\nComparison to " << baseline << " (ratio of median times, > 1 is slower):\n";
+        for (const Measurement& m : measurements) {
+            auto it = medians.find(m.bench_case.key());
+            if (it == medians.end()) {
+                continue;
+            }
+            compared++;
+            double ratio = m.median() / it->second;
+            bool regression = ratio > 1 + tolerance;
+            regressions += regression;
+            if (regression || ratio < 1 - tolerance) {
+                cerr << left << setw(88) << m.bench_case.key() << right << setw(8) << fixed << setprecision(2) << ratio
+                    << (regression ? "  REGRESSION" : "  improvement") << "\n";
+            }
+        }
+        cerr << compared << " cases compared, " << regressions << " regressions (tolerance "
+            << defaultfloat << tolerance << ")." << endl;
+
+        return regressions;
+    }
+
+}
+
+#endif // STRINGCOMPARE_BENCH_BENCHMARK_HPP_INCLUDED
@@ -0,0 +1,286 @@
+/**
+ * @file bitparallel.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Pattern match bit-vectors for bit-parallel string comparison kernels.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_DISTANCE_BITPARALLEL_HPP_INCLUDED
+#define STRINGCOMPARE_DISTANCE_BITPARALLEL_HPP_INCLUDED
+
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "../utils/cpu.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Number of set bits in a 64 bits word.
+     *
+     * Always inlined, so that it compiles to the popcount instruction in kernels dispatched to SSE4.2 and above.
+     */
+    STRINGCOMPARE_ALWAYS_INLINE int popcount64(uint64_t x) {
+#if defined(_MSC_VER) && defined(_M_X64)
+        return (int)__popcnt64(x);
+#elif defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(x);
+#else
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+    /**
+     * @brief Index of the lowest set bit of a nonzero 64 bits word.
+     */
+    STRINGCOMPARE_ALWAYS_INLINE int ctz64(uint64_t x) {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64(&index, x);
+        return (int)index;
+#elif defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(x);
+#else
+        int index = 0;
+        while (!(x & 1)) {
+            x >>= 1;
+            index++;
+        }
+        return index;
+#endif
+    }
+
+    /**
+     * @brief Code of a character as an unsigned integer.
+     *
+     * Characters of strings are bytes, while those of `u16string`, `u32string` or vectors of integers are code units or 
+     * code points. Signed characters are converted to their unsigned representation.
+     */
+    template<class CharT>
+    inline uint32_t charCode(CharT c) {
+        return (uint32_t)(typename make_unsigned<CharT>::type)c;
+    }
+
+    /**
+     * @brief Bit-vectors of character positions for patterns of at most 64 characters.
+     *
+     * Bit `i` of get(c) is set whenever the pattern's ith character is `c`. The vectors are left zeroed between uses:
+     * insert() a pattern, run a kernel against it, and clear() the same pattern afterwards.
+     *
+     * Characters of code below 256 are looked up in an array. Wider characters are stored in a small open addressing 
+     * hash table, which cannot be more than half full since patterns have at most 64 distinct characters.
+     */
+    class PatternMatchVector {
+    public:
+
+        uint64_t bits[256];
+        uint32_t ext_keys[128];
+        uint64_t ext_bits[128];
+        bool extended;
+
+        PatternMatchVector() : extended(false) {
+            for (int i = 0; i < 256; i++) {
+                bits[i] = 0;
+            }
+            for (int i = 0; i < 128; i++) {
+                ext_keys[i] = 0;
+                ext_bits[i] = 0;
+            }
+        }
+
+        template<class Sequence>
+        explicit PatternMatchVector(const Sequence& s) : PatternMatchVector() {
+            insert(s);
+        }
+
+        /**
+         * @brief Set the position bits of a pattern of at most 64 characters.
+         */
+        template<class Sequence>
+        void insert(const Sequence& s) {
+            uint64_t mask = 1;
+            for (size_t i = 0; i < s.size(); i++) {
+                uint32_t c = charCode(s[i]);
+                if (c < 256) {
+                    bits[c] |= mask;
+                }
+                else {
+                    size_t i_slot = slot(c);
+                    ext_keys[i_slot] = c;
+                    ext_bits[i_slot] |= mask;
+                    extended = true;
+                }
+                mask <<= 1;
+            }
+        }
+
+        /**
+         * @brief Zero the vectors of the characters of a previously inserted pattern.
+         */
+        template<class Sequence>
+        void clear(const Sequence& s) {
+            for (size_t i = 0; i < s.size(); i++) {
+                uint32_t c = charCode(s[i]);
+                if (c < 256) {
+                    bits[c] = 0;
+                }
+            }
+            if (extended) {
+                for (int i = 0; i < 128; i++) {
+                    ext_keys[i] = 0;
+                    ext_bits[i] = 0;
+                }
+                extended = false;
+            }
+        }
+
+        template<class CharT>
+        uint64_t get(CharT ch) const {
+            uint32_t c = charCode(ch);
+            if (c < 256) {
+                return bits[c];
+            }
+
+            return extended ? ext_bits[slot(c)] : 0;
+        }
+
+        /**
+         * @brief Slot of the hash table holding `c`, or the empty slot where it would be inserted.
+         */
+        size_t slot(uint32_t c) const {
+            size_t i = (c * 2654435761u) >> 25;
+            while (ext_keys[i] != 0 && ext_keys[i] != c) {
+                i = (i + 1) % 128;
+            }
+
+            return i;
+        }
+    };
+
+    /**
+     * @brief Bit-vectors of character positions for patterns of any length, split in blocks of 64 characters.
+     *
+     * Bit `i` of get(w, c) is set whenever the pattern's (64 * w + i)th character is `c`. As with PatternMatchVector,
+     * vectors are left zeroed between uses so that only the pattern's characters are touched on each call. Characters 
+     * of code 256 and above are given rows of `ext_bits` through the `ext_rows` map.
+     */
+    class BlockPatternMatchVector {
+    public:
+
+        size_t words;
+        vector<uint64_t> bits;
+        unordered_map<uint32_t, size_t> ext_rows;
+        vector<uint64_t> ext_bits;
+
+        BlockPatternMatchVector() : words(0) {}
+
+        template<class Sequence>
+        explicit BlockPatternMatchVector(const Sequence& s) : words(0) {
+            insert(s);
+        }
+
+        /**
+         * @brief Number of 64 bits words needed to hold a pattern of the given length.
+         */
+        static size_t blocks(size_t length) {
+            return (length + 63) / 64;
+        }
+
+        /**
+         * @brief Preallocate zeroed vectors for patterns of up to the given length.
+         */
+        void reserve(size_t length) {
+            if (bits.size() < 256 * blocks(length)) {
+                bits.resize(256 * blocks(length), 0);
+            }
+        }
+
+        /**
+         * @brief Set the position bits of a pattern.
+         */
+        template<class Sequence>
+        void insert(const Sequence& s) {
+            reserve(s.size());
+            words = blocks(s.size());
+            for (size_t i = 0; i < s.size(); i++) {
+                uint32_t c = charCode(s[i]);
+                if (c < 256) {
+                    bits[c * words + i / 64] |= uint64_t(1) << (i % 64);
+                }
+                else {
+                    auto it = ext_rows.find(c);
+                    if (it == ext_rows.end()) {
+                        it = ext_rows.emplace(c, ext_rows.size()).first;
+                        ext_bits.resize(ext_rows.size() * words, 0);
+                    }
+                    ext_bits[it->second * words + i / 64] |= uint64_t(1) << (i % 64);
+                }
+            }
+        }
+
+        /**
+         * @brief Zero the vectors of the characters of a previously inserted pattern.
+         */
+        template<class Sequence>
+        void clear(const Sequence& s) {
+            for (size_t i = 0; i < s.size(); i++) {
+                uint32_t c = charCode(s[i]);
+                if (c < 256) {
+                    bits[c * words + i / 64] = 0;
+                }
+            }
+            if (!ext_rows.empty()) {
+                ext_rows.clear();
+                ext_bits.clear();
+            }
+        }
+
+        template<class CharT>
+        uint64_t get(size_t word, CharT ch) const {
+            uint32_t c = charCode(ch);
+            if (c < 256) {
+                return bits[c * words + word];
+            }
+            if (ext_rows.empty()) {
+                return 0;
+            }
+
+            auto it = ext_rows.find(c);
+            return (it != ext_rows.end()) ? ext_bits[it->second * words + word] : 0;
+        }
+    };
+
+    /**
+     * @brief Number of strings compared at once by batch kernels.
+     *
+     * Batch kernels interleave strings across lanes of 64 bits words and process all lanes in lockstep. Four lanes fill
+     * one AVX2 register.
+     */
+    const int BATCH_LANES = 4;
+
+    /**
+     * @brief Pattern match vectors used as scratch space by comparators.
+     *
+     * Comparators hold one workspace per thread, so that const comparisons can be run concurrently on a shared instance.
+     */
+    struct PatternMatchWorkspace {
+        PatternMatchVector pm;
+        BlockPatternMatchVector block_pm;
+    };
+
+}
+
+#endif // STRINGCOMPARE_DISTANCE_BITPARALLEL_HPP_INCLUDED
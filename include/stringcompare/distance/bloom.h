@@ -0,0 +1,345 @@
+/**
+ * @file bloom.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Comparison of Bloom filter encoded strings, for privacy-preserving record linkage.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_DISTANCE_BLOOM_HPP_INCLUDED
+#define STRINGCOMPARE_DISTANCE_BLOOM_HPP_INCLUDED
+
+#include <stdint.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bitparallel.h"
+#include "comparator.h"
+#include "../preprocessing/bloomfilter.h"
+#include "../utils/cpu.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Base class for comparators of Bloom filters.
+     *
+     * Subclasses define compareCounts() as a function of the number of bits set in both filters and in each of them.
+     * Filters are compared with a popcount of their bitwise intersection, one 64 bits word at a time. The batch
+     * functions count the bits of each filter once, so that each pair costs `words` AND and popcount operations. These
+     * run through intersectionCounts(), which is dispatched at runtime to hardware popcount or to the vectorized
+     * popcount of AVX-512 (see cpuLevel()).
+     *
+     * Strings are encoded with `encoder` on every call to compare(). Lists should instead be encoded once with
+     * BloomEncoder::encodeMany(), or loaded with BloomFilters::fromBytes(), and compared with the BloomFilters overloads.
+     */
+    class BloomComparator : public StringComparator {
+    public:
+
+        BloomEncoder encoder;
+        bool similarity;
+
+        BloomComparator(const BloomEncoder& encoder, bool similarity) :
+            encoder(encoder),
+            similarity(similarity) {}
+
+        /**
+         * @brief Comparison value of two filters of `num_bits` bits, given the number of bits set in both and in each.
+         */
+        virtual double compareCounts(double intersection, double count_s, double count_t, double num_bits) const = 0;
+
+        bool isSimilarity() const {
+            return similarity;
+        }
+
+        /**
+         * @brief Number of bits set in a filter of `words` words.
+         */
+        static size_t bitCount(const uint64_t* a, size_t words) {
+            size_t count = 0;
+            for (size_t k = 0; k < words; k++) {
+                count += popcount64(a[k]);
+            }
+
+            return count;
+        }
+
+        /**
+         * @brief Number of bits set in both of two filters of `words` words.
+         */
+        static size_t intersectionCount(const uint64_t* a, const uint64_t* b, size_t words) {
+            size_t count = 0;
+            for (size_t k = 0; k < words; k++) {
+                count += popcount64(a[k] & b[k]);
+            }
+
+            return count;
+        }
+
+        /**
+         * @brief Number of bits set in both `a` and each of `count` consecutive filters of `words` words starting at `b`,
+         * written to `out`.
+         *
+         * Runs the widest kernel supported by the CPU. See cpuLevel().
+         */
+        static void intersectionCounts(const uint64_t* a, const uint64_t* b, size_t count, size_t words, uint32_t* out) {
+            switch (cpuLevel()) {
+            case CPU_AVX512:
+                intersectionCountsAvx512(a, b, count, words, out);
+                break;
+            case CPU_AVX2:
+                intersectionCountsAvx2(a, b, count, words, out);
+                break;
+            case CPU_SSE42:
+                intersectionCountsSse42(a, b, count, words, out);
+                break;
+            default:
+                intersectionCountsKernel(a, b, count, words, out);
+            }
+        }
+
+        /**
+         * @brief Comparison between two filters of `num_bits` bits.
+         */
+        double compareFilters(const uint64_t* a, const uint64_t* b, size_t num_bits) const {
+            size_t words = (num_bits + 63) / 64;
+            return compareCounts(intersectionCount(a, b, words), bitCount(a, words), bitCount(b, words), num_bits);
+        }
+
+        using StringComparator::compare;
+        using StringComparator::compareViews;
+
+        double compare(const string& s, const string& t) const {
+            return compareViews(s, t);
+        }
+
+        double compareViews(string_view s, string_view t) const {
+            vector<uint64_t> a = encoder.encode(s);
+            vector<uint64_t> b = encoder.encode(t);
+
+            return compareFilters(a.data(), b.data(), encoder.num_bits);
+        }
+
+        using StringComparator::elementwise;
+        using StringComparator::pairwise;
+        using StringComparator::condensed;
+
+        /**
+         * @brief Elementwise comparisons between filters. See BatchComparator::elementwise().
+         */
+        vector<double> elementwise(const BloomFilters& f1, const BloomFilters& f2, int nthreads = 1) const {
+            checkFilters(f1, f2);
+            if (f1.size() != f2.size()) {
+                throw runtime_error("Lists should be of the same size.");
+            }
+
+            vector<double> result(f1.size());
+            size_t ntiles = (f1.size() + ELEMENTWISE_TILE - 1) / ELEMENTWISE_TILE;
+            parallelFor(ntiles, nthreads, [&](size_t tile) {
+                size_t end = min(f1.size(), (tile + 1) * ELEMENTWISE_TILE);
+                for (size_t i = tile * ELEMENTWISE_TILE; i < end; i++) {
+                    result[i] = compareFilters(f1[i], f2[i], f1.num_bits);
+                }
+            });
+
+            return result;
+        }
+
+        /**
+         * @brief Pairwise comparisons between filters. See BatchComparator::pairwise().
+         */
+        Mat<double> pairwise(const BloomFilters& f1, const BloomFilters& f2, int nthreads = 1) const {
+            Mat<double> result(f1.size(), vector<double>(f2.size()));
+            forEachFilterPair(f1, f2, false, nthreads, [&](size_t i, size_t j, double value) {
+                result[i][j] = value;
+            });
+
+            return result;
+        }
+
+        /**
+         * @brief Pairwise comparisons written to a caller-provided row-major buffer of at least `f1.size() * f2.size()`
+         * elements, such as a float32 array for large linkage jobs.
+         */
+        template<class T>
+        void pairwise(const BloomFilters& f1, const BloomFilters& f2, T* out, int nthreads = 1) const {
+            size_t n2 = f2.size();
+            forEachFilterPair(f1, f2, false, nthreads, [&](size_t i, size_t j, double value) {
+                out[i * n2 + j] = static_cast<T>(value);
+            });
+        }
+
+        /**
+         * @brief Condensed pairwise comparisons between filters. See BatchComparator::condensed().
+         */
+        vector<double> condensed(const BloomFilters& f, int nthreads = 1) const {
+            vector<double> result(condensedSize(f.size()));
+            condensed(f, result.data(), nthreads);
+
+            return result;
+        }
+
+        /**
+         * @brief Condensed pairwise comparisons written to a caller-provided buffer of at least `condensedSize(f.size())`
+         * elements.
+         */
+        template<class T>
+        void condensed(const BloomFilters& f, T* out, int nthreads = 1) const {
+            size_t n = f.size();
+            forEachFilterPair(f, f, true, nthreads, [&](size_t i, size_t j, double value) {
+                out[condensedIndex(n, i, j)] = static_cast<T>(value);
+            });
+        }
+
+    protected:
+
+        static void checkFilters(const BloomFilters& f1, const BloomFilters& f2) {
+            if (f1.num_bits != f2.num_bits) {
+                throw runtime_error("Filters should have the same number of bits.");
+            }
+        }
+
+        /**
+         * @brief Call `f(i, j, value)` for the comparison value of every pair of filters, in parallel over tiles of pairs.
+         *
+         * The bit counts of all filters are computed once beforehand.
+         *
+         * @param upper Whether to restrict to the pairs above the diagonal (i < j).
+         */
+        template<class F>
+        void forEachFilterPair(const BloomFilters& f1, const BloomFilters& f2, bool upper, int nthreads, const F& f) const {
+            checkFilters(f1, f2);
+            size_t words = f1.words;
+            double num_bits = f1.num_bits;
+
+            vector<uint32_t> counts1(f1.size());
+            vector<uint32_t> counts2(f2.size());
+            parallelFor(f1.size(), nthreads, [&](size_t i) {
+                counts1[i] = bitCount(f1[i], words);
+            });
+            parallelFor(f2.size(), nthreads, [&](size_t j) {
+                counts2[j] = bitCount(f2[j], words);
+            });
+
+            forEachPair(f1.size(), f2.size(), upper, nthreads, [&](size_t i, size_t j0, size_t j1) {
+                uint32_t intersections[PAIRWISE_TILE_COLS];
+                intersectionCounts(f1[i], f2[j0], j1 - j0, words, intersections);
+                for (size_t j = j0; j < j1; j++) {
+                    f(i, j, compareCounts(intersections[j - j0], counts1[i], counts2[j], num_bits));
+                }
+            });
+        }
+
+        STRINGCOMPARE_ALWAYS_INLINE static void intersectionCountsKernel(const uint64_t* a, const uint64_t* b, size_t count, size_t words, uint32_t* out) {
+            for (size_t j = 0; j < count; j++) {
+                const uint64_t* c = b + j * words;
+                uint64_t n = 0;
+                for (size_t k = 0; k < words; k++) {
+                    n += popcount64(a[k] & c[k]);
+                }
+                out[j] = (uint32_t)n;
+            }
+        }
+
+        STRINGCOMPARE_TARGET_SSE42 static void intersectionCountsSse42(const uint64_t* a, const uint64_t* b, size_t count, size_t words, uint32_t* out) {
+            intersectionCountsKernel(a, b, count, words, out);
+        }
+
+        STRINGCOMPARE_TARGET_AVX2 static void intersectionCountsAvx2(const uint64_t* a, const uint64_t* b, size_t count, size_t words, uint32_t* out) {
+            intersectionCountsKernel(a, b, count, words, out);
+        }
+
+        STRINGCOMPARE_TARGET_AVX512 static void intersectionCountsAvx512(const uint64_t* a, const uint64_t* b, size_t count, size_t words, uint32_t* out) {
+            intersectionCountsKernel(a, b, count, words, out);
+        }
+
+    };
+
+    /**
+     * @brief Sørensen-Dice comparison of Bloom filters, the usual similarity of cryptographic long-term keys.
+     */
+    class BloomDice : public BloomComparator {
+    public:
+
+        /**
+         * @brief Construct a new BloomDice object.
+         *
+         * The similarity score is `2 |A ∩ B| / (|A| + |B|)` for the sets of bits `A` and `B` of two filters, and the
+         * distance is 1 minus the similarity.
+         *
+         * @param encoder Encoder of strings compared with compare(). Defaults to BloomEncoder().
+         * @param similarity Whether to return a similarity score rather than a distance. Defaults to false.
+         */
+        explicit BloomDice(const BloomEncoder& encoder = BloomEncoder(), bool similarity = false) :
+            BloomComparator(encoder, similarity) {}
+
+        double compareCounts(double intersection, double count_s, double count_t, double) const {
+            double sim = (count_s + count_t == 0) ? 1.0 : 2.0 * intersection / (count_s + count_t);
+            return similarity ? sim : 1.0 - sim;
+        }
+
+    };
+
+    /**
+     * @brief Jaccard comparison of Bloom filters.
+     */
+    class BloomJaccard : public BloomComparator {
+    public:
+
+        /**
+         * @brief Construct a new BloomJaccard object.
+         *
+         * The similarity score is `|A ∩ B| / |A ∪ B|` for the sets of bits `A` and `B` of two filters, and the distance
+         * is 1 minus the similarity.
+         *
+         * @param encoder Encoder of strings compared with compare(). Defaults to BloomEncoder().
+         * @param similarity Whether to return a similarity score rather than a distance. Defaults to false.
+         */
+        explicit BloomJaccard(const BloomEncoder& encoder = BloomEncoder(), bool similarity = false) :
+            BloomComparator(encoder, similarity) {}
+
+        double compareCounts(double intersection, double count_s, double count_t, double) const {
+            double sim = (count_s + count_t == 0) ? 1.0 : intersection / (count_s + count_t - intersection);
+            return similarity ? sim : 1.0 - sim;
+        }
+
+    };
+
+    /**
+     * @brief Hamming comparison of Bloom filters.
+     */
+    class BloomHamming : public BloomComparator {
+    public:
+
+        bool normalize;
+
+        /**
+         * @brief Construct a new BloomHamming object.
+         *
+         * The distance is the number `|A| + |B| - 2 |A ∩ B|` of bits set in only one of two filters. By default, it is
+         * normalized by the number of bits of the filters. The similarity score is the number of bits minus the
+         * distance, and its normalization is 1 minus the normalized distance.
+         *
+         * @param encoder Encoder of strings compared with compare(). Defaults to BloomEncoder().
+         * @param normalize Whether to normalize the distance/similarity to be between 0 and 1. Defaults to true.
+         * @param similarity Whether to return a similarity score rather than a distance. Defaults to false.
+         */
+        explicit BloomHamming(const BloomEncoder& encoder = BloomEncoder(), bool normalize = true, bool similarity = false) :
+            BloomComparator(encoder, similarity),
+            normalize(normalize) {}
+
+        double compareCounts(double intersection, double count_s, double count_t, double num_bits) const {
+            double dist = count_s + count_t - 2 * intersection;
+            double value = similarity ? num_bits - dist : dist;
+
+            return normalize ? value / num_bits : value;
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_DISTANCE_BLOOM_HPP_INCLUDED
@@ -61,20 +61,32 @@ namespace stringcompare {
          * @param t string to compare to.
          * @return int Number of characters in common.
          */
-        static int commoncharacters(const string& s, const string& t) {
-            string s1 = s;
-            string s2 = t;
+        template<class Sequence>
+        static int commoncharacters(const Sequence& s, const Sequence& t) {
+            vector<typename Sequence::value_type> s1(begin(s), end(s));
+            vector<typename Sequence::value_type> s2(begin(t), end(t));
 
             sort(begin(s1), end(s1));
             sort(begin(s2), end(s2));
 
-            std::string intersection;
+            vector<typename Sequence::value_type> intersection;
             std::set_intersection(begin(s1), end(s1), begin(s2), end(s2),
                 back_inserter(intersection));
             return (int)intersection.size();
         }
 
-        double compare(const string& s, const string& t) {
+        bool isSimilarity() const {
+            return similarity;
+        }
+
+        using StringComparator::compare;
+        using StringComparator::compareViews;
+
+        /**
+         * @brief Comparison of any sequences of characters, such as `string_view`, `u32string` or vectors of code points.
+         */
+        template<class Sequence>
+        double compareSequences(const Sequence& s, const Sequence& t) const {
             int len = s.size() + t.size();
 
             if (len == 0) {
@@ -97,6 +109,112 @@ namespace stringcompare {
                 return dist;
             }
         }
+
+        double compare(const string& s, const string& t) const {
+            return compareSequences(s, t);
+        }
+
+        double compareViews(string_view s, string_view t) const {
+            return compareSequences(s, t);
+        }
+
+        /**
+         * @brief CharacterDifference comparator with a fixed first string.
+         * 
+         * The character histogram of the first string is computed once, so that the number of characters in common is 
+         * found in a single pass over the second string.
+         */
+        class Cached : public CachedComparator<string> {
+        public:
+
+            bool normalize;
+            bool similarity;
+            string s;
+            int histogram[256];
+
+            Cached(const string& s, bool normalize = true, bool similarity = false) :
+                normalize(normalize),
+                similarity(similarity),
+                s(s) {
+                for (int c = 0; c < 256; c++) {
+                    histogram[c] = 0;
+                }
+                for (size_t i = 0; i < s.size(); i++) {
+                    histogram[(unsigned char)s[i]]++;
+                }
+            }
+
+            /**
+             * @brief Number of characters in common with `t`. See CharacterDifference::commoncharacters().
+             */
+            int commoncharacters(const string& t) const {
+                // Counts of the characters of t already matched, kept zeroed between calls.
+                static thread_local int used[256] = {0};
+
+                int common = 0;
+                for (size_t i = 0; i < t.size(); i++) {
+                    unsigned char c = t[i];
+                    int match = (used[c] < histogram[c]);
+                    used[c] += match;
+                    common += match;
+                }
+
+                // Only the counts of the characters of t need to be reset.
+                for (size_t i = 0; i < t.size(); i++) {
+                    used[(unsigned char)t[i]] = 0;
+                }
+
+                return common;
+            }
+
+            bool isSimilarity() const {
+                return similarity;
+            }
+
+            using CachedComparator<string>::compare;
+
+            double compare(const string& t) const {
+                int len = s.size() + t.size();
+
+                if (len == 0) {
+                    return similarity;
+                }
+
+                return editScore(len - 2 * commoncharacters(t), len, normalize, similarity);
+            }
+        };
+
+        /**
+         * @brief Prepare one-to-many comparisons from a fixed first string.
+         */
+        Cached prepare(const string& s) const {
+            return Cached(s, normalize, similarity);
+        }
+    };
+
+    /**
+     * @brief CharacterDifference comparator with compile-time normalization and similarity options. See CharacterDifference.
+     */
+    template<bool normalize = true, bool similarity = false>
+    class StaticCharacterDifference : public StaticComparator<StaticCharacterDifference<normalize, similarity>, string> {
+    public:
+
+        static bool isSimilarity() {
+            return similarity;
+        }
+
+        using StaticComparator<StaticCharacterDifference, string>::compare;
+
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t) const {
+            double len = s.size() + t.size();
+            if (len == 0) {
+                return similarity;
+            }
+
+            return editScore<normalize, similarity>(len - 2.0 * CharacterDifference::commoncharacters(s, t), len);
+        }
+
     };
 
 }
@@ -9,10 +9,19 @@
 #ifndef STRINGCOMPARE_DISTANCE_COMPARATOR_HPP_INCLUDED
 #define STRINGCOMPARE_DISTANCE_COMPARATOR_HPP_INCLUDED
 
+#include <math.h>
+#include <algorithm>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <stdexcept>
 
+#include "../utils/parallel.h"
+#include "../utils/stringcolumn.h"
+
 using namespace std;
 
 namespace stringcompare {
@@ -21,34 +30,192 @@ namespace stringcompare {
     using Mat = vector<vector<T>>;
 
     /**
-     * @brief Base class for comparators.
+     * @brief Number of elements per unit of work in parallel elementwise comparisons.
+     */
+    const size_t ELEMENTWISE_TILE = 1024;
+
+    /**
+     * @brief Number of rows per unit of work in parallel pairwise comparisons.
+     */
+    const size_t PAIRWISE_TILE_ROWS = 16;
+
+    /**
+     * @brief Number of columns per unit of work in parallel pairwise comparisons.
+     */
+    const size_t PAIRWISE_TILE_COLS = 256;
+
+    /**
+     * @brief Number of unordered pairs of `n` elements.
+     */
+    inline size_t condensedSize(size_t n) {
+        return (n < 2) ? 0 : n * (n - 1) / 2;
+    }
+
+    /**
+     * @brief Position of the pair (i,j), i < j, in condensed pairwise comparisons of `n` elements.
+     */
+    inline size_t condensedIndex(size_t n, size_t i, size_t j) {
+        return n * i - i * (i + 1) / 2 + (j - i - 1);
+    }
+
+    /**
+     * @brief Number of candidates scored at once by extractBest().
+     */
+    const size_t EXTRACT_BLOCK = 64;
+
+    /**
+     * @brief Best `k` of `n` candidates, as (index, score) pairs sorted from best to worst.
+     *
+     * Candidates are scored by blocks of `EXTRACT_BLOCK` and kept in a bounded heap. Once `k` candidates are found, the 
+     * worst score of the heap is used as the cutoff of the following blocks. Ties are broken in favor of the smallest index.
+     *
+     * @param similarity Whether higher scores are better.
+     * @param has_cutoff Whether candidates must beat `cutoff` (`<= cutoff` for distances, `>= cutoff` for similarities).
+     * @param score Callable `score(i, count, out)` writing the scores of candidates `i` to `i + count - 1` to `out`. See 
+     * Comparator::compareMany().
+     * @param score_cutoff Callable `score_cutoff(i, count, out, cutoff)` doing the same with a score cutoff.
+     */
+    template<class Score, class ScoreCutoff>
+    vector<pair<size_t, double>> extractBest(size_t n, size_t k, bool similarity, bool has_cutoff, double cutoff,
+        const Score& score, const ScoreCutoff& score_cutoff) {
+
+        auto better = [similarity](const pair<size_t, double>& a, const pair<size_t, double>& b) {
+            if (a.second != b.second) {
+                return similarity ? (a.second > b.second) : (a.second < b.second);
+            }
+            return a.first < b.first;
+        };
+
+        // Max-heap with respect to `better`, so that the worst kept candidate is on top.
+        vector<pair<size_t, double>> heap;
+        heap.reserve(min(n, k));
+        if (k == 0) {
+            return heap;
+        }
+
+        double values[EXTRACT_BLOCK];
+        for (size_t i0 = 0; i0 < n; i0 += EXTRACT_BLOCK) {
+            size_t count = min(EXTRACT_BLOCK, n - i0);
+            if (heap.size() == k) {
+                cutoff = heap.front().second;
+                has_cutoff = true;
+            }
+
+            if (has_cutoff) {
+                score_cutoff(i0, count, values, cutoff);
+            }
+            else {
+                score(i0, count, values);
+            }
+
+            for (size_t i = 0; i < count; i++) {
+                if (has_cutoff && (similarity ? (values[i] < cutoff) : (values[i] > cutoff))) {
+                    continue;
+                }
+
+                pair<size_t, double> candidate(i0 + i, values[i]);
+                if (heap.size() < k) {
+                    heap.push_back(candidate);
+                    push_heap(heap.begin(), heap.end(), better);
+                }
+                else if (better(candidate, heap.front())) {
+                    pop_heap(heap.begin(), heap.end(), better);
+                    heap.back() = candidate;
+                    push_heap(heap.begin(), heap.end(), better);
+                }
+            }
+        }
+
+        sort(heap.begin(), heap.end(), better);
+
+        return heap;
+    }
+
+    /**
+     * @brief Batch functions shared by comparators with dynamic and static dispatch.
+     *
+     * Implements the callable @c operator()(), and the @c elementwise(), @c pairwise(), @c condensed() and @c extract()
+     * functions on top of the `compare()`, `compareMany()` and `isSimilarity()` functions of `Derived`. These are virtual
+     * calls for subclasses of Comparator, and are inlined in the batch loops for subclasses of StaticComparator.
      *
-     * Requires a compare() function. Implements the callable @c operator()(), and the @c elementwise() and @c pairwise() functions.
+     * Overloads over StringColumn objects read strings in place, through the `compareViews()` and `compareManyViews()`
+     * functions of `Derived`.
      *
+     * @tparam Derived Comparator class (CRTP).
      * @tparam dtype Type of objects to compare (typically `string`).
      */
-    template<class dtype>
-    class Comparator {
+    template<class Derived, class dtype>
+    class BatchComparator {
     public:
 
         /**
-         * @brief Interface to comparison functions.
+         * @brief Instances are callable for simplicity.
          *
          * @param s Object to compare from.
          * @param t Object to compare to.
-         * @return double Comparison value.
+         * @return double Comparison value between s and t.
          */
-        virtual double compare(const dtype& s, const dtype& t) = 0;
+        double operator()(const dtype& s, const dtype& t) const {
+            return self().compare(s, t);
+        }
 
         /**
-         * @brief Instances are callable for simplicity.
+         * @brief Callable comparison with a score cutoff. See Comparator::compare(const dtype&, const dtype&, double).
+         */
+        double operator()(const dtype& s, const dtype& t, double cutoff) const {
+            return self().compare(s, t, cutoff);
+        }
+
+        /**
+         * @brief Best `k` matches of `query` among `choices`.
          *
-         * @param s Object to compare from.
-         * @param t Object to compare to.
-         * @return double Comparison value between s and t.
+         * The full row of comparisons is not materialized: a bounded heap keeps the best matches found so far, and the
+         * worst of them is used as the cutoff of the following comparisons, so that comparators supporting cutoffs can
+         * stop early.
+         *
+         * @param query Object to compare from.
+         * @param choices Objects to compare to.
+         * @param k Number of matches to return.
+         * @return vector<pair<size_t, double>> (index, score) pairs of the best matches, sorted from best to worst. Ties are
+         * broken in favor of the smallest index.
          */
-        double operator()(const dtype& s, const dtype& t) {
-            return compare(s, t);
+        vector<pair<size_t, double>> extract(const dtype& query, const vector<dtype>& choices, size_t k) const {
+            return extractBest(choices.size(), k, self().isSimilarity(), false, 0,
+                [&](size_t i, size_t count, double* out) { self().compareMany(query, &choices[i], count, out); },
+                [&](size_t i, size_t count, double* out, double c) { self().compareMany(query, &choices[i], count, out, c); });
+        }
+
+        /**
+         * @brief Best `k` matches of `query` among `choices` which beat a score cutoff.
+         *
+         * @param cutoff Score cutoff. See Comparator::compare(const dtype&, const dtype&, double).
+         */
+        vector<pair<size_t, double>> extract(const dtype& query, const vector<dtype>& choices, size_t k, double cutoff) const {
+            return extractBest(choices.size(), k, self().isSimilarity(), true, cutoff,
+                [&](size_t i, size_t count, double* out) { self().compareMany(query, &choices[i], count, out); },
+                [&](size_t i, size_t count, double* out, double c) { self().compareMany(query, &choices[i], count, out, c); });
+        }
+
+        /**
+         * @brief Best match of `query` among `choices`, if any. See extract().
+         */
+        optional<pair<size_t, double>> extractOne(const dtype& query, const vector<dtype>& choices) const {
+            auto result = extract(query, choices, 1);
+            if (result.empty()) {
+                return nullopt;
+            }
+            return result[0];
+        }
+
+        /**
+         * @brief Best match of `query` among `choices` which beats a score cutoff, if any. See extract().
+         */
+        optional<pair<size_t, double>> extractOne(const dtype& query, const vector<dtype>& choices, double cutoff) const {
+            auto result = extract(query, choices, 1, cutoff);
+            if (result.empty()) {
+                return nullopt;
+            }
+            return result[0];
         }
 
         /**
@@ -56,18 +223,23 @@ namespace stringcompare {
          *
          * @param l1 Vector of elements to compare from.
          * @param l2 Vector of elements to compare to.
+         * @param nthreads Number of threads. Values smaller than 1 use all hardware threads. Defaults to 1.
          * @return vector<double> Vector of comparison values between coresponding elements in the lists.
          */
-        vector<double> elementwise(const vector<dtype>& l1, const vector<dtype>& l2) {
+        vector<double> elementwise(const vector<dtype>& l1, const vector<dtype>& l2, int nthreads = 1) const {
 
             if (l1.size() != l2.size()) {
                 throw runtime_error("Lists should be of the same size.");
             }
 
             vector<double> result(l1.size());
-            for (size_t i = 0; i < l1.size(); i++) {
-                result[i] = this->compare(l1[i], l2[i]);
-            }
+            size_t ntiles = (l1.size() + ELEMENTWISE_TILE - 1) / ELEMENTWISE_TILE;
+            parallelFor(ntiles, nthreads, [&](size_t tile) {
+                size_t end = min(l1.size(), (tile + 1) * ELEMENTWISE_TILE);
+                for (size_t i = tile * ELEMENTWISE_TILE; i < end; i++) {
+                    result[i] = self().compare(l1[i], l2[i]);
+                }
+            });
 
             return result;
         }
@@ -77,29 +249,818 @@ namespace stringcompare {
          *
          * @param l1 Vector of elements to compare from.
          * @param l2 Vector of elements to compare to.
+         * @param nthreads Number of threads. Values smaller than 1 use all hardware threads. Defaults to 1.
          * @return Mat<double> Matrix of comparison values, where element (i,j) is the comparison between the first list's ith element and the second list jth element.
          */
-        Mat<double> pairwise(const vector<dtype>& l1, const vector<dtype>& l2) {
-            Mat<double> result;
-            result.reserve(l1.size());
-            for (size_t i = 0; i < l1.size(); i++) {
-                result[i].reserve(l2.size());
-                for (size_t j = 0; j < l2.size(); j++) {
-                    result[i][j] = this->compare(l1[i], l2[j]);
-                }
+        Mat<double> pairwise(const vector<dtype>& l1, const vector<dtype>& l2, int nthreads = 1) const {
+            Mat<double> result(l1.size(), vector<double>(l2.size()));
+
+            forEachPair(l1.size(), l2.size(), false, nthreads, [&](size_t i, size_t j0, size_t j1) {
+                self().compareMany(l1[i], &l2[j0], j1 - j0, &result[i][j0]);
+            });
+
+            return result;
+        }
+
+        /**
+         * @brief Pairwise comparisons written to a caller-provided row-major buffer.
+         *
+         * Element (i,j) is written at `out[i * l2.size() + j]`. For integer output types, comparison values are truncated,
+         * so that comparators should be constructed with `normalize = false` to obtain raw distances.
+         *
+         * @tparam T Output type (e.g. `double`, `float` or `int32_t`).
+         * @param l1 Vector of elements to compare from.
+         * @param l2 Vector of elements to compare to.
+         * @param out Buffer of at least `l1.size() * l2.size()` elements.
+         * @param nthreads Number of threads. Values smaller than 1 use all hardware threads. Defaults to 1.
+         */
+        template<class T>
+        void pairwise(const vector<dtype>& l1, const vector<dtype>& l2, T* out, int nthreads = 1) const {
+            size_t n2 = l2.size();
+            forEachPair(l1.size(), n2, false, nthreads, [&](size_t i, size_t j0, size_t j1) {
+                store(l1[i], &l2[j0], j1 - j0, out + i * n2 + j0);
+            });
+        }
+
+        /**
+         * @brief Condensed pairwise comparisons between the elements of a vector.
+         *
+         * Each unordered pair (i,j), i < j, is compared once. Values are stored in the order of the upper triangle of the
+         * comparison matrix, row by row, as in scipy's `pdist()`. See condensedIndex().
+         *
+         * @param l Vector of elements to compare.
+         * @param nthreads Number of threads. Values smaller than 1 use all hardware threads. Defaults to 1.
+         * @return vector<double> Vector of `n * (n - 1) / 2` comparison values, where `n = l.size()`.
+         */
+        vector<double> condensed(const vector<dtype>& l, int nthreads = 1) const {
+            vector<double> result(condensedSize(l.size()));
+            condensed(l, result.data(), nthreads);
+
+            return result;
+        }
+
+        /**
+         * @brief Condensed pairwise comparisons written to a caller-provided buffer. See condensed(const vector<dtype>&, int).
+         *
+         * @tparam T Output type (e.g. `double`, `float` or `int32_t`).
+         * @param l Vector of elements to compare.
+         * @param out Buffer of at least `condensedSize(l.size())` elements.
+         * @param nthreads Number of threads. Values smaller than 1 use all hardware threads. Defaults to 1.
+         */
+        template<class T>
+        void condensed(const vector<dtype>& l, T* out, int nthreads = 1) const {
+            size_t n = l.size();
+            forEachPair(n, n, true, nthreads, [&](size_t i, size_t j0, size_t j1) {
+                store(l[i], &l[j0], j1 - j0, out + condensedIndex(n, i, j0));
+            });
+        }
+
+        /**
+         * @brief Elementwise comparisons between columns. See elementwise(const vector<dtype>&, const vector<dtype>&, int).
+         */
+        template<class Offset>
+        vector<double> elementwise(const BasicStringColumn<Offset>& l1, const BasicStringColumn<Offset>& l2, int nthreads = 1) const {
+            if (l1.size() != l2.size()) {
+                throw runtime_error("Lists should be of the same size.");
             }
 
+            vector<double> result(l1.size());
+            size_t ntiles = (l1.size() + ELEMENTWISE_TILE - 1) / ELEMENTWISE_TILE;
+            parallelFor(ntiles, nthreads, [&](size_t tile) {
+                size_t end = min(l1.size(), (tile + 1) * ELEMENTWISE_TILE);
+                for (size_t i = tile * ELEMENTWISE_TILE; i < end; i++) {
+                    result[i] = self().compareViews(l1[i], l2[i]);
+                }
+            });
+
             return result;
         }
 
+        /**
+         * @brief Pairwise comparisons between columns. See pairwise(const vector<dtype>&, const vector<dtype>&, int).
+         */
+        template<class Offset>
+        Mat<double> pairwise(const BasicStringColumn<Offset>& l1, const BasicStringColumn<Offset>& l2, int nthreads = 1) const {
+            Mat<double> result(l1.size(), vector<double>(l2.size()));
+
+            forEachPair(l1.size(), l2.size(), false, nthreads, [&](size_t i, size_t j0, size_t j1) {
+                storeViews(l1[i], l2, j0, j1, &result[i][j0]);
+            });
+
+            return result;
+        }
+
+        /**
+         * @brief Pairwise comparisons between columns, written to a caller-provided row-major buffer. See pairwise().
+         */
+        template<class Offset, class T>
+        void pairwise(const BasicStringColumn<Offset>& l1, const BasicStringColumn<Offset>& l2, T* out, int nthreads = 1) const {
+            size_t n2 = l2.size();
+            forEachPair(l1.size(), n2, false, nthreads, [&](size_t i, size_t j0, size_t j1) {
+                storeViews(l1[i], l2, j0, j1, out + i * n2 + j0);
+            });
+        }
+
+        /**
+         * @brief Condensed pairwise comparisons between the strings of a column. See condensed(const vector<dtype>&, int).
+         */
+        template<class Offset>
+        vector<double> condensed(const BasicStringColumn<Offset>& l, int nthreads = 1) const {
+            vector<double> result(condensedSize(l.size()));
+            condensed(l, result.data(), nthreads);
+
+            return result;
+        }
+
+        /**
+         * @brief Condensed pairwise comparisons written to a caller-provided buffer. See condensed(const vector<dtype>&, int).
+         */
+        template<class Offset, class T>
+        void condensed(const BasicStringColumn<Offset>& l, T* out, int nthreads = 1) const {
+            size_t n = l.size();
+            forEachPair(n, n, true, nthreads, [&](size_t i, size_t j0, size_t j1) {
+                storeViews(l[i], l, j0, j1, out + condensedIndex(n, i, j0));
+            });
+        }
+
+        /**
+         * @brief Best `k` matches of `query` among the strings of a column. See extract().
+         */
+        template<class Offset>
+        vector<pair<size_t, double>> extract(string_view query, const BasicStringColumn<Offset>& choices, size_t k) const {
+            return extractViews(query, choices, k, false, 0);
+        }
+
+        /**
+         * @brief Best `k` matches of `query` among the strings of a column which beat a score cutoff. See extract().
+         */
+        template<class Offset>
+        vector<pair<size_t, double>> extract(string_view query, const BasicStringColumn<Offset>& choices, size_t k, double cutoff) const {
+            return extractViews(query, choices, k, true, cutoff);
+        }
+
+        /**
+         * @brief Best match of `query` among the strings of a column, if any. See extract().
+         */
+        template<class Offset>
+        optional<pair<size_t, double>> extractOne(string_view query, const BasicStringColumn<Offset>& choices) const {
+            auto result = extract(query, choices, 1);
+            if (result.empty()) {
+                return nullopt;
+            }
+            return result[0];
+        }
+
+        /**
+         * @brief Best match of `query` among the strings of a column which beats a score cutoff, if any. See extract().
+         */
+        template<class Offset>
+        optional<pair<size_t, double>> extractOne(string_view query, const BasicStringColumn<Offset>& choices, double cutoff) const {
+            auto result = extract(query, choices, 1, cutoff);
+            if (result.empty()) {
+                return nullopt;
+            }
+            return result[0];
+        }
+
+    protected:
+
+        const Derived& self() const {
+            return static_cast<const Derived&>(*this);
+        }
+
+        /**
+         * @brief compareMany() into an output array of any type, through a buffer of at most `PAIRWISE_TILE_COLS` values.
+         */
+        template<class T>
+        void store(const dtype& s, const dtype* t, size_t count, T* out) const {
+            double values[PAIRWISE_TILE_COLS];
+            self().compareMany(s, t, count, values);
+            for (size_t i = 0; i < count; i++) {
+                out[i] = static_cast<T>(values[i]);
+            }
+        }
+
+        void store(const dtype& s, const dtype* t, size_t count, double* out) const {
+            self().compareMany(s, t, count, out);
+        }
+
+        /**
+         * @brief Views of the `count` strings of a column starting at `j0`.
+         */
+        template<class Offset>
+        static void gatherViews(const BasicStringColumn<Offset>& l, size_t j0, size_t count, string_view* views) {
+            for (size_t j = 0; j < count; j++) {
+                views[j] = l[j0 + j];
+            }
+        }
+
+        /**
+         * @brief compareManyViews() of `s` with the strings `j0` to `j1 - 1` of a column, with `j1 - j0` at most
+         * `PAIRWISE_TILE_COLS`, into an output array of any type.
+         */
+        template<class Offset, class T>
+        void storeViews(string_view s, const BasicStringColumn<Offset>& l, size_t j0, size_t j1, T* out) const {
+            string_view views[PAIRWISE_TILE_COLS];
+            double values[PAIRWISE_TILE_COLS];
+            size_t count = j1 - j0;
+            gatherViews(l, j0, count, views);
+            self().compareManyViews(s, views, count, values);
+            for (size_t j = 0; j < count; j++) {
+                out[j] = static_cast<T>(values[j]);
+            }
+        }
+
+        /**
+         * @brief extract() over the strings of a column.
+         */
+        template<class Offset>
+        vector<pair<size_t, double>> extractViews(string_view query, const BasicStringColumn<Offset>& choices, size_t k,
+            bool has_cutoff, double cutoff) const {
+            return extractBest(choices.size(), k, self().isSimilarity(), has_cutoff, cutoff,
+                [&](size_t i, size_t count, double* out) {
+                    string_view views[EXTRACT_BLOCK];
+                    gatherViews(choices, i, count, views);
+                    self().compareManyViews(query, views, count, out);
+                },
+                [&](size_t i, size_t count, double* out, double c) {
+                    string_view views[EXTRACT_BLOCK];
+                    gatherViews(choices, i, count, views);
+                    self().compareManyViews(query, views, count, out, c);
+                });
+        }
+
+        /**
+         * @brief Call `f(i, j0, j1)` for every row `i` and column range `[j0, j1)` of the tiles of an `n1` by `n2` matrix, 
+         * in parallel.
+         *
+         * The matrix is split in tiles of `PAIRWISE_TILE_ROWS` rows and `PAIRWISE_TILE_COLS` columns, which are the units
+         * of work shared between threads.
+         *
+         * @param upper Whether to restrict to the pairs above the diagonal (i < j).
+         */
+        template<class F>
+        static void forEachPair(size_t n1, size_t n2, bool upper, int nthreads, const F& f) {
+            size_t tile_rows = (n1 + PAIRWISE_TILE_ROWS - 1) / PAIRWISE_TILE_ROWS;
+            size_t tile_cols = (n2 + PAIRWISE_TILE_COLS - 1) / PAIRWISE_TILE_COLS;
+            parallelFor(tile_rows * tile_cols, nthreads, [&](size_t tile) {
+                size_t i0 = (tile / tile_cols) * PAIRWISE_TILE_ROWS;
+                size_t j0 = (tile % tile_cols) * PAIRWISE_TILE_COLS;
+                size_t i1 = min(n1, i0 + PAIRWISE_TILE_ROWS);
+                size_t j1 = min(n2, j0 + PAIRWISE_TILE_COLS);
+                for (size_t i = i0; i < i1; i++) {
+                    size_t j = upper ? max(j0, i + 1) : j0;
+                    if (j < j1) {
+                        f(i, j, j1);
+                    }
+                }
+            });
+        }
+
+    };
+
+    /**
+     * @brief Base class for comparators.
+     *
+     * Requires a compare() function. The callable @c operator()(), and the @c elementwise() and @c pairwise() functions 
+     * are inherited from BatchComparator and call compare() and compareMany() virtually, or compareViews() and
+     * compareManyViews() for StringColumn objects.
+     *
+     * Comparisons are const and keep their scratch buffers in thread-local storage, so that a single instance can be
+     * shared by the threads of elementwise() and pairwise().
+     *
+     * @tparam dtype Type of objects to compare (typically `string`).
+     */
+    template<class dtype>
+    class Comparator : public BatchComparator<Comparator<dtype>, dtype> {
+    public:
+
+        /**
+         * @brief Interface to comparison functions.
+         *
+         * @param s Object to compare from.
+         * @param t Object to compare to.
+         * @return double Comparison value.
+         */
+        virtual double compare(const dtype& s, const dtype& t) const = 0;
+
+        /**
+         * @brief Comparison with a score cutoff.
+         *
+         * The cutoff is the largest distance of interest, or the smallest similarity score of interest for comparators 
+         * returning similarities. When the comparison value cannot beat the cutoff, implementations may stop early and 
+         * return a sentinel value which does not beat it either. The default implementation returns compare(s, t).
+         *
+         * @param s Object to compare from.
+         * @param t Object to compare to.
+         * @param cutoff Score cutoff.
+         * @return double Comparison value, or a sentinel value if it does not beat the cutoff.
+         */
+        virtual double compare(const dtype& s, const dtype& t, double /*cutoff*/) const {
+            return compare(s, t);
+        }
+
+        /**
+         * @brief Comparisons of `s` with each of `count` objects, written to `out`.
+         *
+         * This is the entry point of pairwise() and extract(). Comparators with batch kernels override it; the default 
+         * implementation calls compare() on each object.
+         *
+         * @param s Object to compare from.
+         * @param t Array of `count` objects to compare to.
+         * @param count Number of objects to compare to.
+         * @param out Array of at least `count` comparison values.
+         */
+        virtual void compareMany(const dtype& s, const dtype* t, size_t count, double* out) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = compare(s, t[i]);
+            }
+        }
+
+        /**
+         * @brief Comparisons of `s` with each of `count` objects, with a score cutoff. See compare(const dtype&, const dtype&, double).
+         */
+        virtual void compareMany(const dtype& s, const dtype* t, size_t count, double* out, double cutoff) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = compare(s, t[i], cutoff);
+            }
+        }
+
+        /**
+         * @brief Comparison between `string_view`s.
+         *
+         * The default implementation copies the views into thread-local objects, which only allocate when they grow.
+         * Comparators whose kernels take any sequence of characters override it to compare the views in place. Throws for
+         * objects which cannot be constructed from a `string_view`.
+         */
+        virtual double compareViews(string_view s, string_view t) const {
+            if constexpr (is_constructible<dtype, string_view>::value) {
+                static thread_local dtype s_copy;
+                static thread_local dtype t_copy;
+                s_copy.assign(s.data(), s.size());
+                t_copy.assign(t.data(), t.size());
+
+                return compare(s_copy, t_copy);
+            }
+            else {
+                throw runtime_error("Comparisons of string views are not supported by this comparator.");
+            }
+        }
+
+        /**
+         * @brief Comparison between `string_view`s with a score cutoff. See compare(const dtype&, const dtype&, double).
+         *
+         * The default implementation ignores the cutoff. Comparators with cutoff kernels override it.
+         */
+        virtual double compareViews(string_view s, string_view t, double /*cutoff*/) const {
+            return compareViews(s, t);
+        }
+
+        /**
+         * @brief Comparisons of `s` with each of `count` `string_view`s, written to `out`.
+         *
+         * This is the entry point of the batch functions over StringColumn objects, as compareMany() is for vectors. The
+         * default implementation calls compareViews() on each view.
+         */
+        virtual void compareManyViews(string_view s, const string_view* t, size_t count, double* out) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = compareViews(s, t[i]);
+            }
+        }
+
+        /**
+         * @brief Comparisons of `s` with each of `count` `string_view`s, with a score cutoff.
+         */
+        virtual void compareManyViews(string_view s, const string_view* t, size_t count, double* out, double cutoff) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = compareViews(s, t[i], cutoff);
+            }
+        }
+
+        /**
+         * @brief Whether comparison values are similarities (higher is better) rather than distances.
+         */
+        virtual bool isSimilarity() const {
+            return false;
+        }
+
+    };
+
+    /**
+     * @brief Base class for comparators with static dispatch.
+     *
+     * `Derived` implements a non-virtual `compare(const dtype&, const dtype&) const` function and a static 
+     * `isSimilarity()` function, typically from compile-time normalization and similarity parameters. The batch 
+     * functions are then instantiated for `Derived`, with comparisons inlined and no virtual call.
+     *
+     * `Derived` may also implement `compare(const dtype&, const dtype&, double) const` with a cutoff kernel. Otherwise,
+     * it should bring the default implementation of this class in scope with a using-declaration.
+     *
+     * Comparisons of `string_view`s, as in the batch functions over StringColumn objects, call `Derived::compare()` on
+     * the views, so that it should be a template over sequences of characters.
+     *
+     * Use DynamicComparator to pass these comparators where a Comparator is expected.
+     *
+     * @tparam Derived Comparator class (CRTP).
+     * @tparam dtype Type of objects to compare (typically `string`).
+     */
+    template<class Derived, class dtype>
+    class StaticComparator : public BatchComparator<Derived, dtype> {
+    public:
+
+        /**
+         * @brief Comparison with a score cutoff. See Comparator::compare(const dtype&, const dtype&, double).
+         *
+         * The default implementation ignores the cutoff.
+         */
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t, double /*cutoff*/) const {
+            return static_cast<const Derived&>(*this).compare(s, t);
+        }
+
+        /**
+         * @brief Comparisons of `s` with each of `count` objects, written to `out`. See Comparator::compareMany().
+         */
+        void compareMany(const dtype& s, const dtype* t, size_t count, double* out) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = static_cast<const Derived&>(*this).compare(s, t[i]);
+            }
+        }
+
+        /**
+         * @brief Comparisons with a score cutoff, which `Derived::compare()` receives.
+         */
+        void compareMany(const dtype& s, const dtype* t, size_t count, double* out, double cutoff) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = static_cast<const Derived&>(*this).compare(s, t[i], cutoff);
+            }
+        }
+
+        /**
+         * @brief Comparison between `string_view`s. See Comparator::compareViews().
+         */
+        double compareViews(string_view s, string_view t) const {
+            return static_cast<const Derived&>(*this).compare(s, t);
+        }
+
+        double compareViews(string_view s, string_view t, double cutoff) const {
+            return static_cast<const Derived&>(*this).compare(s, t, cutoff);
+        }
+
+        /**
+         * @brief Comparisons of `s` with each of `count` `string_view`s. See Comparator::compareManyViews().
+         */
+        void compareManyViews(string_view s, const string_view* t, size_t count, double* out) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = static_cast<const Derived&>(*this).compare(s, t[i]);
+            }
+        }
+
+        void compareManyViews(string_view s, const string_view* t, size_t count, double* out, double cutoff) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = static_cast<const Derived&>(*this).compare(s, t[i], cutoff);
+            }
+        }
+
+    };
+
+    /**
+     * @brief Comparator with dynamic dispatch wrapping a comparator with static dispatch.
+     *
+     * @tparam Static Subclass of StaticComparator.
+     * @tparam dtype Type of objects to compare (typically `string`).
+     */
+    template<class Static, class dtype = string>
+    class DynamicComparator : public Comparator<dtype> {
+    public:
+
+        Static comparator;
+
+        explicit DynamicComparator(const Static& comparator = Static()) :
+            comparator(comparator) {}
+
+        double compare(const dtype& s, const dtype& t) const {
+            return comparator.compare(s, t);
+        }
+
+        double compare(const dtype& s, const dtype& t, double cutoff) const {
+            return comparator.compare(s, t, cutoff);
+        }
+
+        void compareMany(const dtype& s, const dtype* t, size_t count, double* out) const {
+            comparator.compareMany(s, t, count, out);
+        }
+
+        void compareMany(const dtype& s, const dtype* t, size_t count, double* out, double cutoff) const {
+            comparator.compareMany(s, t, count, out, cutoff);
+        }
+
+        double compareViews(string_view s, string_view t) const {
+            return comparator.compareViews(s, t);
+        }
+
+        double compareViews(string_view s, string_view t, double cutoff) const {
+            return comparator.compareViews(s, t, cutoff);
+        }
+
+        void compareManyViews(string_view s, const string_view* t, size_t count, double* out) const {
+            comparator.compareManyViews(s, t, count, out);
+        }
+
+        void compareManyViews(string_view s, const string_view* t, size_t count, double* out, double cutoff) const {
+            comparator.compareManyViews(s, t, count, out, cutoff);
+        }
+
+        bool isSimilarity() const {
+            return comparator.isSimilarity();
+        }
+
+    };
+
+    /**
+     * @brief Base class for comparators with a fixed first argument.
+     *
+     * Instances are returned by the `prepare()` function of comparators, which precomputes everything about the first 
+     * argument once for one-to-many comparisons.
+     *
+     * @tparam dtype Type of objects to compare (typically `string`).
+     */
+    template<class dtype>
+    class CachedComparator {
+    public:
+
+        /**
+         * @brief Comparison between the prepared object and `t`.
+         */
+        virtual double compare(const dtype& t) const = 0;
+
+        /**
+         * @brief Comparison with a score cutoff. See Comparator::compare(const dtype&, const dtype&, double).
+         */
+        virtual double compare(const dtype& t, double /*cutoff*/) const {
+            return compare(t);
+        }
+
+        /**
+         * @brief Comparisons between the prepared object and each of `count` objects. See Comparator::compareMany().
+         */
+        virtual void compareMany(const dtype* t, size_t count, double* out) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = compare(t[i]);
+            }
+        }
+
+        /**
+         * @brief Comparisons between the prepared object and each of `count` objects, with a score cutoff.
+         */
+        virtual void compareMany(const dtype* t, size_t count, double* out, double cutoff) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = compare(t[i], cutoff);
+            }
+        }
+
+        /**
+         * @brief Comparison between the prepared object and a `string_view`. See Comparator::compareViews().
+         *
+         * The default implementation copies the view into a thread-local object.
+         */
+        virtual double compareViews(string_view t) const {
+            return compare(viewCopy(t));
+        }
+
+        virtual double compareViews(string_view t, double cutoff) const {
+            return compare(viewCopy(t), cutoff);
+        }
+
+        /**
+         * @brief Comparisons between the prepared object and each of `count` `string_view`s. See
+         * Comparator::compareManyViews().
+         */
+        virtual void compareManyViews(const string_view* t, size_t count, double* out) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = compareViews(t[i]);
+            }
+        }
+
+        virtual void compareManyViews(const string_view* t, size_t count, double* out, double cutoff) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = compareViews(t[i], cutoff);
+            }
+        }
+
+        double operator()(const dtype& t) const {
+            return compare(t);
+        }
+
+        double operator()(const dtype& t, double cutoff) const {
+            return compare(t, cutoff);
+        }
+
+        /**
+         * @brief Whether comparison values are similarities (higher is better) rather than distances.
+         */
+        virtual bool isSimilarity() const {
+            return false;
+        }
+
+        /**
+         * @brief Best `k` matches of the prepared object among `choices`. See Comparator::extract().
+         */
+        vector<pair<size_t, double>> extract(const vector<dtype>& choices, size_t k) const {
+            return extractBest(choices.size(), k, isSimilarity(), false, 0,
+                [&](size_t i, size_t count, double* out) { this->compareMany(&choices[i], count, out); },
+                [&](size_t i, size_t count, double* out, double c) { this->compareMany(&choices[i], count, out, c); });
+        }
+
+        /**
+         * @brief Best `k` matches of the prepared object among `choices` which beat a score cutoff. See Comparator::extract().
+         */
+        vector<pair<size_t, double>> extract(const vector<dtype>& choices, size_t k, double cutoff) const {
+            return extractBest(choices.size(), k, isSimilarity(), true, cutoff,
+                [&](size_t i, size_t count, double* out) { this->compareMany(&choices[i], count, out); },
+                [&](size_t i, size_t count, double* out, double c) { this->compareMany(&choices[i], count, out, c); });
+        }
+
+        /**
+         * @brief Best match of the prepared object among `choices`, if any. See Comparator::extract().
+         */
+        optional<pair<size_t, double>> extractOne(const vector<dtype>& choices) const {
+            auto result = extract(choices, 1);
+            if (result.empty()) {
+                return nullopt;
+            }
+            return result[0];
+        }
+
+        /**
+         * @brief Best match of the prepared object among `choices` which beats a score cutoff, if any. See Comparator::extract().
+         */
+        optional<pair<size_t, double>> extractOne(const vector<dtype>& choices, double cutoff) const {
+            auto result = extract(choices, 1, cutoff);
+            if (result.empty()) {
+                return nullopt;
+            }
+            return result[0];
+        }
+
+        /**
+         * @brief Best `k` matches of the prepared object among the strings of a column. See Comparator::extract().
+         */
+        template<class Offset>
+        vector<pair<size_t, double>> extract(const BasicStringColumn<Offset>& choices, size_t k) const {
+            return extractViews(choices, k, false, 0);
+        }
+
+        /**
+         * @brief Best `k` matches of the prepared object among the strings of a column which beat a score cutoff. See
+         * Comparator::extract().
+         */
+        template<class Offset>
+        vector<pair<size_t, double>> extract(const BasicStringColumn<Offset>& choices, size_t k, double cutoff) const {
+            return extractViews(choices, k, true, cutoff);
+        }
+
+        /**
+         * @brief Best match of the prepared object among the strings of a column, if any. See Comparator::extract().
+         */
+        template<class Offset>
+        optional<pair<size_t, double>> extractOne(const BasicStringColumn<Offset>& choices) const {
+            auto result = extract(choices, 1);
+            if (result.empty()) {
+                return nullopt;
+            }
+            return result[0];
+        }
+
+        /**
+         * @brief Best match of the prepared object among the strings of a column which beats a score cutoff, if any. See
+         * Comparator::extract().
+         */
+        template<class Offset>
+        optional<pair<size_t, double>> extractOne(const BasicStringColumn<Offset>& choices, double cutoff) const {
+            auto result = extract(choices, 1, cutoff);
+            if (result.empty()) {
+                return nullopt;
+            }
+            return result[0];
+        }
+
+    private:
+
+        /**
+         * @brief Copy of a view in a thread-local object, which only allocates when it grows.
+         */
+        static const dtype& viewCopy(string_view t) {
+            if constexpr (is_constructible<dtype, string_view>::value) {
+                static thread_local dtype copy;
+                copy.assign(t.data(), t.size());
+                return copy;
+            }
+            else {
+                throw runtime_error("Comparisons of string views are not supported by this comparator.");
+            }
+        }
+
+        template<class Offset>
+        vector<pair<size_t, double>> extractViews(const BasicStringColumn<Offset>& choices, size_t k, bool has_cutoff,
+            double cutoff) const {
+            return extractBest(choices.size(), k, isSimilarity(), has_cutoff, cutoff,
+                [&](size_t i, size_t count, double* out) {
+                    string_view views[EXTRACT_BLOCK];
+                    for (size_t j = 0; j < count; j++) {
+                        views[j] = choices[i + j];
+                    }
+                    this->compareManyViews(views, count, out);
+                },
+                [&](size_t i, size_t count, double* out, double c) {
+                    string_view views[EXTRACT_BLOCK];
+                    for (size_t j = 0; j < count; j++) {
+                        views[j] = choices[i + j];
+                    }
+                    this->compareManyViews(views, count, out, c);
+                });
+        }
+
     };
 
     /**
      * @brief Comparator for string elements.
      * 
+     * Strings can also be compared as `string_view`s, in place, through the compareViews() and compareManyViews() hooks
+     * of Comparator. These are the entry points of the batch functions over StringColumn objects.
      */
     class StringComparator : public Comparator<string> {};
 
+    /**
+     * @brief Comparison value of an edit distance, given the sum `len` of the string lengths.
+     *
+     * The distance `dist` is normalized to `2 * dist / (len + dist)`. The similarity score is `(len - dist) / 2`, and 
+     * its normalization is 1 minus the normalized distance.
+     */
+    template<bool normalize, bool similarity>
+    inline double editScore(double dist, double len) {
+        if (similarity) {
+            double sim = (len - dist) / 2.0;
+            if (normalize) {
+                sim = sim / (len - sim);
+            }
+            return sim;
+        }
+        else {
+            if (normalize) {
+                dist = 2 * dist / (len + dist);
+            }
+            return dist;
+        }
+    }
+
+    /**
+     * @brief editScore() with runtime normalization and similarity options.
+     */
+    inline double editScore(double dist, double len, bool normalize, bool similarity) {
+        if (similarity) {
+            return normalize ? editScore<true, true>(dist, len) : editScore<false, true>(dist, len);
+        }
+        else {
+            return normalize ? editScore<true, false>(dist, len) : editScore<false, false>(dist, len);
+        }
+    }
+
+    /**
+     * @brief Largest edit distance whose editScore() beats a cutoff.
+     *
+     * This inverts editScore(): distances are compared with `<= cutoff` and similarities with `>= cutoff`.
+     *
+     * @return int Largest distance beating the cutoff (at most `len`), or -1 if no distance does.
+     */
+    inline int maxEditDistance(double cutoff, int len, bool normalize, bool similarity) {
+        double max_dist;
+        if (similarity) {
+            if (normalize) {
+                max_dist = (cutoff <= 0) ? len : len * (1 - cutoff) / (1 + cutoff);
+            }
+            else {
+                max_dist = len - 2 * cutoff;
+            }
+        }
+        else {
+            if (normalize) {
+                max_dist = (cutoff >= 1) ? len : len * cutoff / (2 - cutoff);
+            }
+            else {
+                max_dist = cutoff;
+            }
+        }
+
+        // Rounding errors may only let through distances which are then rejected by the exact score.
+        max_dist = floor(max_dist + 1e-9 * (len + 1));
+        if (max_dist < 0) {
+            return -1;
+        }
+
+        return (int)min(max_dist, (double)len);
+    }
+
     /**
      * @brief Comparator for numeric values.
      * 
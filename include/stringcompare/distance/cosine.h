@@ -0,0 +1,54 @@
+/**
+ * @file cosine.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Compute cosine (Ochiai) distance between token sets [<a href="https://en.wikipedia.org/wiki/Cosine_similarity#Otsuka%E2%80%93Ochiai_coefficient">Wikipedia link</a>]
+ * @date 2022-04-24
+ * 
+ */
+
+#ifndef STRINGCOMPARE_DISTANCE_COSINE_HPP_INCLUDED
+#define STRINGCOMPARE_DISTANCE_COSINE_HPP_INCLUDED
+
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include "tokencomparator.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Cosine distance between tokenized strings.
+     * 
+     */
+    class Cosine : public TokenComparator {
+    public:
+
+        /**
+         * @brief Construct a new Cosine object.
+         * 
+         * The similarity score is the Otsuka-Ochiai coefficient `|A ∩ B| / sqrt(|A| |B|)`, which is the cosine similarity of 
+         * the token sets' indicator vectors. The distance is 1 minus the similarity.
+         * 
+         * @param tokenizer Tokenizer object, such as WhitespaceTokenizer or NGramTokenizer.
+         * @param similarity Whether to return a similarity score rather than a distance. Defaults to false.
+         */
+        template<class T>
+        explicit Cosine(const T& tokenizer, bool similarity = false) :
+            TokenComparator(tokenizer, similarity) {}
+
+        double score(double intersection, double size_s, double size_t_) const {
+            if (size_s == 0 || size_t_ == 0) {
+                return (size_s == size_t_) ? 1.0 : 0.0;
+            }
+
+            return intersection / sqrt(size_s * size_t_);
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_DISTANCE_COSINE_HPP_INCLUDED
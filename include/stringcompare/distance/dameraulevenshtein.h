@@ -9,10 +9,13 @@
 #ifndef STRINGCOMPARE_DISTANCE_DAMERAULEVENSHTEIN_HPP_INCLUDED
 #define STRINGCOMPARE_DISTANCE_DAMERAULEVENSHTEIN_HPP_INCLUDED
 
+#include <limits.h>
 #include <algorithm>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "bitparallel.h"
 #include "comparator.h"
 
 using namespace std;
@@ -34,7 +37,7 @@ namespace stringcompare {
         bool normalize;
         bool similarity;
         int dmat_size;
-        Mat<int> dmat;
+        bool unrestricted;
 
         /**
          * @brief Construct a new DamerauLevenshtein object.
@@ -51,73 +54,529 @@ namespace stringcompare {
          * @param similarity Whether to return a similarity score rather than a distance. Defaults to false.
          * @param dmat_size Default starting string buffer size. If the maximum string length `s_max` is known in advance, 
          * this can be set to `s_max + 1` to improve efficiency.
+         * @param unrestricted Whether to compute the unrestricted Damerau-Levenshtein distance, where transposed characters
+         * may be edited further, rather than the optimal string alignment distance. Defaults to false.
          */
-        DamerauLevenshtein(bool normalize = true, bool similarity = false, int dmat_size = 100) :
+        DamerauLevenshtein(bool normalize = true, bool similarity = false, int dmat_size = 100, bool unrestricted = false) :
             normalize(normalize),
             similarity(similarity),
             dmat_size(dmat_size),
-            dmat(Mat<int>(3, vector<int>(dmat_size))) {}
+            unrestricted(unrestricted) {
+            reserve(dmat_size);
+        }
+
+        /**
+         * @brief Scratch space of the calling thread.
+         */
+        struct Workspace {
+            PatternMatchVector pm;
+            BlockPatternMatchVector block_pm;
+
+            /**
+             * @brief Dynamic programming matrix of unrestrictedDamerauLevenshtein().
+             */
+            vector<int> dmat;
+
+            /**
+             * @brief Last row of each character in unrestrictedDamerauLevenshtein(), left zeroed between uses.
+             */
+            int last_row[256] = {};
+            unordered_map<uint32_t, int> ext_last_row;
+        };
 
+        static Workspace& workspace() {
+            static thread_local Workspace ws;
+            return ws;
+        }
 
         /**
-         * @brief raw Damerau-Levenshtein distance.
+         * @brief Grow the scratch space of the calling thread to hold strings of at least `size` characters.
          */
-        int dameraulevenshtein(const string& s, const string& t) {
-            int m = s.size();
+        static void reserve(int size) {
+            workspace().block_pm.reserve(size);
+        }
+
+        /**
+         * @brief Raw optimal string alignment distance, where no substring is edited more than once.
+         * 
+         * This is the Damerau-Levenshtein distance as it is most commonly implemented. The shortest string is used as the 
+         * pattern of a bit-parallel kernel: osa() when it fits in a 64 bits word, and osaBlock() otherwise.
+         * 
+         * @param max_dist Largest distance of interest. Distances above it are reported as `max_dist + 1`, which allows 
+         * the computation to stop early.
+         */
+        template<class Sequence>
+        static int dameraulevenshtein(const Sequence& s, const Sequence& t, int max_dist = INT_MAX) {
+            const Sequence& a = (s.size() <= t.size()) ? s : t;
+            const Sequence& b = (s.size() <= t.size()) ? t : s;
+            int m = a.size();
+            int n = b.size();
+
+            max_dist = min(max_dist, n);
+            if (n - m > max_dist) {
+                return max_dist + 1;
+            }
+            if (m == 0) {
+                return n;
+            }
+            if (max_dist == 0) {
+                return (a == b) ? 0 : 1;
+            }
+
+            Workspace& ws = workspace();
+            int dist;
+            if (m <= 64) {
+                ws.pm.insert(a);
+                dist = osa(ws.pm, m, b, max_dist);
+                ws.pm.clear(a);
+            }
+            else {
+                ws.block_pm.insert(a);
+                dist = osaBlock(ws.block_pm, m, b, max_dist);
+                ws.block_pm.clear(a);
+            }
+
+            return dist;
+        }
+
+        /**
+         * @brief Optimal string alignment distance between a pattern of length 1 <= m <= 64 and a string t.
+         * 
+         * Bit-parallel algorithm of Hyyrö (2003), which extends the algorithm of Myers (1999) (see Levenshtein::myers()) 
+         * with the transpositions `TR` of the diagonal deltas. A transposition of the characters at rows i - 1 and i is 
+         * possible in column j when the pattern matches t[j] at row i - 1 and t[j - 1] at row i, and the diagonal did not 
+         * already decrease at row i - 1 in column j - 1.
+         * 
+         * @param PM Pattern match vector of the pattern.
+         * @param m Length of the pattern.
+         * @param t String to compare to.
+         * @param max_dist Largest distance of interest. Distances above it are reported as `max_dist + 1`.
+         */
+        template<class Sequence>
+        static int osa(const PatternMatchVector& PM, int m, const Sequence& t, int max_dist = INT_MAX) {
             int n = t.size();
+            uint64_t VP = (m == 64) ? ~uint64_t(0) : (uint64_t(1) << m) - 1;
+            uint64_t VN = 0;
+            uint64_t D0 = 0;
+            uint64_t PM_prev = 0;
+            uint64_t last = uint64_t(1) << (m - 1);
+            int dist = m;
+
+            // The final distance is at least the current one minus the number of remaining columns.
+            int64_t break_dist = (int64_t)max_dist + n;
+
+            for (int j = 0; j < n; j++) {
+                uint64_t PM_j = PM.get(t[j]);
+                uint64_t TR = (((~D0) & PM_j) << 1) & PM_prev;
+                uint64_t X = PM_j | VN;
+                D0 = (((X & VP) + VP) ^ VP) | X | TR;
+                uint64_t HP = VN | ~(D0 | VP);
+                uint64_t HN = D0 & VP;
+
+                dist += (HP & last) != 0;
+                dist -= (HN & last) != 0;
+
+                break_dist--;
+                if (dist > break_dist) {
+                    return max_dist + 1;
+                }
+
+                HP = (HP << 1) | 1;
+                HN = HN << 1;
+                VP = HN | ~(D0 | HP);
+                VN = HP & D0;
+                PM_prev = PM_j;
+            }
+
+            return (dist <= max_dist) ? dist : max_dist + 1;
+        }
+
+        /**
+         * @brief Optimal string alignment distance between a pattern of length m >= 1 and a string t.
+         * 
+         * Multi-word version of osa(). Horizontal deltas are carried from one 64 bits block to the next as in 
+         * Levenshtein::myersBlock(), and so are the transpositions crossing a block boundary.
+         * 
+         * @param PM Block pattern match vector of the pattern.
+         * @param m Length of the pattern.
+         * @param t String to compare to.
+         * @param max_dist Largest distance of interest. Distances above it are reported as `max_dist + 1`.
+         */
+        template<class Sequence>
+        static int osaBlock(const BlockPatternMatchVector& PM, int m, const Sequence& t, int max_dist = INT_MAX) {
+            int n = t.size();
+            int words = PM.words;
+            max_dist = min(max_dist, max(m, n));
+            if (abs(m - n) > max_dist) {
+                return max_dist + 1;
+            }
+
+            vector<uint64_t> VP(words, ~uint64_t(0));
+            vector<uint64_t> VN(words, 0);
+            vector<uint64_t> D0(words, 0);
+            vector<uint64_t> PM_prev(words, 0);
+            uint64_t last = uint64_t(1) << ((m - 1) % 64);
+            int dist = m;
+
+            for (int j = 0; j < n; j++) {
+                uint64_t HP_carry = 1;
+                uint64_t HN_carry = 0;
+                // Previous column D0 and current column PM of the block below, for transpositions across blocks.
+                uint64_t D0_below = 0;
+                uint64_t PM_below = 0;
 
-            dmat[0].reserve(m+1);
-            dmat[1].reserve(m+1);
-            dmat[2].reserve(m+1);
+                for (int w = 0; w < words; w++) {
+                    uint64_t PM_j = PM.get(w, t[j]);
+                    uint64_t TR = ((((~D0[w]) & PM_j) << 1) | (((~D0_below) & PM_below) >> 63)) & PM_prev[w];
+                    uint64_t X = PM_j | HN_carry;
+                    uint64_t D = (((X & VP[w]) + VP[w]) ^ VP[w]) | X | VN[w] | TR;
+                    uint64_t HP = VN[w] | ~(D | VP[w]);
+                    uint64_t HN = D & VP[w];
 
-            for (int i = 0; i < dmat_size; i++) {
-                dmat[0][i] = i;
+                    if (w == words - 1) {
+                        dist += (HP & last) != 0;
+                        dist -= (HN & last) != 0;
+                    }
+
+                    uint64_t HP_carry_in = HP_carry;
+                    uint64_t HN_carry_in = HN_carry;
+                    HP_carry = HP >> 63;
+                    HN_carry = HN >> 63;
+                    HP = (HP << 1) | HP_carry_in;
+                    HN = (HN << 1) | HN_carry_in;
+
+                    VP[w] = HN | ~(D | HP);
+                    VN[w] = HP & D;
+                    D0_below = D0[w];
+                    PM_below = PM_j;
+                    D0[w] = D;
+                    PM_prev[w] = PM_j;
+                }
+
+                if (dist - (n - j - 1) > max_dist) {
+                    return max_dist + 1;
+                }
+            }
+
+            return (dist <= max_dist) ? dist : max_dist + 1;
+        }
+
+        /**
+         * @brief Raw unrestricted Damerau-Levenshtein distance.
+         * 
+         * Unlike the optimal string alignment distance, characters may be inserted between transposed characters, so 
+         * that "ca" and "abc" are at distance 2 rather than 3. This distance is a metric.
+         * 
+         * Algorithm of Lowrance and Wagner (1975), in O(|s||t|) time and space with the last row of each character held 
+         * in a table of the calling thread. It is meant for short strings, such as names and identifiers. The computation 
+         * stops as soon as a row has no cell of value at most `max_dist`, since row minima never decrease.
+         * 
+         * @param max_dist Largest distance of interest. Distances above it are reported as `max_dist + 1`.
+         */
+        template<class Sequence>
+        static int unrestrictedDamerauLevenshtein(const Sequence& s, const Sequence& t, int max_dist = INT_MAX) {
+            int m = s.size();
+            int n = t.size();
+
+            max_dist = min(max_dist, max(m, n));
+            if (abs(m - n) > max_dist) {
+                return max_dist + 1;
             }
+            if (m == 0 || n == 0) {
+                return max(m, n);
+            }
+
+            Workspace& ws = workspace();
+            int inf = m + n;
+            int cols = n + 2;
+            ws.dmat.resize((size_t)(m + 2) * cols);
+            // Cell (i, j) of the matrix, for -1 <= i <= m and -1 <= j <= n.
+            auto d = [&](int i, int j) -> int& {
+                return ws.dmat[(size_t)(i + 1) * cols + (j + 1)];
+            };
+            auto lastRow = [&](uint32_t c) -> int& {
+                return (c < 256) ? ws.last_row[c] : ws.ext_last_row[c];
+            };
 
-            int cost;
+            d(-1, -1) = inf;
+            for (int i = 0; i <= m; i++) {
+                d(i, -1) = inf;
+                d(i, 0) = i;
+            }
             for (int j = 1; j <= n; j++) {
-                dmat[(j - 1) % 3][0] = j - 1;
-                dmat[j % 3][0] = j;
-                for (int i = 1; i <= m; i++) {
-                    cost = 0;
-                    if (s[i - 1] != t[j - 1]) {
-                        cost = 1;
+                d(-1, j) = inf;
+                d(0, j) = j;
+            }
+
+            int result = -1;
+            for (int i = 1; i <= m; i++) {
+                // Last column of the current row where s[i - 1] matched.
+                int last_col = 0;
+                int row_min = i;
+                for (int j = 1; j <= n; j++) {
+                    int k = lastRow(charCode(t[j - 1]));
+                    int l = last_col;
+                    int cost = 1;
+                    if (s[i - 1] == t[j - 1]) {
+                        cost = 0;
+                        last_col = j;
                     }
-                    dmat[j % 3][i] = min({ dmat[j % 3][i - 1] + 1, dmat[(j - 1) % 3][i] +
-                                            1, dmat[(j - 1) % 3][i - 1] + cost });
-                    if ((i > 1) & (j > 1) & (s[i - 1] == t[j - 2]) & (s[i - 2] == t[j - 1])) {
-                        dmat[j % 3][i] = std::min({ dmat[j % 3][i], dmat[(j - 2) % 3][i - 2] + 1 });
+                    int dist = min({ d(i - 1, j - 1) + cost, d(i, j - 1) + 1, d(i - 1, j) + 1 });
+                    if (k > 0 && l > 0) {
+                        dist = min(dist, d(k - 1, l - 1) + (i - k - 1) + 1 + (j - l - 1));
                     }
+                    d(i, j) = dist;
+                    row_min = min(row_min, dist);
                 }
+                lastRow(charCode(s[i - 1])) = i;
+
+                if (row_min > max_dist) {
+                    result = max_dist + 1;
+                    break;
+                }
+            }
+            if (result < 0) {
+                result = min(d(m, n), max_dist + 1);
+            }
+
+            for (int i = 0; i < m; i++) {
+                uint32_t c = charCode(s[i]);
+                if (c < 256) {
+                    ws.last_row[c] = 0;
+                }
+            }
+            ws.ext_last_row.clear();
+
+            return result;
+        }
+
+        /**
+         * @brief Raw distance of this comparator: unrestrictedDamerauLevenshtein() if `unrestricted` is set, and 
+         * dameraulevenshtein() otherwise.
+         */
+        template<class Sequence>
+        int distance(const Sequence& s, const Sequence& t, int max_dist = INT_MAX) const {
+            if (unrestricted) {
+                return unrestrictedDamerauLevenshtein(s, t, max_dist);
             }
 
-            return dmat[n % 3][m];
+            return dameraulevenshtein(s, t, max_dist);
         }
 
-        double compare(const string& s, const string& t) {
+        bool isSimilarity() const {
+            return similarity;
+        }
+
+        /**
+         * @brief Comparison of any sequences of characters, such as `string_view`, `u32string` or vectors of code points.
+         */
+        template<class Sequence>
+        double compareSequences(const Sequence& s, const Sequence& t) const {
             int len = s.size() + t.size();
             if (len == 0) {
                 return similarity;
             }
 
-            double dist = dameraulevenshtein(s, t);
+            return editScore(distance(s, t), len, normalize, similarity);
+        }
 
-            if (similarity) {
-                double sim = (len - dist) / 2.0;
-                if (normalize) {
-                    sim = sim / (len - sim);
-                }
-                return sim;
+        double compare(const string& s, const string& t) const {
+            return compareSequences(s, t);
+        }
+
+        double compareViews(string_view s, string_view t) const {
+            return compareSequences(s, t);
+        }
+
+        /**
+         * @brief Comparison with a score cutoff.
+         * 
+         * The cutoff is converted to a largest distance of interest, which allows the computation to stop early. 
+         * Comparisons which cannot beat the cutoff return the score of the maximal distance `|s| + |t|`.
+         */
+        template<class Sequence>
+        double compareSequences(const Sequence& s, const Sequence& t, double cutoff) const {
+            int len = s.size() + t.size();
+            if (len == 0) {
+                return similarity;
+            }
+
+            int max_dist = maxEditDistance(cutoff, len, normalize, similarity);
+            if (max_dist < 0) {
+                return editScore(len, len, normalize, similarity);
+            }
+
+            int dist = distance(s, t, max_dist);
+            if (dist > max_dist) {
+                return editScore(len, len, normalize, similarity);
+            }
+
+            return editScore(dist, len, normalize, similarity);
+        }
+
+        double compare(const string& s, const string& t, double cutoff) const {
+            return compareSequences(s, t, cutoff);
+        }
+
+        double compareViews(string_view s, string_view t, double cutoff) const {
+            return compareSequences(s, t, cutoff);
+        }
+
+        class Cached;
+
+        /**
+         * @brief Prepare one-to-many comparisons from a fixed first string.
+         */
+        Cached prepare(const string& s) const;
+    };
+
+    /**
+     * @brief DamerauLevenshtein comparator with a fixed first string.
+     * 
+     * For the optimal string alignment distance, the pattern match vectors of the first string are computed once, so 
+     * that comparisons only scan the second string. The unrestricted distance has no pattern to precompute, and is 
+     * computed by DamerauLevenshtein::distance() on each call.
+     */
+    class DamerauLevenshtein::Cached : public CachedComparator<string> {
+    public:
+
+        DamerauLevenshtein comparator;
+        string s;
+        PatternMatchVector pm;
+        BlockPatternMatchVector block_pm;
+
+        Cached(const string& s, bool normalize = true, bool similarity = false, int dmat_size = 100, bool unrestricted = false) :
+            comparator(normalize, similarity, dmat_size, unrestricted),
+            s(s) {
+            if (unrestricted) {
+                return;
+            }
+            if (s.size() <= 64) {
+                pm.insert(s);
             }
             else {
-                if (normalize) {
-                    dist = 2 * dist / (len + dist);
-                }
-                return dist;
+                block_pm.insert(s);
+            }
+        }
+
+        /**
+         * @brief Raw Damerau-Levenshtein distance to `t`. See DamerauLevenshtein::distance().
+         */
+        int dameraulevenshtein(const string& t, int max_dist = INT_MAX) const {
+            if (comparator.unrestricted) {
+                return comparator.distance(s, t, max_dist);
+            }
+
+            int m = s.size();
+            int n = t.size();
+
+            max_dist = min(max_dist, max(m, n));
+            if (abs(m - n) > max_dist) {
+                return max_dist + 1;
+            }
+            if (m == 0) {
+                return n;
+            }
+            if (max_dist == 0) {
+                return (s == t) ? 0 : 1;
+            }
+
+            if (m <= 64) {
+                return osa(pm, m, t, max_dist);
+            }
+            else {
+                return osaBlock(block_pm, m, t, max_dist);
+            }
+        }
+
+        bool isSimilarity() const {
+            return comparator.similarity;
+        }
+
+        double compare(const string& t) const {
+            double len = s.size() + t.size();
+
+            if (len == 0) {
+                return comparator.similarity;
+            }
+
+            return editScore(dameraulevenshtein(t), len, comparator.normalize, comparator.similarity);
+        }
+
+        double compare(const string& t, double cutoff) const {
+            int len = s.size() + t.size();
+            bool normalize = comparator.normalize;
+            bool similarity = comparator.similarity;
+
+            if (len == 0) {
+                return similarity;
+            }
+
+            int max_dist = maxEditDistance(cutoff, len, normalize, similarity);
+            if (max_dist < 0) {
+                return editScore(len, len, normalize, similarity);
             }
+
+            int dist = dameraulevenshtein(t, max_dist);
+            if (dist > max_dist) {
+                return editScore(len, len, normalize, similarity);
+            }
+
+            return editScore(dist, len, normalize, similarity);
         }
     };
 
+    inline DamerauLevenshtein::Cached DamerauLevenshtein::prepare(const string& s) const {
+        return Cached(s, normalize, similarity, dmat_size, unrestricted);
+    }
+
+
+    /**
+     * @brief DamerauLevenshtein comparator with compile-time normalization and similarity options. See DamerauLevenshtein.
+     */
+    template<bool normalize = true, bool similarity = false>
+    class StaticDamerauLevenshtein : public StaticComparator<StaticDamerauLevenshtein<normalize, similarity>, string> {
+    public:
+
+        static bool isSimilarity() {
+            return similarity;
+        }
+
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t) const {
+            double len = s.size() + t.size();
+            if (len == 0) {
+                return similarity;
+            }
+
+            return editScore<normalize, similarity>(DamerauLevenshtein::dameraulevenshtein(s, t), len);
+        }
+
+        /**
+         * @brief Comparison with a score cutoff. See DamerauLevenshtein::compareSequences().
+         */
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t, double cutoff) const {
+            int len = s.size() + t.size();
+            if (len == 0) {
+                return similarity;
+            }
+
+            int max_dist = maxEditDistance(cutoff, len, normalize, similarity);
+            if (max_dist < 0) {
+                return editScore<normalize, similarity>(len, len);
+            }
+
+            int dist = DamerauLevenshtein::dameraulevenshtein(s, t, max_dist);
+            if (dist > max_dist) {
+                return editScore<normalize, similarity>(len, len);
+            }
+
+            return editScore<normalize, similarity>(dist, len);
+        }
+
+    };
+
 }
 
 #endif // STRINGCOMPARE_DISTANCE_DAMERAULEVENSHTEIN_HPP_INCLUDED
\ No newline at end of file
@@ -0,0 +1,52 @@
+/**
+ * @file dice.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Compute Sørensen-Dice distance between token sets [<a href="https://en.wikipedia.org/wiki/S%C3%B8rensen%E2%80%93Dice_coefficient">Wikipedia link</a>]
+ * @date 2022-04-24
+ * 
+ */
+
+#ifndef STRINGCOMPARE_DISTANCE_DICE_HPP_INCLUDED
+#define STRINGCOMPARE_DISTANCE_DICE_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "tokencomparator.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Sørensen-Dice distance between tokenized strings.
+     * 
+     */
+    class Dice : public TokenComparator {
+    public:
+
+        /**
+         * @brief Construct a new Dice object.
+         * 
+         * The similarity score is `2 |A ∩ B| / (|A| + |B|)`, and the distance is 1 minus the similarity.
+         * 
+         * @param tokenizer Tokenizer object, such as WhitespaceTokenizer or NGramTokenizer.
+         * @param similarity Whether to return a similarity score rather than a distance. Defaults to false.
+         */
+        template<class T>
+        explicit Dice(const T& tokenizer, bool similarity = false) :
+            TokenComparator(tokenizer, similarity) {}
+
+        double score(double intersection, double size_s, double size_t_) const {
+            if (size_s + size_t_ == 0) {
+                return 1.0;
+            }
+
+            return 2.0 * intersection / (size_s + size_t_);
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_DISTANCE_DICE_HPP_INCLUDED
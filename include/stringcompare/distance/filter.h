@@ -0,0 +1,412 @@
+/**
+ * @file filter.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Lower bound filters rejecting pairs of strings which cannot beat a score cutoff.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_DISTANCE_FILTER_HPP_INCLUDED
+#define STRINGCOMPARE_DISTANCE_FILTER_HPP_INCLUDED
+
+#include <stdint.h>
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "comparator.h"
+#include "dameraulevenshtein.h"
+#include "jaro.h"
+#include "jarowinkler.h"
+#include "lcs.h"
+#include "levenshtein.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Number of bins of the character histograms of FilterProfile objects.
+     */
+    const size_t FILTER_BINS = 64;
+
+    /**
+     * @brief Metadata of a string used by the stages of a FilterCascade.
+     *
+     * The histogram counts bytes by their value modulo FILTER_BINS. Merging characters into bins can only increase the
+     * number of characters two histograms have in common, so that bounds derived from it remain valid.
+     */
+    struct FilterProfile {
+        size_t length;
+        char prefix[4];
+        uint16_t histogram[FILTER_BINS];
+
+        explicit FilterProfile(string_view s = string_view()) :
+            length(s.size()),
+            prefix(),
+            histogram() {
+            for (size_t i = 0; i < min(size_t(4), s.size()); i++) {
+                prefix[i] = s[i];
+            }
+            // Longer strings could overflow their bins, and only use the length stage.
+            if (s.size() <= UINT16_MAX) {
+                for (unsigned char c : s) {
+                    histogram[c % FILTER_BINS]++;
+                }
+            }
+        }
+
+        /**
+         * @brief Upper bound on the number of characters in common with another string, from the histograms.
+         */
+        size_t commonCharacters(const FilterProfile& other) const {
+            if (length > UINT16_MAX || other.length > UINT16_MAX) {
+                return min(length, other.length);
+            }
+
+            size_t common = 0;
+            for (size_t k = 0; k < FILTER_BINS; k++) {
+                common += min(histogram[k], other.histogram[k]);
+            }
+
+            return common;
+        }
+
+        /**
+         * @brief Length of the common prefix with another string, up to 4 characters.
+         */
+        int commonPrefix(const FilterProfile& other) const {
+            int bound = min(size_t(4), min(length, other.length));
+            int ell = 0;
+            while (ell < bound && prefix[ell] == other.prefix[ell]) {
+                ell++;
+            }
+
+            return ell;
+        }
+    };
+
+    /**
+     * @brief Stages of a FilterCascade, from cheapest to most selective.
+     *
+     * - `LENGTH_FILTER` bounds comparisons from the string lengths only, in O(1).
+     * - `HISTOGRAM_FILTER` bounds comparisons from the number of characters in common, in O(FILTER_BINS).
+     */
+    enum FilterStage {
+        LENGTH_FILTER,
+        HISTOGRAM_FILTER
+    };
+
+    /**
+     * @brief Pruning statistics of a FilterCascade.
+     */
+    struct FilterStats {
+        /**
+         * @brief Number of pairs considered.
+         */
+        size_t pairs = 0;
+
+        /**
+         * @brief Number of pairs rejected by each stage, in the order of FilterCascade::stages.
+         */
+        vector<size_t> pruned;
+
+        /**
+         * @brief Number of pairs which went through all stages and were compared.
+         */
+        size_t compared = 0;
+    };
+
+    /**
+     * @brief Bounds of the comparators supported by FilterCascade.
+     *
+     * Specializations define `reject(comparator, s, t, stage, cutoff)`, which is true only for pairs whose comparison
+     * value cannot beat `cutoff`, and `rejected(comparator, s, t)`, the value returned for such pairs by the comparator's
+     * own `compare(s, t, cutoff)`.
+     */
+    template<class C>
+    struct FilterBounds;
+
+    /**
+     * @brief Bounds shared by edit distances, from a lower bound on the raw distance.
+     */
+    template<class C>
+    struct EditFilterBounds {
+        static bool reject(const C& comparator, const FilterProfile& s, const FilterProfile& t, FilterStage stage, double cutoff) {
+            int len = s.length + t.length;
+            if (len == 0) {
+                return false;
+            }
+
+            return FilterBounds<C>::distanceBound(s, t, stage) > maxEditDistance(cutoff, len, comparator.normalize, comparator.similarity);
+        }
+
+        static double rejected(const C& comparator, const FilterProfile& s, const FilterProfile& t) {
+            int len = s.length + t.length;
+            return editScore(len, len, comparator.normalize, comparator.similarity);
+        }
+    };
+
+    /**
+     * @brief Levenshtein bounds.
+     *
+     * Each edit operation removes at most one character of `s` which is not matched in `t`, so that the distance is at
+     * least `max(|s|, |t|) - common`, where `common` is the number of characters in common. With `common <= min(|s|, |t|)`,
+     * this is at least the length difference.
+     */
+    template<>
+    struct FilterBounds<Levenshtein> : EditFilterBounds<Levenshtein> {
+        static int distanceBound(const FilterProfile& s, const FilterProfile& t, FilterStage stage) {
+            size_t common = (stage == LENGTH_FILTER) ? min(s.length, t.length) : s.commonCharacters(t);
+            return max(s.length, t.length) - common;
+        }
+    };
+
+    /**
+     * @brief Damerau-Levenshtein bounds. Transpositions do not change character counts, so that the Levenshtein bounds
+     * hold.
+     */
+    template<>
+    struct FilterBounds<DamerauLevenshtein> : EditFilterBounds<DamerauLevenshtein> {
+        static int distanceBound(const FilterProfile& s, const FilterProfile& t, FilterStage stage) {
+            return FilterBounds<Levenshtein>::distanceBound(s, t, stage);
+        }
+    };
+
+    /**
+     * @brief LCS distance bounds. The longest common subsequence has at most `common` characters, so that the distance
+     * `|s| + |t| - 2 lcs` is at least `|s| + |t| - 2 common`.
+     */
+    template<>
+    struct FilterBounds<LCSDistance> : EditFilterBounds<LCSDistance> {
+        static int distanceBound(const FilterProfile& s, const FilterProfile& t, FilterStage stage) {
+            size_t common = (stage == LENGTH_FILTER) ? min(s.length, t.length) : s.commonCharacters(t);
+            return s.length + t.length - 2 * common;
+        }
+    };
+
+    /**
+     * @brief Jaro bounds. The number of matching characters is at most `common`, and the Jaro similarity is at most its
+     * value with that many matches and no transposition.
+     */
+    template<>
+    struct FilterBounds<Jaro> {
+        static double similarityBound(const FilterProfile& s, const FilterProfile& t, FilterStage stage) {
+            if (s.length + t.length == 0) {
+                return 1.0;
+            }
+            if (s.length == 0 || t.length == 0) {
+                return 0.0;
+            }
+            size_t common = (stage == LENGTH_FILTER) ? min(s.length, t.length) : s.commonCharacters(t);
+
+            return Jaro::jaroScore(common, 0, s.length, t.length);
+        }
+
+        static bool reject(const Jaro& comparator, const FilterProfile& s, const FilterProfile& t, FilterStage stage, double cutoff) {
+            return similarityBound(s, t, stage) < (comparator.similarity ? cutoff : 1.0 - cutoff);
+        }
+
+        static double rejected(const Jaro& comparator, const FilterProfile&, const FilterProfile&) {
+            return comparator.similarity ? 0.0 : 1.0;
+        }
+    };
+
+    /**
+     * @brief Jaro-Winkler bounds. The similarity increases with the Jaro similarity, and the common prefix is known from
+     * the profiles.
+     */
+    template<>
+    struct FilterBounds<JaroWinkler> {
+        static bool reject(const JaroWinkler& comparator, const FilterProfile& s, const FilterProfile& t, FilterStage stage, double cutoff) {
+            double sim = FilterBounds<Jaro>::similarityBound(s, t, stage);
+            sim = sim + s.commonPrefix(t) * 0.1 * (1 - sim);
+
+            return sim < (comparator.similarity ? cutoff : 1.0 - cutoff);
+        }
+
+        static double rejected(const JaroWinkler& comparator, const FilterProfile&, const FilterProfile&) {
+            return comparator.similarity ? 0.0 : 1.0;
+        }
+    };
+
+    /**
+     * @brief Comparisons with a score cutoff, preceded by a chain of cheap filters.
+     *
+     * Each pair of strings goes through the filter stages in order, which bound its comparison value from precomputed
+     * FilterProfile metadata. Pairs which cannot beat the cutoff are rejected without running the comparator, and get
+     * the same value as from the comparator's `compare(s, t, cutoff)`. Other pairs are compared with the cutoff.
+     *
+     * The batch functions compute the profiles of each list once, and optionally report how many pairs each stage
+     * pruned. Without a cutoff, all pairs are compared.
+     *
+     * @tparam C Levenshtein, DamerauLevenshtein, LCSDistance, Jaro or JaroWinkler.
+     */
+    template<class C>
+    class FilterCascade : public StringComparator {
+    public:
+
+        C comparator;
+        vector<FilterStage> stages;
+
+        explicit FilterCascade(const C& comparator = C(), const vector<FilterStage>& stages = { LENGTH_FILTER, HISTOGRAM_FILTER }) :
+            comparator(comparator),
+            stages(stages) {}
+
+        bool isSimilarity() const {
+            return comparator.isSimilarity();
+        }
+
+        double compare(const string& s, const string& t) const {
+            return comparator.compareSequences(s, t);
+        }
+
+        double compareViews(string_view s, string_view t) const {
+            return comparator.compareSequences(s, t);
+        }
+
+        double compare(const string& s, const string& t, double cutoff) const {
+            return filteredCompare(s, t, FilterProfile(s), FilterProfile(t), cutoff, nullptr);
+        }
+
+        double compareViews(string_view s, string_view t, double cutoff) const {
+            return filteredCompare(s, t, FilterProfile(s), FilterProfile(t), cutoff, nullptr);
+        }
+
+        /**
+         * @brief Profiles of a list of strings, or of a StringColumn.
+         */
+        template<class List>
+        static vector<FilterProfile> profiles(const List& l) {
+            vector<FilterProfile> result;
+            result.reserve(l.size());
+            for (size_t i = 0; i < l.size(); i++) {
+                result.emplace_back(l[i]);
+            }
+
+            return result;
+        }
+
+        using StringComparator::elementwise;
+        using StringComparator::pairwise;
+        using StringComparator::condensed;
+
+        /**
+         * @brief Elementwise comparisons with a score cutoff. See BatchComparator::elementwise().
+         *
+         * @param l1 List of strings, or StringColumn.
+         * @param l2 List of strings of the same type and size.
+         * @param cutoff Score cutoff.
+         * @param nthreads Number of threads. Values smaller than 1 use all hardware threads. Defaults to 1.
+         * @param stats Statistics to add the pruning counts to, if not null.
+         */
+        template<class List>
+        vector<double> elementwise(const List& l1, const List& l2, double cutoff, int nthreads = 1, FilterStats* stats = nullptr) const {
+            if (l1.size() != l2.size()) {
+                throw runtime_error("Lists should be of the same size.");
+            }
+
+            vector<double> result(l1.size());
+            size_t ntiles = (l1.size() + ELEMENTWISE_TILE - 1) / ELEMENTWISE_TILE;
+            parallelFor(ntiles, nthreads, [&](size_t tile) {
+                vector<size_t> counts(stages.size() + 1, 0);
+                size_t end = min(l1.size(), (tile + 1) * ELEMENTWISE_TILE);
+                for (size_t i = tile * ELEMENTWISE_TILE; i < end; i++) {
+                    result[i] = filteredCompare(l1[i], l2[i], FilterProfile(l1[i]), FilterProfile(l2[i]), cutoff, counts.data());
+                }
+                addStats(stats, counts);
+            });
+
+            return result;
+        }
+
+        /**
+         * @brief Pairwise comparisons with a score cutoff. See BatchComparator::pairwise().
+         */
+        template<class List>
+        Mat<double> pairwise(const List& l1, const List& l2, double cutoff, int nthreads = 1, FilterStats* stats = nullptr) const {
+            vector<FilterProfile> p1 = profiles(l1);
+            vector<FilterProfile> p2 = profiles(l2);
+            Mat<double> result(l1.size(), vector<double>(l2.size()));
+
+            forEachPair(l1.size(), l2.size(), false, nthreads, [&](size_t i, size_t j0, size_t j1) {
+                vector<size_t> counts(stages.size() + 1, 0);
+                for (size_t j = j0; j < j1; j++) {
+                    result[i][j] = filteredCompare(l1[i], l2[j], p1[i], p2[j], cutoff, counts.data());
+                }
+                addStats(stats, counts);
+            });
+
+            return result;
+        }
+
+        /**
+         * @brief Condensed pairwise comparisons with a score cutoff. See BatchComparator::condensed().
+         */
+        template<class List>
+        vector<double> condensed(const List& l, double cutoff, int nthreads = 1, FilterStats* stats = nullptr) const {
+            size_t n = l.size();
+            vector<FilterProfile> p = profiles(l);
+            vector<double> result(condensedSize(n));
+
+            forEachPair(n, n, true, nthreads, [&](size_t i, size_t j0, size_t j1) {
+                vector<size_t> counts(stages.size() + 1, 0);
+                double* out = &result[condensedIndex(n, i, j0)];
+                for (size_t j = j0; j < j1; j++) {
+                    out[j - j0] = filteredCompare(l[i], l[j], p[i], p[j], cutoff, counts.data());
+                }
+                addStats(stats, counts);
+            });
+
+            return result;
+        }
+
+    private:
+
+        /**
+         * @brief Filtered comparison of a pair, counting the stage which rejected it, or the comparison, in `counts`.
+         */
+        template<class Sequence>
+        double filteredCompare(const Sequence& s, const Sequence& t, const FilterProfile& ps, const FilterProfile& pt, double cutoff, size_t* counts) const {
+            for (size_t k = 0; k < stages.size(); k++) {
+                if (FilterBounds<C>::reject(comparator, ps, pt, stages[k], cutoff)) {
+                    if (counts != nullptr) {
+                        counts[k]++;
+                    }
+                    return FilterBounds<C>::rejected(comparator, ps, pt);
+                }
+            }
+            if (counts != nullptr) {
+                counts[stages.size()]++;
+            }
+
+            return comparator.compareSequences(s, t, cutoff);
+        }
+
+        /**
+         * @brief Add the counts of a unit of work to `stats`.
+         */
+        void addStats(FilterStats* stats, const vector<size_t>& counts) const {
+            if (stats == nullptr) {
+                return;
+            }
+
+            static mutex stats_lock;
+            lock_guard<mutex> guard(stats_lock);
+            stats->pruned.resize(stages.size(), 0);
+            for (size_t k = 0; k < stages.size(); k++) {
+                stats->pruned[k] += counts[k];
+                stats->pairs += counts[k];
+            }
+            stats->compared += counts[stages.size()];
+            stats->pairs += counts[stages.size()];
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_DISTANCE_FILTER_HPP_INCLUDED
@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "comparator.h"
+#include "../utils/cpu.h"
 
 using namespace std;
 
@@ -49,37 +50,231 @@ namespace stringcompare {
         /**
          * @brief Raw Hamming distance.
          */
-        static int hamming(const string& s, const string& t) {
+        template<class Sequence>
+        static int hamming(const Sequence& s, const Sequence& t) {
             int m = s.size();
             int n = t.size();
             int min_length = min(m, n);
 
             int distance = 0;
-            for (int i = 0; i < min_length; i++) {
-                distance += (s[i] != t[i]);
+            if constexpr (sizeof(typename Sequence::value_type) == 1) {
+                distance = mismatches((const char*)s.data(), (const char*)t.data(), min_length);
+            }
+            else {
+                for (int i = 0; i < min_length; i++) {
+                    distance += (s[i] != t[i]);
+                }
             }
             distance += max(m, n) - min_length;
 
             return distance;
         }
 
-        double compare(const string& s, const string& t) {
+        /**
+         * @brief Number of positions where two byte arrays of length `n` differ.
+         * 
+         * Runs the widest vectorized kernel supported by the CPU. See cpuLevel().
+         */
+        static int mismatches(const char* s, const char* t, int n) {
+            switch (cpuLevel()) {
+            case CPU_AVX512:
+                return mismatchesAvx512(s, t, n);
+            case CPU_AVX2:
+                return mismatchesAvx2(s, t, n);
+            case CPU_SSE42:
+                return mismatchesSse42(s, t, n);
+            default:
+                return mismatchesKernel(s, t, n);
+            }
+        }
+
+        bool isSimilarity() const {
+            return similarity;
+        }
+
+        using StringComparator::compare;
+        using StringComparator::compareViews;
+
+        /**
+         * @brief Comparison of any sequences of characters, such as `string_view`, `u32string` or vectors of code points.
+         */
+        template<class Sequence>
+        double compareSequences(const Sequence& s, const Sequence& t) const {
             double len = max(s.size(), t.size());
 
             if (len == 0) {
                 return similarity;
             }
 
-            double result = hamming(s, t);
+            return hammingScore(hamming(s, t), len);
+        }
+
+        double compare(const string& s, const string& t) const {
+            return compareSequences(s, t);
+        }
+
+        double compareViews(string_view s, string_view t) const {
+            return compareSequences(s, t);
+        }
+
+        /**
+         * @brief Comparisons of `s` with each of `count` strings, without a virtual call per comparison.
+         * 
+         * Interleaving strings across SIMD lanes, as in Levenshtein::myersBatch(), does not pay off for a kernel this 
+         * short: the scalar loop is already faster, as the `Hamming(interleaved)` cases of the benchmark suite show.
+         */
+        void compareMany(const string& s, const string* t, size_t count, double* out) const {
+            for (size_t i = 0; i < count; i++) {
+                double len = max(s.size(), t[i].size());
+                out[i] = (len == 0) ? similarity : hammingScore(hamming(s, t[i]), len);
+            }
+        }
+
+        void compareMany(const string& s, const string* t, size_t count, double* out, double /*cutoff*/) const {
+            compareMany(s, t, count, out);
+        }
+
+        void compareManyViews(string_view s, const string_view* t, size_t count, double* out) const {
+            for (size_t i = 0; i < count; i++) {
+                out[i] = compareSequences(s, t[i]);
+            }
+        }
+
+        void compareManyViews(string_view s, const string_view* t, size_t count, double* out, double /*cutoff*/) const {
+            compareManyViews(s, t, count, out);
+        }
 
+        /**
+         * @brief Comparison value of a Hamming distance, given the length `len` of the longest string.
+         */
+        template<bool normalize, bool similarity>
+        static double hammingScore(double dist, double len) {
             if (similarity) {
-                result = len - result;
+                dist = len - dist;
             }
             if (normalize) {
-                result = result / len;
+                dist = dist / len;
+            }
+
+            return dist;
+        }
+
+        /**
+         * @brief hammingScore() with the normalization and similarity options of this comparator.
+         */
+        double hammingScore(double dist, double len) const {
+            if (similarity) {
+                return normalize ? hammingScore<true, true>(dist, len) : hammingScore<false, true>(dist, len);
+            }
+            else {
+                return normalize ? hammingScore<true, false>(dist, len) : hammingScore<false, false>(dist, len);
+            }
+        }
+
+        class Cached;
+
+        /**
+         * @brief Prepare one-to-many comparisons from a fixed first string.
+         */
+        Cached prepare(const string& s) const;
+
+    private:
+
+        /**
+         * @brief mismatches() by blocks of 64 bytes, whose inner loop of fixed length compilers turn into a few vector
+         * compares and sums, followed by a scalar tail.
+         */
+        STRINGCOMPARE_ALWAYS_INLINE static int mismatchesKernel(const char* s, const char* t, int n) {
+            int distance = 0;
+            int i = 0;
+            for (; i + 64 <= n; i += 64) {
+                uint8_t block = 0;
+                for (int k = 0; k < 64; k++) {
+                    block += (s[i + k] != t[i + k]);
+                }
+                distance += block;
+            }
+            for (; i < n; i++) {
+                distance += (s[i] != t[i]);
+            }
+
+            return distance;
+        }
+
+        STRINGCOMPARE_TARGET_SSE42 static int mismatchesSse42(const char* s, const char* t, int n) {
+            return mismatchesKernel(s, t, n);
+        }
+
+        STRINGCOMPARE_TARGET_AVX2 static int mismatchesAvx2(const char* s, const char* t, int n) {
+            return mismatchesKernel(s, t, n);
+        }
+
+        STRINGCOMPARE_TARGET_AVX512 static int mismatchesAvx512(const char* s, const char* t, int n) {
+            return mismatchesKernel(s, t, n);
+        }
+
+    };
+
+    /**
+     * @brief Hamming comparator with a fixed first string.
+     */
+    class Hamming::Cached : public CachedComparator<string> {
+    public:
+
+        Hamming comparator;
+        string s;
+
+        Cached(const string& s, bool normalize = true, bool similarity = false) :
+            comparator(normalize, similarity),
+            s(s) {}
+
+        bool isSimilarity() const {
+            return comparator.similarity;
+        }
+
+        double compare(const string& t) const {
+            return comparator.compare(s, t);
+        }
+
+        double compare(const string& t, double cutoff) const {
+            return comparator.compare(s, t, cutoff);
+        }
+
+        void compareMany(const string* t, size_t count, double* out) const {
+            comparator.compareMany(s, t, count, out);
+        }
+
+        void compareMany(const string* t, size_t count, double* out, double /*cutoff*/) const {
+            comparator.compareMany(s, t, count, out);
+        }
+    };
+
+    inline Hamming::Cached Hamming::prepare(const string& s) const {
+        return Cached(s, normalize, similarity);
+    }
+
+
+    /**
+     * @brief Hamming comparator with compile-time normalization and similarity options. See Hamming.
+     */
+    template<bool normalize = true, bool similarity = false>
+    class StaticHamming : public StaticComparator<StaticHamming<normalize, similarity>, string> {
+    public:
+
+        static bool isSimilarity() {
+            return similarity;
+        }
+
+        using StaticComparator<StaticHamming, string>::compare;
+
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t) const {
+            double len = max(s.size(), t.size());
+            if (len == 0) {
+                return similarity;
             }
 
-            return result;
+            return Hamming::hammingScore<normalize, similarity>(Hamming::hamming(s, t), len);
         }
 
     };
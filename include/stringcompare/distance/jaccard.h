@@ -12,8 +12,7 @@
 #include <string>
 #include <vector>
 
-#include "comparator.h"
-#include "../preprocessing/tokenizer.h"
+#include "tokencomparator.h"
 
 using namespace std;
 
@@ -23,33 +22,52 @@ namespace stringcompare {
      * @brief Jaccard distance between tokenized strings.
      * 
      */
-    class Jaccard : public StringComparator {
+    class Jaccard : public TokenComparator {
     public:
 
-        Tokenizer tokenizer;
-        bool normalize;
-        bool similarity;
-
         /**
          * @brief Construct a new Jaccard object.
          * 
          * The Jaccard distance between token bags is 1 minus their percentage of overlap.
          * 
-         * The similarity score is the percentage of overlap.
+         * The similarity score is the percentage of overlap `|A ∩ B| / |A ∪ B|`.
          * 
-         * @param tokenizer Tokenizer object.
+         * @deprecated The `normalize` parameter does nothing and will be removed: Jaccard scores are always between 0
+         * and 1, whatever its value. It is only kept so that positional arguments of existing calls keep their meaning.
+         * Dice, Overlap and Cosine do not have it.
+         *
+         * @param tokenizer Tokenizer object, such as WhitespaceTokenizer or NGramTokenizer.
+         * @param normalize Deprecated and ignored.
          * @param similarity Whether to return a similarity score rather than a distance. Defaults to false.
          */
-        Jaccard(Tokenizer tokenizer, bool normalize = true, bool similarity = false) :
-            tokenizer(tokenizer),
-            similarity(similarity) {}
+        template<class T>
+        explicit Jaccard(const T& tokenizer, bool /*normalize*/ = true, bool similarity = false) :
+            TokenComparator(tokenizer, similarity) {}
+
+        /**
+         * @brief Jaccard similarity between two token multisets, given as StringCounter or IdCounter objects.
+         */
+        template<class Counter>
+        static double jaccard(const Counter& a, const Counter& b) {
+            double intersection = a.intersectionCount(b);
+            return jaccardScore(intersection, a.total(), b.total());
+        }
+
+        static double jaccardScore(double intersection, double size_s, double size_t_) {
+            double union_count = size_s + size_t_ - intersection;
+            if (union_count == 0) {
+                return 1.0;
+            }
+
+            return intersection / union_count;
+        }
 
-        double compare(const string& s, const string& t) {
-            return tokenizer(s).intersectionCount(tokenizer(t)) / tokenizer(s).unionCount(tokenizer(t));
+        double score(double intersection, double size_s, double size_t_) const {
+            return jaccardScore(intersection, size_s, size_t_);
         }
 
     };
 
 }
 
-#endif // STRINGCOMPARE_DISTANCE_JACCARD_HPP_INCLUDED
\ No newline at end of file
+#endif // STRINGCOMPARE_DISTANCE_JACCARD_HPP_INCLUDED
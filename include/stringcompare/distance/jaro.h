@@ -14,6 +14,7 @@
 #include <string>
 #include <vector>
 
+#include "bitparallel.h"
 #include "comparator.h"
 
 using namespace std;
@@ -37,54 +38,192 @@ namespace stringcompare {
         explicit Jaro(bool similarity = false) :
             similarity(similarity) {}
 
+        /**
+         * @brief Position bit-vectors used by jaroWord(), one per thread.
+         */
+        static PatternMatchVector& workspace() {
+            static thread_local PatternMatchVector pm;
+            return pm;
+        }
+
         /**
          * @brief Raw Jaro distance.
+         * 
+         * Characters of `s` are matched, in order, to the first unmatched equal character of `t` within the matching window. 
+         * Candidate positions are found with bit-vectors of the positions of each character in `t`, using a single 64 bits 
+         * word (and no heap allocation) when `t` has at most 64 characters, and blocks of 64 bits words otherwise.
+         * 
+         * @param score_cutoff Smallest similarity of interest. Similarities below it are reported as 0. The computation 
+         * stops as soon as the maximal achievable similarity, given the string lengths and then the number of matches, 
+         * falls below it.
          */
-        static double jaro(const string& s, const string& t) {
+        template<class Sequence>
+        static double jaro(const Sequence& s, const Sequence& t, double score_cutoff = 0) {
             auto ssize = s.size();
             auto tsize = t.size();
             if (ssize + tsize == 0) {
                 return 1.0;
             }
+            if (ssize == 0 || tsize == 0) {
+                return 0.0;
+            }
+            if (jaroScore(min(ssize, tsize), 0, ssize, tsize) < score_cutoff) {
+                return 0.0;
+            }
             int window = max(1.0, floor(max(ssize, tsize) / 2.0) - 1);
 
-            double m = 0;
-            vector<bool> found_s = vector<bool>(ssize, false);
-            vector<bool> found_t = vector<bool>(tsize, false);
+            if (tsize <= 64) {
+                return jaroWord(s, t, window - 1, score_cutoff);
+            }
+            else {
+                return jaroBlock(s, t, window - 1, score_cutoff);
+            }
+        }
 
-            for (size_t i = 0; i < ssize; i++) {
-                for (size_t j = 0; j < tsize; j++) {
-                    if (!found_t[j] && (s[i] == t[j]) && (abs(int(i) - int(j)) < window)) {
-                        m += 1;
-                        found_s[i] = true;
-                        found_t[j] = true;
-                        break;
-                    }
+        /**
+         * @brief Jaro similarity from the number of matches and of (half-)transpositions.
+         */
+        static double jaroScore(double m, double transpositions, size_t ssize, size_t tsize) {
+            if (m == 0) {
+                return 0.0;
+            }
+
+            return (m / ssize + m / tsize + (m - transpositions / 2.0) / m) / 3.0;
+        }
+
+        /**
+         * @brief Jaro similarity for strings `t` of length at most 64.
+         * 
+         * @param bound Maximum distance between the positions of matching characters.
+         * @param score_cutoff Smallest similarity of interest. Similarities below it are reported as 0.
+         */
+        template<class Sequence>
+        static double jaroWord(const Sequence& s, const Sequence& t, int bound, double score_cutoff = 0) {
+            PatternMatchVector& PM = workspace();
+            PM.insert(t);
+            double sim = jaroWord(PM, s, t, bound, score_cutoff);
+            PM.clear(t);
+
+            return sim;
+        }
+
+        /**
+         * @brief Jaro similarity for strings `t` of length at most 64, given the position bit-vectors `PM` of `t`.
+         * 
+         */
+        template<class Sequence>
+        static double jaroWord(const PatternMatchVector& PM, const Sequence& s, const Sequence& t, int bound, double score_cutoff = 0) {
+            int ssize = s.size();
+            int tsize = t.size();
+
+            uint64_t found_t = 0;
+            uint32_t matched_s[64];
+            int m = 0;
+
+            int imax = min(ssize, tsize + bound);
+            for (int i = 0; i < imax; i++) {
+                int lo = max(0, i - bound);
+                int hi = min(tsize - 1, i + bound);
+                uint64_t window = ((hi == 63) ? ~uint64_t(0) : (uint64_t(1) << (hi + 1)) - 1) & ~((uint64_t(1) << lo) - 1);
+
+                uint64_t candidates = PM.get(s[i]) & ~found_t & window;
+                if (candidates) {
+                    found_t |= candidates & (~candidates + 1);
+                    matched_s[m] = charCode(s[i]);
+                    m += 1;
                 }
             }
 
-            if (m == 0) {
+            if (jaroScore(m, 0, ssize, tsize) < score_cutoff) {
                 return 0.0;
             }
 
-            double transpositions = 0;
-            int j = 0;
-            for (size_t i = 0; i < ssize; i++) {
-                if (found_s[i]) {
-                    while (!found_t[j]) {
-                        j += 1;
+            int transpositions = 0;
+            for (int k = 0; k < m; k++) {
+                int j = ctz64(found_t);
+                transpositions += (matched_s[k] != charCode(t[j]));
+                found_t &= found_t - 1;
+            }
+
+            double sim = jaroScore(m, transpositions, ssize, tsize);
+            return (sim >= score_cutoff) ? sim : 0.0;
+        }
+
+        /**
+         * @brief Jaro similarity for strings `t` of any length.
+         * 
+         * @param bound Maximum distance between the positions of matching characters.
+         * @param score_cutoff Smallest similarity of interest. Similarities below it are reported as 0.
+         */
+        template<class Sequence>
+        static double jaroBlock(const Sequence& s, const Sequence& t, int bound, double score_cutoff = 0) {
+            return jaroBlock(BlockPatternMatchVector(t), s, t, bound, score_cutoff);
+        }
+
+        /**
+         * @brief Jaro similarity for strings `t` of any length, given the block position bit-vectors `PM` of `t`.
+         */
+        template<class Sequence>
+        static double jaroBlock(const BlockPatternMatchVector& PM, const Sequence& s, const Sequence& t, int bound, double score_cutoff = 0) {
+            int ssize = s.size();
+            int tsize = t.size();
+
+            vector<uint64_t> found_t(PM.words, 0);
+            vector<uint32_t> matched_s;
+            matched_s.reserve(min(ssize, tsize));
+
+            int imax = min(ssize, tsize + bound);
+            for (int i = 0; i < imax; i++) {
+                int lo = max(0, i - bound);
+                int hi = min(tsize - 1, i + bound);
+
+                for (int w = lo / 64; w <= hi / 64; w++) {
+                    uint64_t window = ~uint64_t(0);
+                    if (w == hi / 64 && hi % 64 != 63) {
+                        window &= (uint64_t(1) << (hi % 64 + 1)) - 1;
                     }
-                    if (s[i] != t[j]) {
-                        transpositions += 1;
+                    if (w == lo / 64) {
+                        window &= ~((uint64_t(1) << (lo % 64)) - 1);
+                    }
+
+                    uint64_t candidates = PM.get(w, s[i]) & ~found_t[w] & window;
+                    if (candidates) {
+                        found_t[w] |= candidates & (~candidates + 1);
+                        matched_s.push_back(charCode(s[i]));
+                        break;
                     }
-                    j += 1;
                 }
             }
 
-            return (m / ssize + m / tsize + (m - transpositions / 2.0) / m) / 3.0;
+            int m = matched_s.size();
+            if (jaroScore(m, 0, ssize, tsize) < score_cutoff) {
+                return 0.0;
+            }
+
+            int transpositions = 0;
+            size_t w = 0;
+            for (int k = 0; k < m; k++) {
+                while (found_t[w] == 0) {
+                    w++;
+                }
+                int j = 64 * w + ctz64(found_t[w]);
+                transpositions += (matched_s[k] != charCode(t[j]));
+                found_t[w] &= found_t[w] - 1;
+            }
+
+            double sim = jaroScore(m, transpositions, ssize, tsize);
+            return (sim >= score_cutoff) ? sim : 0.0;
         }
 
-        double compare(const string& s, const string& t) const {
+        bool isSimilarity() const {
+            return similarity;
+        }
+
+        /**
+         * @brief Comparison of any sequences of characters, such as `string_view`, `u32string` or vectors of code points.
+         */
+        template<class Sequence>
+        double compareSequences(const Sequence& s, const Sequence& t) const {
             if (this->similarity == true) {
                 return jaro(s, t);
             }
@@ -93,6 +232,153 @@ namespace stringcompare {
             }
         }
 
+        double compare(const string& s, const string& t) const {
+            return compareSequences(s, t);
+        }
+
+        double compareViews(string_view s, string_view t) const {
+            return compareSequences(s, t);
+        }
+
+        /**
+         * @brief Comparison with a score cutoff.
+         * 
+         * Comparisons which cannot beat the cutoff return 0 for similarities and 1 for distances.
+         */
+        template<class Sequence>
+        double compareSequences(const Sequence& s, const Sequence& t, double cutoff) const {
+            if (this->similarity == true) {
+                return jaro(s, t, cutoff);
+            }
+            else {
+                return 1.0 - jaro(s, t, 1.0 - cutoff);
+            }
+        }
+
+        double compare(const string& s, const string& t, double cutoff) const {
+            return compareSequences(s, t, cutoff);
+        }
+
+        double compareViews(string_view s, string_view t, double cutoff) const {
+            return compareSequences(s, t, cutoff);
+        }
+
+        /**
+         * @brief Jaro comparator with a fixed first string.
+         * 
+         * The Jaro similarity is symmetric, so that the characters of the second string are matched against position 
+         * bit-vectors of the first string, which are computed once.
+         */
+        class Cached : public CachedComparator<string> {
+        public:
+
+            bool similarity;
+            string s;
+            PatternMatchVector pm;
+            BlockPatternMatchVector block_pm;
+
+            explicit Cached(const string& s, bool similarity = false) :
+                similarity(similarity),
+                s(s) {
+                if (s.size() <= 64) {
+                    pm.insert(s);
+                }
+                else {
+                    block_pm.insert(s);
+                }
+            }
+
+            /**
+             * @brief Raw Jaro similarity with `t`. See Jaro::jaro().
+             */
+            double jaro(const string& t, double score_cutoff = 0) const {
+                auto ssize = s.size();
+                auto tsize = t.size();
+                if (ssize + tsize == 0) {
+                    return 1.0;
+                }
+                if (ssize == 0 || tsize == 0) {
+                    return 0.0;
+                }
+                if (jaroScore(min(ssize, tsize), 0, ssize, tsize) < score_cutoff) {
+                    return 0.0;
+                }
+                int window = max(1.0, floor(max(ssize, tsize) / 2.0) - 1);
+
+                if (ssize <= 64) {
+                    return jaroWord(pm, t, s, window - 1, score_cutoff);
+                }
+                else {
+                    return jaroBlock(block_pm, t, s, window - 1, score_cutoff);
+                }
+            }
+
+            bool isSimilarity() const {
+                return similarity;
+            }
+
+            double compare(const string& t) const {
+                if (this->similarity == true) {
+                    return jaro(t);
+                }
+                else {
+                    return 1.0 - jaro(t);
+                }
+            }
+
+            double compare(const string& t, double cutoff) const {
+                if (this->similarity == true) {
+                    return jaro(t, cutoff);
+                }
+                else {
+                    return 1.0 - jaro(t, 1.0 - cutoff);
+                }
+            }
+        };
+
+        /**
+         * @brief Prepare one-to-many comparisons from a fixed first string.
+         */
+        Cached prepare(const string& s) const {
+            return Cached(s, similarity);
+        }
+
+    };
+
+    /**
+     * @brief Jaro comparator with a compile-time similarity option. See Jaro.
+     */
+    template<bool similarity = false>
+    class StaticJaro : public StaticComparator<StaticJaro<similarity>, string> {
+    public:
+
+        static bool isSimilarity() {
+            return similarity;
+        }
+
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t) const {
+            if (similarity) {
+                return Jaro::jaro(s, t);
+            }
+            else {
+                return 1.0 - Jaro::jaro(s, t);
+            }
+        }
+
+        /**
+         * @brief Comparison with a score cutoff. See Jaro::compareSequences().
+         */
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t, double cutoff) const {
+            if (similarity) {
+                return Jaro::jaro(s, t, cutoff);
+            }
+            else {
+                return 1.0 - Jaro::jaro(s, t, 1.0 - cutoff);
+            }
+        }
+
     };
 
 }
@@ -37,8 +37,26 @@ namespace stringcompare {
 
         /**
          * @brief Raw Jaro-Winkler distance.
+         * 
+         * @param p Scaling factor of the common prefix bonus.
+         * @param score_cutoff Smallest similarity of interest. Similarities below it are reported as 0. Since the 
+         * similarity increases with the Jaro similarity, the cutoff is passed on to Jaro::jaro().
+         */
+        template<class Sequence>
+        static double jarowinkler(const Sequence& s, const Sequence& t, double p = 0.1, double score_cutoff = 0) {
+            int ell = prefix(s, t);
+
+            double sim = Jaro::jaro(s, t, jaroCutoff(score_cutoff, ell, p));
+            sim = sim + ell * p * (1 - sim);
+
+            return (sim >= score_cutoff) ? sim : 0.0;
+        }
+
+        /**
+         * @brief Length of the common prefix of two strings, up to 4 characters.
          */
-        static double jarowinkler(const string& s, const string& t, double p = 0.1) {
+        template<class Sequence>
+        static int prefix(const Sequence& s, const Sequence& t) {
             int ell = 0;
             for (size_t i = 0; i < min({ s.size(), t.size(), size_t(4) }); i++) {
                 if (s[i] == t[i]) {
@@ -49,12 +67,30 @@ namespace stringcompare {
                 }
             }
 
-            double sim = Jaro::jaro(s, t);
+            return ell;
+        }
+
+        /**
+         * @brief Smallest Jaro similarity for which the Jaro-Winkler similarity can reach `score_cutoff`.
+         */
+        static double jaroCutoff(double score_cutoff, int ell, double p) {
+            // Slightly loosened so that rounding errors cannot reject a similarity equal to the cutoff.
+            if (score_cutoff > 0 && ell * p < 1) {
+                return (score_cutoff - ell * p) / (1 - ell * p) - 1e-12;
+            }
+
+            return 0;
+        }
 
-            return sim + ell * p * (1 - sim);
+        bool isSimilarity() const {
+            return similarity;
         }
 
-        double compare(const string& s, const string& t) const {
+        /**
+         * @brief Comparison of any sequences of characters, such as `string_view`, `u32string` or vectors of code points.
+         */
+        template<class Sequence>
+        double compareSequences(const Sequence& s, const Sequence& t) const {
             if (this->similarity == true) {
                 return jarowinkler(s, t);
             }
@@ -63,6 +99,128 @@ namespace stringcompare {
             }
         }
 
+        double compare(const string& s, const string& t) const {
+            return compareSequences(s, t);
+        }
+
+        double compareViews(string_view s, string_view t) const {
+            return compareSequences(s, t);
+        }
+
+        /**
+         * @brief Comparison with a score cutoff.
+         * 
+         * Comparisons which cannot beat the cutoff return 0 for similarities and 1 for distances.
+         */
+        template<class Sequence>
+        double compareSequences(const Sequence& s, const Sequence& t, double cutoff) const {
+            if (this->similarity == true) {
+                return jarowinkler(s, t, 0.1, cutoff);
+            }
+            else {
+                return 1.0 - jarowinkler(s, t, 0.1, 1.0 - cutoff);
+            }
+        }
+
+        double compare(const string& s, const string& t, double cutoff) const {
+            return compareSequences(s, t, cutoff);
+        }
+
+        double compareViews(string_view s, string_view t, double cutoff) const {
+            return compareSequences(s, t, cutoff);
+        }
+
+        /**
+         * @brief Jaro-Winkler comparator with a fixed first string. See Jaro::Cached.
+         */
+        class Cached : public CachedComparator<string> {
+        public:
+
+            bool similarity;
+            Jaro::Cached jaro;
+
+            explicit Cached(const string& s, bool similarity = false) :
+                similarity(similarity),
+                jaro(s, true) {}
+
+            /**
+             * @brief Raw Jaro-Winkler similarity with `t`. See JaroWinkler::jarowinkler().
+             */
+            double jarowinkler(const string& t, double p = 0.1, double score_cutoff = 0) const {
+                int ell = prefix(jaro.s, t);
+
+                double sim = jaro.jaro(t, jaroCutoff(score_cutoff, ell, p));
+                sim = sim + ell * p * (1 - sim);
+
+                return (sim >= score_cutoff) ? sim : 0.0;
+            }
+
+            bool isSimilarity() const {
+                return similarity;
+            }
+
+            double compare(const string& t) const {
+                if (this->similarity == true) {
+                    return jarowinkler(t);
+                }
+                else {
+                    return 1.0 - jarowinkler(t);
+                }
+            }
+
+            double compare(const string& t, double cutoff) const {
+                if (this->similarity == true) {
+                    return jarowinkler(t, 0.1, cutoff);
+                }
+                else {
+                    return 1.0 - jarowinkler(t, 0.1, 1.0 - cutoff);
+                }
+            }
+        };
+
+        /**
+         * @brief Prepare one-to-many comparisons from a fixed first string.
+         */
+        Cached prepare(const string& s) const {
+            return Cached(s, similarity);
+        }
+
+    };
+
+    /**
+     * @brief JaroWinkler comparator with a compile-time similarity option. See JaroWinkler.
+     */
+    template<bool similarity = false>
+    class StaticJaroWinkler : public StaticComparator<StaticJaroWinkler<similarity>, string> {
+    public:
+
+        static bool isSimilarity() {
+            return similarity;
+        }
+
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t) const {
+            if (similarity) {
+                return JaroWinkler::jarowinkler(s, t);
+            }
+            else {
+                return 1.0 - JaroWinkler::jarowinkler(s, t);
+            }
+        }
+
+        /**
+         * @brief Comparison with a score cutoff. See JaroWinkler::compareSequences().
+         */
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t, double cutoff) const {
+            if (similarity) {
+                return JaroWinkler::jarowinkler(s, t, 0.1, cutoff);
+            }
+            else {
+                return 1.0 - JaroWinkler::jarowinkler(s, t, 0.1, 1.0 - cutoff);
+            }
+        }
+
     };
 
 }
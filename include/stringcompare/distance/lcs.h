@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 
+#include "bitparallel.h"
 #include "comparator.h"
 
 using namespace std;
@@ -28,7 +29,6 @@ namespace stringcompare {
         bool normalize;
         bool similarity;
         int dmat_size;
-        vector<int> dmat;
 
         /**
          * @brief Construct a new LCSDistance object.
@@ -50,62 +50,381 @@ namespace stringcompare {
         LCSDistance(bool normalize = true, bool similarity = false, int dmat_size = 100) :
             normalize(normalize),
             similarity(similarity),
-            dmat_size(dmat_size),
-            dmat(vector<int>(dmat_size)) {}
+            dmat_size(dmat_size) {
+            workspace().block_pm.reserve(dmat_size);
+        }
+
+        /**
+         * @brief Pattern match vectors of the calling thread.
+         */
+        static PatternMatchWorkspace& workspace() {
+            static thread_local PatternMatchWorkspace ws;
+            return ws;
+        }
 
         /**
          * @brief Length of the longest common substring.
+         * 
+         * The shortest string is used as the pattern of a bit-parallel kernel: hyyro() when it fits in a 64 bits word, 
+         * and hyyroBlock() otherwise.
+         * 
+         * @param min_length Smallest length of interest. Lengths below it are reported as 0, which allows the computation 
+         * to stop early.
          */
-        int lcs(const string& s, const string& t) {
-            int m = s.size();
+        template<class Sequence>
+        static int lcs(const Sequence& s, const Sequence& t, int min_length = 0) {
+            const Sequence& a = (s.size() <= t.size()) ? s : t;
+            const Sequence& b = (s.size() <= t.size()) ? t : s;
+            int m = a.size();
+
+            if (m < min_length || m == 0) {
+                return 0;
+            }
+
+            PatternMatchWorkspace& ws = workspace();
+            int length;
+            if (m <= 64) {
+                PatternMatchVector& pm = ws.pm;
+                pm.insert(a);
+                length = hyyroDispatch(pm, m, b, min_length);
+                pm.clear(a);
+            }
+            else {
+                BlockPatternMatchVector& block_pm = ws.block_pm;
+                block_pm.insert(a);
+                length = hyyroBlockDispatch(block_pm, m, b, min_length);
+                block_pm.clear(a);
+            }
+
+            return length;
+        }
+
+        /**
+         * @brief LCS length between a pattern of length 1 <= m <= 64 and a string t.
+         * 
+         * Bit-parallel algorithm of Allison and Dix (1986), in the formulation of Hyyrö (2004). Zero bits of the 
+         * vector `S` mark the pattern positions where the LCS length increases along the current column.
+         * 
+         * When `min_length` is positive, the computation stops as soon as the current length plus the number of remaining 
+         * columns falls below it.
+         * 
+         * @param PM Pattern match vector of the pattern.
+         * @param m Length of the pattern.
+         * @param t String to compare to.
+         * @param min_length Smallest length of interest. Lengths below it are reported as 0.
+         */
+        template<class Sequence>
+        STRINGCOMPARE_ALWAYS_INLINE static int hyyro(const PatternMatchVector& PM, int m, const Sequence& t, int min_length = 0) {
+            int n = t.size();
+            uint64_t S = ~uint64_t(0);
+            uint64_t mask = (m == 64) ? ~uint64_t(0) : (uint64_t(1) << m) - 1;
+
+            for (int j = 0; j < n; j++) {
+                uint64_t U = S & PM.get(t[j]);
+                S = (S + U) | (S - U);
+
+                if (min_length > 0 && popcount64(~S & mask) + (n - j - 1) < min_length) {
+                    return 0;
+                }
+            }
+
+            int length = popcount64(~S & mask);
+            return (length >= min_length) ? length : 0;
+        }
+
+        /**
+         * @brief LCS length between a pattern of length m >= 1 and a string t.
+         * 
+         * Multi-word version of hyyro(), where the carry of the addition is propagated from one 64 bits block to the next.
+         * 
+         * When `min_length` is positive, blocks are only started once they intersect the diagonal band of cells which can 
+         * lie on an alignment with at most `m + |t| - 2 * min_length` insertions and deletions, and the length bound 
+         * of hyyro() is checked every 64 columns.
+         * 
+         * @param PM Block pattern match vector of the pattern.
+         * @param m Length of the pattern.
+         * @param t String to compare to.
+         * @param min_length Smallest length of interest. Lengths below it are reported as 0.
+         */
+        template<class Sequence>
+        STRINGCOMPARE_ALWAYS_INLINE static int hyyroBlock(const BlockPatternMatchVector& PM, int m, const Sequence& t, int min_length = 0) {
             int n = t.size();
+            int words = PM.words;
+            if (min(m, n) < min_length) {
+                return 0;
+            }
+
+            vector<uint64_t> S(words, ~uint64_t(0));
+
+            // Rows (from 1 to m) of the band at column j are at most j + band_hi.
+            int band_hi = min(0, m - n) + (m + n - 2 * max(min_length, 0));
+            int last_block = (min(m, max(band_hi, 1)) - 1) / 64;
 
-            dmat.reserve(m + 1);
-
-            for (int i = 0; i < dmat_size; i++) {
-                dmat[i] = 0;
-            }
-
-            int p = 0;
-            int temp;
-            for (int j = 1; j <= n; j++) {
-                temp = 0;
-                p = 0;
-                for (int i = 1; i <= m; i++) {
-                    if (s[i - 1] != t[j - 1]) {
-                        p = max({ dmat[i], p });
-                    }
-                    else {
-                        p = temp + 1;
-                    }
-                    temp = dmat[i];
-                    dmat[i] = p;
+            for (int j = 0; j < n; j++) {
+                last_block = max(last_block, (min(m, j + 1 + band_hi) - 1) / 64);
+
+                uint64_t carry = 0;
+                for (int w = 0; w <= last_block; w++) {
+                    uint64_t U = S[w] & PM.get(w, t[j]);
+                    uint64_t sum = S[w] + carry;
+                    carry = sum < carry;
+                    sum += U;
+                    carry |= sum < U;
+                    S[w] = sum | (S[w] - U);
+                }
+
+                if (min_length > 0 && j % 64 == 63 && lcsLength(S, m, last_block) + (n - j - 1) < min_length) {
+                    return 0;
                 }
             }
 
-            return p;
+            int result = lcsLength(S, m, words - 1);
+            return (result >= min_length) ? result : 0;
+        }
+
+        /**
+         * @brief hyyro() compiled with hardware popcount, when the CPU supports it. See cpuLevel().
+         * 
+         * The kernel is a chain of dependent word operations, so that wider vector instruction sets do not speed it up.
+         */
+        template<class Sequence>
+        static int hyyroDispatch(const PatternMatchVector& PM, int m, const Sequence& t, int min_length = 0) {
+            if (cpuLevel() >= CPU_SSE42) {
+                return hyyroPopcnt(PM, m, t, min_length);
+            }
+
+            return hyyro(PM, m, t, min_length);
         }
 
-        double compare(const string& s, const string& t) {
+        /**
+         * @brief hyyroBlock() compiled with hardware popcount, when the CPU supports it. See cpuLevel().
+         */
+        template<class Sequence>
+        static int hyyroBlockDispatch(const BlockPatternMatchVector& PM, int m, const Sequence& t, int min_length = 0) {
+            if (cpuLevel() >= CPU_SSE42) {
+                return hyyroBlockPopcnt(PM, m, t, min_length);
+            }
+
+            return hyyroBlock(PM, m, t, min_length);
+        }
+
+        template<class Sequence>
+        STRINGCOMPARE_TARGET_SSE42 static int hyyroPopcnt(const PatternMatchVector& PM, int m, const Sequence& t, int min_length) {
+            return hyyro(PM, m, t, min_length);
+        }
+
+        template<class Sequence>
+        STRINGCOMPARE_TARGET_SSE42 static int hyyroBlockPopcnt(const BlockPatternMatchVector& PM, int m, const Sequence& t, int min_length) {
+            return hyyroBlock(PM, m, t, min_length);
+        }
+
+        /**
+         * @brief LCS length encoded in the first blocks of a bit-vector `S` of hyyroBlock().
+         */
+        STRINGCOMPARE_ALWAYS_INLINE static int lcsLength(const vector<uint64_t>& S, int m, int last_block) {
+            int result = 0;
+            for (int w = 0; w <= last_block; w++) {
+                uint64_t bits = ~S[w];
+                if (w == last_block && 64 * (w + 1) > m) {
+                    bits &= (uint64_t(1) << (m % 64)) - 1;
+                }
+                result += popcount64(bits);
+            }
+
+            return result;
+        }
+
+        bool isSimilarity() const {
+            return similarity;
+        }
+
+        /**
+         * @brief Comparison of any sequences of characters, such as `string_view`, `u32string` or vectors of code points.
+         */
+        template<class Sequence>
+        double compareSequences(const Sequence& s, const Sequence& t) const {
             double len = s.size() + t.size();
             if (len == 0) {
                 return similarity;
             }
 
-            double dist = len - 2.0 * lcs(s, t);
-            if (similarity) {
-                double sim = (len - dist) / 2.0;
-                if (normalize) {
-                    sim = sim / (len - sim);
+            return editScore(len - 2.0 * lcs(s, t), len, normalize, similarity);
+        }
+
+        double compare(const string& s, const string& t) const {
+            return compareSequences(s, t);
+        }
+
+        double compareViews(string_view s, string_view t) const {
+            return compareSequences(s, t);
+        }
+
+        /**
+         * @brief Comparison with a score cutoff.
+         * 
+         * The cutoff is converted to a smallest LCS length of interest, which bounds the computation of the kernels. 
+         * Comparisons which cannot beat the cutoff return the score of the maximal distance `|s| + |t|`.
+         */
+        template<class Sequence>
+        double compareSequences(const Sequence& s, const Sequence& t, double cutoff) const {
+            int len = s.size() + t.size();
+            if (len == 0) {
+                return similarity;
+            }
+
+            int max_dist = maxEditDistance(cutoff, len, normalize, similarity);
+            if (max_dist < 0) {
+                return editScore(len, len, normalize, similarity);
+            }
+
+            // The LCS distance `len - 2 * lcs` is at most max_dist.
+            int min_length = (len - max_dist + 1) / 2;
+            int length = lcs(s, t, min_length);
+            if (length < min_length) {
+                return editScore(len, len, normalize, similarity);
+            }
+
+            return editScore(len - 2.0 * length, len, normalize, similarity);
+        }
+
+        double compare(const string& s, const string& t, double cutoff) const {
+            return compareSequences(s, t, cutoff);
+        }
+
+        double compareViews(string_view s, string_view t, double cutoff) const {
+            return compareSequences(s, t, cutoff);
+        }
+
+        /**
+         * @brief LCSDistance comparator with a fixed first string.
+         * 
+         * The pattern match vectors of the first string are computed once, so that comparisons only scan the second string.
+         */
+        class Cached : public CachedComparator<string> {
+        public:
+
+            bool normalize;
+            bool similarity;
+            string s;
+            PatternMatchVector pm;
+            BlockPatternMatchVector block_pm;
+
+            Cached(const string& s, bool normalize = true, bool similarity = false) :
+                normalize(normalize),
+                similarity(similarity),
+                s(s) {
+                if (s.size() <= 64) {
+                    pm.insert(s);
+                }
+                else {
+                    block_pm.insert(s);
                 }
-                return sim;
             }
-            else {
-                if (normalize) {
-                    dist = 2 * dist / (len + dist);
+
+            /**
+             * @brief Length of the longest common substring with `t`. See LCSDistance::lcs().
+             */
+            int lcs(const string& t, int min_length = 0) const {
+                int m = s.size();
+
+                if (min(m, (int)t.size()) < min_length || m == 0) {
+                    return 0;
+                }
+
+                if (m <= 64) {
+                    return hyyroDispatch(pm, m, t, min_length);
+                }
+                else {
+                    return hyyroBlockDispatch(block_pm, m, t, min_length);
+                }
+            }
+
+            bool isSimilarity() const {
+                return similarity;
+            }
+
+            double compare(const string& t) const {
+                double len = s.size() + t.size();
+                if (len == 0) {
+                    return similarity;
+                }
+
+                return editScore(len - 2.0 * lcs(t), len, normalize, similarity);
+            }
+
+            double compare(const string& t, double cutoff) const {
+                int len = s.size() + t.size();
+                if (len == 0) {
+                    return similarity;
+                }
+
+                int max_dist = maxEditDistance(cutoff, len, normalize, similarity);
+                if (max_dist < 0) {
+                    return editScore(len, len, normalize, similarity);
+                }
+
+                int min_length = (len - max_dist + 1) / 2;
+                int length = lcs(t, min_length);
+                if (length < min_length) {
+                    return editScore(len, len, normalize, similarity);
                 }
-                return dist;
+
+                return editScore(len - 2.0 * length, len, normalize, similarity);
             }
+        };
+
+        /**
+         * @brief Prepare one-to-many comparisons from a fixed first string.
+         */
+        Cached prepare(const string& s) const {
+            return Cached(s, normalize, similarity);
+        }
+
+    };
+
+    /**
+     * @brief LCSDistance comparator with compile-time normalization and similarity options. See LCSDistance.
+     */
+    template<bool normalize = true, bool similarity = false>
+    class StaticLCSDistance : public StaticComparator<StaticLCSDistance<normalize, similarity>, string> {
+    public:
+
+        static bool isSimilarity() {
+            return similarity;
+        }
+
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t) const {
+            double len = s.size() + t.size();
+            if (len == 0) {
+                return similarity;
+            }
+
+            return editScore<normalize, similarity>(len - 2.0 * LCSDistance::lcs(s, t), len);
+        }
+
+        /**
+         * @brief Comparison with a score cutoff. See LCSDistance::compareSequences().
+         */
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t, double cutoff) const {
+            int len = s.size() + t.size();
+            if (len == 0) {
+                return similarity;
+            }
+
+            int max_dist = maxEditDistance(cutoff, len, normalize, similarity);
+            if (max_dist < 0) {
+                return editScore<normalize, similarity>(len, len);
+            }
+
+            int min_length = (len - max_dist + 1) / 2;
+            int length = LCSDistance::lcs(s, t, min_length);
+            if (length < min_length) {
+                return editScore<normalize, similarity>(len, len);
+            }
+
+            return editScore<normalize, similarity>(len - 2.0 * length, len);
         }
 
     };
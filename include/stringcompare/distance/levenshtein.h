@@ -9,10 +9,13 @@
 #ifndef STRINGCOMPARE_DISTANCE_LEVENSHTEIN_HPP_INCLUDED
 #define STRINGCOMPARE_DISTANCE_LEVENSHTEIN_HPP_INCLUDED
 
+#include <limits.h>
+#include <string.h>
 #include <algorithm>
 #include <string>
 #include <vector>
 
+#include "bitparallel.h"
 #include "comparator.h"
 
 using namespace std;
@@ -30,7 +33,6 @@ namespace stringcompare {
         bool normalize;
         bool similarity;
         int dmat_size;
-        vector<int> dmat;
 
         /**
          * @brief Construct a new Levenshtein object.
@@ -52,59 +54,726 @@ namespace stringcompare {
         Levenshtein(bool normalize = true, bool similarity = false, int dmat_size = 100) :
             normalize(normalize),
             similarity(similarity),
-            dmat_size(dmat_size),
-            dmat(vector<int>(dmat_size)) {}
+            dmat_size(dmat_size) {
+            workspace().block_pm.reserve(dmat_size);
+        }
+
+        /**
+         * @brief Pattern match vectors of the calling thread.
+         */
+        static PatternMatchWorkspace& workspace() {
+            static thread_local PatternMatchWorkspace ws;
+            return ws;
+        }
 
         /**
          * @brief Raw Levenshtein distance
+         * 
+         * The shortest string is used as the pattern of a bit-parallel kernel: myers() when it fits in a 64 bits word, 
+         * and myersBlock() otherwise.
+         * 
+         * @param max_dist Largest distance of interest. Distances above it are reported as `max_dist + 1`, which allows 
+         * the computation to stop early.
          */
-        int levenshtein(const string& s, const string& t) {
-            int m = s.size();
+        template<class Sequence>
+        static int levenshtein(const Sequence& s, const Sequence& t, int max_dist = INT_MAX) {
+            const Sequence& a = (s.size() <= t.size()) ? s : t;
+            const Sequence& b = (s.size() <= t.size()) ? t : s;
+            int m = a.size();
+            int n = b.size();
+
+            max_dist = min(max_dist, n);
+            if (n - m > max_dist) {
+                return max_dist + 1;
+            }
+            if (m == 0) {
+                return n;
+            }
+            if (max_dist == 0) {
+                return (a == b) ? 0 : 1;
+            }
+
+            PatternMatchWorkspace& ws = workspace();
+            int dist;
+            if (m <= 64) {
+                PatternMatchVector& pm = ws.pm;
+                pm.insert(a);
+                dist = myers(pm, m, b, max_dist);
+                pm.clear(a);
+            }
+            else {
+                BlockPatternMatchVector& block_pm = ws.block_pm;
+                block_pm.insert(a);
+                dist = myersBlock(block_pm, m, b, max_dist);
+                block_pm.clear(a);
+            }
+
+            return dist;
+        }
+
+        /**
+         * @brief Levenshtein distance between a pattern of length 1 <= m <= 64 and a string t.
+         * 
+         * Bit-parallel algorithm of Myers (1999), in the formulation of Hyyrö (2001). Each column of the dynamic 
+         * programming matrix is encoded by its vertical positive and negative deltas, and is updated in a few word operations.
+         * 
+         * The computation stops as soon as the distance on the last row, minus the number of remaining columns, exceeds `max_dist`.
+         * 
+         * @param PM Pattern match vector of the pattern.
+         * @param m Length of the pattern.
+         * @param t String to compare to.
+         * @param max_dist Largest distance of interest. Distances above it are reported as `max_dist + 1`.
+         */
+        template<class Sequence>
+        static int myers(const PatternMatchVector& PM, int m, const Sequence& t, int max_dist = INT_MAX) {
+            int n = t.size();
+            uint64_t VP = (m == 64) ? ~uint64_t(0) : (uint64_t(1) << m) - 1;
+            uint64_t VN = 0;
+            uint64_t last = uint64_t(1) << (m - 1);
+            int dist = m;
+
+            // The final distance is at least the current one minus the number of remaining columns.
+            int64_t break_dist = (int64_t)max_dist + n;
+
+            for (int j = 0; j < n; j++) {
+                uint64_t X = PM.get(t[j]) | VN;
+                uint64_t D0 = (((X & VP) + VP) ^ VP) | X;
+                uint64_t HP = VN | ~(D0 | VP);
+                uint64_t HN = D0 & VP;
+
+                dist += (HP & last) != 0;
+                dist -= (HN & last) != 0;
+
+                break_dist--;
+                if (dist > break_dist) {
+                    return max_dist + 1;
+                }
+
+                HP = (HP << 1) | 1;
+                HN = HN << 1;
+                VP = HN | ~(D0 | HP);
+                VN = HP & D0;
+            }
+
+            return (dist <= max_dist) ? dist : max_dist + 1;
+        }
+
+        /**
+         * @brief Levenshtein distance between a pattern of length m >= 1 and a string t.
+         * 
+         * Multi-word version of myers(), where horizontal deltas are carried from one 64 bits block to the next.
+         * 
+         * Following Ukkonen (1985), only the blocks intersecting the diagonal band of cells which can lie on an alignment 
+         * of cost at most `max_dist` are computed. Blocks above the band are left behind, and blocks below it are started 
+         * when the band reaches them. Cells outside of the band are then overestimated, which does not affect 
+         * distances of at most `max_dist`.
+         * 
+         * @param PM Block pattern match vector of the pattern.
+         * @param m Length of the pattern.
+         * @param t String to compare to.
+         * @param max_dist Largest distance of interest. Distances above it are reported as `max_dist + 1`.
+         */
+        template<class Sequence>
+        static int myersBlock(const BlockPatternMatchVector& PM, int m, const Sequence& t, int max_dist = INT_MAX) {
             int n = t.size();
+            int words = PM.words;
+            max_dist = min(max_dist, max(m, n));
+            if (abs(m - n) > max_dist) {
+                return max_dist + 1;
+            }
+
+            vector<uint64_t> VP(words, ~uint64_t(0));
+            vector<uint64_t> VN(words, 0);
+            uint64_t last = uint64_t(1) << ((m - 1) % 64);
+
+            // Distance on the last row of each block.
+            vector<int> dist(words);
+            for (int w = 0; w < words; w++) {
+                dist[w] = min(64 * (w + 1), m);
+            }
+
+            // Rows (from 1 to m) of the band at column j are within [j - max_dist, j + max_dist] and
+            // [j + m - n - max_dist, j + m - n + max_dist].
+            int band_hi = min(0, m - n) + max_dist;
+            int first_block = 0;
+            int last_block = min(m, max(band_hi, 1)) - 1;
+            last_block = last_block / 64;
+
+            for (int j = 0; j < n; j++) {
+                int hi = min(m, j + 1 + band_hi);
+                while (last_block < (hi - 1) / 64) {
+                    last_block++;
+                    dist[last_block] = dist[last_block - 1] + min(64 * (last_block + 1), m) - 64 * last_block;
+                }
+                int lo = max(1, j + 1 + max(-max_dist, m - n - max_dist));
+                first_block = (lo - 1) / 64;
+
+                uint64_t HP_carry = 1;
+                uint64_t HN_carry = 0;
+
+                for (int w = first_block; w <= last_block; w++) {
+                    uint64_t X = PM.get(w, t[j]) | HN_carry;
+                    uint64_t D0 = (((X & VP[w]) + VP[w]) ^ VP[w]) | X | VN[w];
+                    uint64_t HP = VN[w] | ~(D0 | VP[w]);
+                    uint64_t HN = D0 & VP[w];
+
+                    uint64_t last_row = (w == words - 1) ? last : uint64_t(1) << 63;
+                    dist[w] += (HP & last_row) != 0;
+                    dist[w] -= (HN & last_row) != 0;
+
+                    uint64_t HP_carry_in = HP_carry;
+                    uint64_t HN_carry_in = HN_carry;
+                    HP_carry = HP >> 63;
+                    HN_carry = HN >> 63;
+                    HP = (HP << 1) | HP_carry_in;
+                    HN = (HN << 1) | HN_carry_in;
+
+                    VP[w] = HN | ~(D0 | HP);
+                    VN[w] = HP & D0;
+                }
+
+                if (last_block == words - 1 && dist[last_block] - (n - j - 1) > max_dist) {
+                    return max_dist + 1;
+                }
+            }
+
+            return (dist[words - 1] <= max_dist) ? dist[words - 1] : max_dist + 1;
+        }
+
+        /**
+         * @brief Levenshtein distances between a pattern of length 1 <= m <= 64 and up to `BATCH_LANES` strings at once.
+         * 
+         * The strings are interleaved across lanes which run myers() in lockstep, one column per step. The lanes have no 
+         * branches, so that compilers targeting AVX2 or AVX-512 carry out their word operations with SIMD instructions. 
+         * Lanes past the end of their string are left unchanged.
+         * 
+         * @param PM Pattern match vector of the pattern.
+         * @param m Length of the pattern.
+         * @param t Array of `count <= BATCH_LANES` strings or `string_view`s to compare to.
+         * @param count Number of strings.
+         * @param dist Array of at least `count` distances.
+         */
+        template<class Str>
+        STRINGCOMPARE_ALWAYS_INLINE static void myersBatch(const PatternMatchVector& PM, int m, const Str* const* t, int count, int* dist) {
+            static const unsigned char empty[1] = { 0 };
+
+            uint64_t VP[BATCH_LANES], VN[BATCH_LANES], D[BATCH_LANES];
+            const unsigned char* text[BATCH_LANES];
+            size_t n[BATCH_LANES];
+            size_t n_max = 0;
+            for (int l = 0; l < BATCH_LANES; l++) {
+                n[l] = (l < count) ? t[l]->size() : 0;
+                text[l] = (n[l] > 0) ? (const unsigned char*)t[l]->data() : empty;
+                n_max = max(n_max, n[l]);
+                VP[l] = (m == 64) ? ~uint64_t(0) : (uint64_t(1) << m) - 1;
+                VN[l] = 0;
+                D[l] = m;
+            }
+
+            int last = m - 1;
+#if defined(__GNUC__) || defined(__clang__)
+            // Vector extensions, which are lowered to the widest registers of the target, such as one AVX2 register
+            // in myersBatchAvx2(). Only the loads of the pattern match vector are done lane by lane.
+            typedef uint64_t Lanes __attribute__((vector_size(8 * BATCH_LANES)));
+            Lanes vp, vn, d, length;
+            for (int l = 0; l < BATCH_LANES; l++) {
+                vp[l] = VP[l];
+                vn[l] = VN[l];
+                d[l] = D[l];
+                length[l] = n[l];
+            }
+            for (size_t j = 0; j < n_max; j++) {
+                // Inactive lanes read their first character, which exists since empty strings are read from `empty`.
+                Lanes active = (Lanes)(j < length);
+                uint64_t matches[BATCH_LANES];
+                for (int l = 0; l < BATCH_LANES; l++) {
+                    matches[l] = PM.get(text[l][(j < n[l]) ? j : 0]);
+                }
+                Lanes X;
+                memcpy(&X, matches, sizeof(X));
+                X = (X & active) | vn;
+                Lanes D0 = (((X & vp) + vp) ^ vp) | X;
+                Lanes HP = vn | ~(D0 | vp);
+                Lanes HN = D0 & vp;
+
+                // Modular arithmetic: the difference of the last row bits is added as 0, 1 or 2^64 - 1.
+                d += (((HP >> last) & 1) - ((HN >> last) & 1)) & active;
+
+                HP = (HP << 1) | 1;
+                HN = HN << 1;
+                vp = ((HN | ~(D0 | HP)) & active) | (vp & ~active);
+                vn = (HP & D0 & active) | (vn & ~active);
+            }
+            for (int l = 0; l < BATCH_LANES; l++) {
+                D[l] = d[l];
+            }
+#else
+            for (size_t j = 0; j < n_max; j++) {
+                for (int l = 0; l < BATCH_LANES; l++) {
+                    // Inactive lanes read their first character, which exists since empty strings are read from `empty`.
+                    uint64_t active = (j < n[l]) ? ~uint64_t(0) : 0;
+                    uint64_t X = (PM.get(text[l][j & active]) & active) | VN[l];
+                    uint64_t D0 = (((X & VP[l]) + VP[l]) ^ VP[l]) | X;
+                    uint64_t HP = VN[l] | ~(D0 | VP[l]);
+                    uint64_t HN = D0 & VP[l];
+
+                    // Modular arithmetic: the difference of the last row bits is added as 0, 1 or 2^64 - 1.
+                    D[l] += (((HP >> last) & 1) - ((HN >> last) & 1)) & active;
+
+                    HP = (HP << 1) | 1;
+                    HN = HN << 1;
+                    VP[l] = ((HN | ~(D0 | HP)) & active) | (VP[l] & ~active);
+                    VN[l] = (HP & D0 & active) | (VN[l] & ~active);
+                }
+            }
+#endif
+
+            for (int l = 0; l < count; l++) {
+                dist[l] = (int)D[l];
+            }
+        }
+
+        /**
+         * @brief myersBatch() compiled for AVX2, for builds which do not target it. See cpuLevel().
+         */
+        template<class Str>
+        STRINGCOMPARE_TARGET_AVX2 static void myersBatchAvx2(const PatternMatchVector& PM, int m, const Str* const* t, int count, int* dist) {
+            myersBatch(PM, m, t, count, dist);
+        }
+
+        /**
+         * @brief Comparisons of a string `s` of length 1 <= m <= 64 with each of `count` strings.
+         * 
+         * Strings whose length difference with `s` exceeds the largest distance of interest are not compared, and receive 
+         * the score of the maximal distance `|s| + |t|`. The others are compared by groups of `BATCH_LANES` using 
+         * myersBatch() when compiling for AVX2, or with its AVX2 clone when the CPU supports it (see cpuLevel()) and `s` 
+         * has at least 32 characters. They are compared one at a time using myers() otherwise, where lanes would not pay off.
+         * 
+         * @param PM Pattern match vector of `s`.
+         * @param t Array of `count` strings or `string_view`s.
+         * @param has_cutoff Whether to apply the score cutoff `cutoff`. See compare(const string&, const string&, double).
+         */
+        template<class Str>
+        static void compareBatch(const PatternMatchVector& PM, const Str& s, const Str* t, size_t count, double* out, 
+            bool has_cutoff, double cutoff, bool normalize, bool similarity) {
+            int m = s.size();
+            const Str* lane_t[BATCH_LANES];
+            size_t lane_i[BATCH_LANES];
+            int lane_max[BATCH_LANES];
+            int dist[BATCH_LANES];
+            int lanes = 0;
+#if defined(__AVX2__)
+            bool use_lanes = true;
+#else
+            // Measured on baseline builds, the AVX2 clone only beats myers() for patterns of at least 32 characters.
+            bool use_lanes = m >= 32 && cpuLevel() >= CPU_AVX2;
+#endif
+
+            auto flush = [&]() {
+#if defined(__AVX2__)
+                myersBatch(PM, m, lane_t, lanes, dist);
+#else
+                if (use_lanes) {
+                    myersBatchAvx2(PM, m, lane_t, lanes, dist);
+                }
+                else {
+                    for (int l = 0; l < lanes; l++) {
+                        dist[l] = myers(PM, m, *lane_t[l], lane_max[l]);
+                    }
+                }
+#endif
+                for (int l = 0; l < lanes; l++) {
+                    int len = m + lane_t[l]->size();
+                    out[lane_i[l]] = editScore((dist[l] <= lane_max[l]) ? dist[l] : len, len, normalize, similarity);
+                }
+                lanes = 0;
+            };
 
-            dmat.reserve(m + 1);
+            static thread_local vector<pair<size_t, int>> pending;
+            pending.clear();
+            for (size_t i = 0; i < count; i++) {
+                int n = t[i].size();
+                int len = m + n;
+                int max_dist = has_cutoff ? maxEditDistance(cutoff, len, normalize, similarity) : len;
+                if (abs(m - n) > max_dist) {
+                    out[i] = editScore(len, len, normalize, similarity);
+                    continue;
+                }
+                pending.emplace_back(i, max_dist);
+            }
 
-            for (int i = 0; i <= m; i++) {
-                dmat[i] = i;
+            // Lanes run for as many columns as their longest string, so that strings of similar lengths are grouped.
+            if (use_lanes) {
+                sort(pending.begin(), pending.end(), [&](const pair<size_t, int>& a, const pair<size_t, int>& b) {
+                    return t[a.first].size() < t[b.first].size();
+                });
             }
 
-            int p = m;
-            int temp;
-            for (int j = 1; j <= n; j++) {
-                temp = j - 1;
-                p = j;
-                for (int i = 1; i <= m; i++) {
-                    p = min({ p + 1, dmat[i] + 1, temp + (s[i - 1] != t[j - 1]) });
-                    temp = dmat[i];
-                    dmat[i] = p;
+            for (const pair<size_t, int>& p : pending) {
+                lane_t[lanes] = &t[p.first];
+                lane_i[lanes] = p.first;
+                lane_max[lanes] = p.second;
+                lanes++;
+                if (lanes == BATCH_LANES) {
+                    flush();
                 }
             }
+            if (lanes > 0) {
+                flush();
+            }
+        }
 
-            return p;
+        bool isSimilarity() const {
+            return similarity;
         }
 
-        double compare(const string& s, const string& t) {
+        /**
+         * @brief Comparison of any sequences of characters, such as `string_view`, `u32string` or vectors of code points.
+         */
+        template<class Sequence>
+        double compareSequences(const Sequence& s, const Sequence& t) const {
             double len = s.size() + t.size();
 
             if (len == 0) {
                 return similarity;
             }
 
-            double dist = levenshtein(s, t);
+            return editScore(levenshtein(s, t), len, normalize, similarity);
+        }
+
+        double compare(const string& s, const string& t) const {
+            return compareSequences(s, t);
+        }
+
+        double compareViews(string_view s, string_view t) const {
+            return compareSequences(s, t);
+        }
+
+        /**
+         * @brief Comparison with a score cutoff.
+         * 
+         * The cutoff is converted to a largest distance of interest, which bounds the diagonal band of the kernels. 
+         * Comparisons which cannot beat the cutoff return the score of the maximal distance `|s| + |t|`.
+         */
+        template<class Sequence>
+        double compareSequences(const Sequence& s, const Sequence& t, double cutoff) const {
+            int len = s.size() + t.size();
+
+            if (len == 0) {
+                return similarity;
+            }
+
+            int max_dist = maxEditDistance(cutoff, len, normalize, similarity);
+            if (max_dist < 0) {
+                return editScore(len, len, normalize, similarity);
+            }
+
+            int dist = levenshtein(s, t, max_dist);
+            if (dist > max_dist) {
+                return editScore(len, len, normalize, similarity);
+            }
+
+            return editScore(dist, len, normalize, similarity);
+        }
+
+        double compare(const string& s, const string& t, double cutoff) const {
+            return compareSequences(s, t, cutoff);
+        }
 
-            if (similarity) {
-                double sim = (len - dist) / 2.0;
-                if (normalize) {
-                    sim = sim / (len - sim);
+        double compareViews(string_view s, string_view t, double cutoff) const {
+            return compareSequences(s, t, cutoff);
+        }
+
+        /**
+         * @brief Comparisons of `s` with each of `count` strings. Strings `s` of at most 64 characters use compareBatch().
+         */
+        void compareMany(const string& s, const string* t, size_t count, double* out) const {
+            if (s.empty() || s.size() > 64) {
+                StringComparator::compareMany(s, t, count, out);
+                return;
+            }
+
+            PatternMatchVector& pm = workspace().pm;
+            pm.insert(s);
+            compareBatch(pm, s, t, count, out, false, 0, normalize, similarity);
+            pm.clear(s);
+        }
+
+        void compareMany(const string& s, const string* t, size_t count, double* out, double cutoff) const {
+            if (s.empty() || s.size() > 64) {
+                StringComparator::compareMany(s, t, count, out, cutoff);
+                return;
+            }
+
+            PatternMatchVector& pm = workspace().pm;
+            pm.insert(s);
+            compareBatch(pm, s, t, count, out, true, cutoff, normalize, similarity);
+            pm.clear(s);
+        }
+
+        /**
+         * @brief Comparisons of `s` with each of `count` `string_view`s, such as the strings of a StringColumn. See
+         * compareMany().
+         */
+        void compareManyViews(string_view s, const string_view* t, size_t count, double* out) const {
+            if (s.empty() || s.size() > 64) {
+                StringComparator::compareManyViews(s, t, count, out);
+                return;
+            }
+
+            PatternMatchVector& pm = workspace().pm;
+            pm.insert(s);
+            compareBatch(pm, s, t, count, out, false, 0, normalize, similarity);
+            pm.clear(s);
+        }
+
+        void compareManyViews(string_view s, const string_view* t, size_t count, double* out, double cutoff) const {
+            if (s.empty() || s.size() > 64) {
+                StringComparator::compareManyViews(s, t, count, out, cutoff);
+                return;
+            }
+
+            PatternMatchVector& pm = workspace().pm;
+            pm.insert(s);
+            compareBatch(pm, s, t, count, out, true, cutoff, normalize, similarity);
+            pm.clear(s);
+        }
+
+        /**
+         * @brief Levenshtein comparator with a fixed first string.
+         * 
+         * The pattern match vectors of the first string are computed once, so that comparisons only scan the second string.
+         */
+        class Cached : public CachedComparator<string> {
+        public:
+
+            bool normalize;
+            bool similarity;
+            string s;
+            PatternMatchVector pm;
+            BlockPatternMatchVector block_pm;
+
+            Cached(const string& s, bool normalize = true, bool similarity = false) :
+                normalize(normalize),
+                similarity(similarity),
+                s(s) {
+                if (s.size() <= 64) {
+                    pm.insert(s);
+                }
+                else {
+                    block_pm.insert(s);
                 }
-                return sim;
             }
-            else {
-                if (normalize) {
-                    dist = 2 * dist / (len + dist);
+
+            /**
+             * @brief Raw Levenshtein distance to `t`. See Levenshtein::levenshtein().
+             */
+            int levenshtein(const string& t, int max_dist = INT_MAX) const {
+                int m = s.size();
+                int n = t.size();
+
+                max_dist = min(max_dist, max(m, n));
+                if (abs(m - n) > max_dist) {
+                    return max_dist + 1;
+                }
+                if (m == 0) {
+                    return n;
+                }
+                if (max_dist == 0) {
+                    return (s == t) ? 0 : 1;
+                }
+
+                if (m <= 64) {
+                    return myers(pm, m, t, max_dist);
+                }
+                else {
+                    return myersBlock(block_pm, m, t, max_dist);
+                }
+            }
+
+            bool isSimilarity() const {
+                return similarity;
+            }
+
+            double compare(const string& t) const {
+                double len = s.size() + t.size();
+
+                if (len == 0) {
+                    return similarity;
+                }
+
+                return editScore(levenshtein(t), len, normalize, similarity);
+            }
+
+            double compare(const string& t, double cutoff) const {
+                int len = s.size() + t.size();
+
+                if (len == 0) {
+                    return similarity;
+                }
+
+                int max_dist = maxEditDistance(cutoff, len, normalize, similarity);
+                if (max_dist < 0) {
+                    return editScore(len, len, normalize, similarity);
+                }
+
+                int dist = levenshtein(t, max_dist);
+                if (dist > max_dist) {
+                    return editScore(len, len, normalize, similarity);
                 }
-                return dist;
+
+                return editScore(dist, len, normalize, similarity);
             }
+
+            /**
+             * @brief Comparisons with each of `count` strings. First strings of at most 64 characters use compareBatch().
+             */
+            void compareMany(const string* t, size_t count, double* out) const {
+                if (s.empty() || s.size() > 64) {
+                    CachedComparator<string>::compareMany(t, count, out);
+                    return;
+                }
+
+                compareBatch(pm, s, t, count, out, false, 0, normalize, similarity);
+            }
+
+            void compareMany(const string* t, size_t count, double* out, double cutoff) const {
+                if (s.empty() || s.size() > 64) {
+                    CachedComparator<string>::compareMany(t, count, out, cutoff);
+                    return;
+                }
+
+                compareBatch(pm, s, t, count, out, true, cutoff, normalize, similarity);
+            }
+
+            /**
+             * @brief Comparisons with each of `count` `string_view`s, such as the strings of a StringColumn. See
+             * compareMany().
+             */
+            void compareManyViews(const string_view* t, size_t count, double* out) const {
+                if (s.empty() || s.size() > 64) {
+                    CachedComparator<string>::compareManyViews(t, count, out);
+                    return;
+                }
+
+                compareBatch(pm, string_view(s), t, count, out, false, 0, normalize, similarity);
+            }
+
+            void compareManyViews(const string_view* t, size_t count, double* out, double cutoff) const {
+                if (s.empty() || s.size() > 64) {
+                    CachedComparator<string>::compareManyViews(t, count, out, cutoff);
+                    return;
+                }
+
+                compareBatch(pm, string_view(s), t, count, out, true, cutoff, normalize, similarity);
+            }
+        };
+
+        /**
+         * @brief Prepare one-to-many comparisons from a fixed first string.
+         */
+        Cached prepare(const string& s) const {
+            return Cached(s, normalize, similarity);
+        }
+
+    };
+
+    /**
+     * @brief Levenshtein comparator with compile-time normalization and similarity options. See Levenshtein.
+     */
+    template<bool normalize = true, bool similarity = false>
+    class StaticLevenshtein : public StaticComparator<StaticLevenshtein<normalize, similarity>, string> {
+    public:
+
+        static bool isSimilarity() {
+            return similarity;
+        }
+
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t) const {
+            double len = s.size() + t.size();
+            if (len == 0) {
+                return similarity;
+            }
+
+            return editScore<normalize, similarity>(Levenshtein::levenshtein(s, t), len);
+        }
+
+        /**
+         * @brief Comparison with a score cutoff. See Levenshtein::compareSequences().
+         */
+        template<class Sequence>
+        double compare(const Sequence& s, const Sequence& t, double cutoff) const {
+            int len = s.size() + t.size();
+            if (len == 0) {
+                return similarity;
+            }
+
+            int max_dist = maxEditDistance(cutoff, len, normalize, similarity);
+            if (max_dist < 0) {
+                return editScore<normalize, similarity>(len, len);
+            }
+
+            int dist = Levenshtein::levenshtein(s, t, max_dist);
+            if (dist > max_dist) {
+                return editScore<normalize, similarity>(len, len);
+            }
+
+            return editScore<normalize, similarity>(dist, len);
+        }
+
+        /**
+         * @brief Comparisons of `s` with each of `count` strings. See Levenshtein::compareMany().
+         */
+        void compareMany(const string& s, const string* t, size_t count, double* out) const {
+            if (s.empty() || s.size() > 64) {
+                StaticComparator<StaticLevenshtein, string>::compareMany(s, t, count, out);
+                return;
+            }
+
+            PatternMatchVector& pm = Levenshtein::workspace().pm;
+            pm.insert(s);
+            Levenshtein::compareBatch(pm, s, t, count, out, false, 0, normalize, similarity);
+            pm.clear(s);
+        }
+
+        void compareMany(const string& s, const string* t, size_t count, double* out, double cutoff) const {
+            if (s.empty() || s.size() > 64) {
+                StaticComparator<StaticLevenshtein, string>::compareMany(s, t, count, out, cutoff);
+                return;
+            }
+
+            PatternMatchVector& pm = Levenshtein::workspace().pm;
+            pm.insert(s);
+            Levenshtein::compareBatch(pm, s, t, count, out, true, cutoff, normalize, similarity);
+            pm.clear(s);
+        }
+
+        /**
+         * @brief Comparisons of `s` with each of `count` `string_view`s. See Levenshtein::compareManyViews().
+         */
+        void compareManyViews(string_view s, const string_view* t, size_t count, double* out) const {
+            if (s.empty() || s.size() > 64) {
+                StaticComparator<StaticLevenshtein, string>::compareManyViews(s, t, count, out);
+                return;
+            }
+
+            PatternMatchVector& pm = Levenshtein::workspace().pm;
+            pm.insert(s);
+            Levenshtein::compareBatch(pm, s, t, count, out, false, 0, normalize, similarity);
+            pm.clear(s);
+        }
+
+        void compareManyViews(string_view s, const string_view* t, size_t count, double* out, double cutoff) const {
+            if (s.empty() || s.size() > 64) {
+                StaticComparator<StaticLevenshtein, string>::compareManyViews(s, t, count, out, cutoff);
+                return;
+            }
+
+            PatternMatchVector& pm = Levenshtein::workspace().pm;
+            pm.insert(s);
+            Levenshtein::compareBatch(pm, s, t, count, out, true, cutoff, normalize, similarity);
+            pm.clear(s);
         }
 
     };
@@ -0,0 +1,54 @@
+/**
+ * @file overlap.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Compute overlap (Szymkiewicz-Simpson) distance between token sets [<a href="https://en.wikipedia.org/wiki/Overlap_coefficient">Wikipedia link</a>]
+ * @date 2022-04-24
+ * 
+ */
+
+#ifndef STRINGCOMPARE_DISTANCE_OVERLAP_HPP_INCLUDED
+#define STRINGCOMPARE_DISTANCE_OVERLAP_HPP_INCLUDED
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "tokencomparator.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Overlap distance between tokenized strings.
+     * 
+     */
+    class Overlap : public TokenComparator {
+    public:
+
+        /**
+         * @brief Construct a new Overlap object.
+         * 
+         * The similarity score is `|A ∩ B| / min(|A|, |B|)`, and the distance is 1 minus the similarity. Two token bags 
+         * have similarity 1 whenever one is contained in the other.
+         * 
+         * @param tokenizer Tokenizer object, such as WhitespaceTokenizer or NGramTokenizer.
+         * @param similarity Whether to return a similarity score rather than a distance. Defaults to false.
+         */
+        template<class T>
+        explicit Overlap(const T& tokenizer, bool similarity = false) :
+            TokenComparator(tokenizer, similarity) {}
+
+        double score(double intersection, double size_s, double size_t_) const {
+            if (size_s == 0 || size_t_ == 0) {
+                return (size_s == size_t_) ? 1.0 : 0.0;
+            }
+
+            return intersection / min(size_s, size_t_);
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_DISTANCE_OVERLAP_HPP_INCLUDED
@@ -0,0 +1,213 @@
+/**
+ * @file tokencomparator.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Base class for comparisons between token multisets.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_DISTANCE_TOKENCOMPARATOR_HPP_INCLUDED
+#define STRINGCOMPARE_DISTANCE_TOKENCOMPARATOR_HPP_INCLUDED
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "comparator.h"
+#include "../preprocessing/tokenizer.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Token multisets of a list of strings, with ids from a shared vocabulary.
+     *
+     * Profiles are compared to each other only if they share the same vocabulary.
+     */
+    struct TokenProfiles {
+        shared_ptr<Vocabulary> vocabulary;
+        IdCounterBatch counters;
+
+        size_t size() const {
+            return counters.size();
+        }
+    };
+
+    /**
+     * @brief Base class for comparators of token multisets.
+     *
+     * Subclasses define score() as a function of the intersection and sizes of two token multisets. Strings are
+     * tokenized on every comparison by compare(). Lists should instead be tokenized once with profiles(), and compared
+     * with the elementwise(), pairwise() and condensed() overloads for TokenProfiles.
+     */
+    class TokenComparator : public StringComparator {
+    public:
+
+        shared_ptr<const Tokenizer> tokenizer;
+        bool similarity;
+
+        /**
+         * @brief Construct a new TokenComparator object.
+         *
+         * @param tokenizer Tokenizer object, such as WhitespaceTokenizer or NGramTokenizer. It is copied.
+         * @param similarity Whether to return a similarity score rather than a distance. Defaults to false.
+         */
+        template<class T>
+        explicit TokenComparator(const T& tokenizer, bool similarity = false) :
+            tokenizer(make_shared<T>(tokenizer)),
+            similarity(similarity) {}
+
+        /**
+         * @brief Similarity between two multisets, given the size of their intersection and their sizes.
+         */
+        virtual double score(double intersection, double size_s, double size_t_) const = 0;
+
+        bool isSimilarity() const {
+            return similarity;
+        }
+
+        /**
+         * @brief Comparison between two token multisets, given as StringCounter, StringCounterView, IdCounter or
+         * IdCounterView objects.
+         */
+        template<class Counter>
+        double compareCounters(const Counter& s, const Counter& t) const {
+            double sim = score(s.intersectionCount(t), s.total(), t.total());
+            return similarity ? sim : 1.0 - sim;
+        }
+
+        using StringComparator::compare;
+        using StringComparator::compareViews;
+
+        double compare(const string& s, const string& t) const {
+            return compareCounters(tokenizer->tokenize(s), tokenizer->tokenize(t));
+        }
+
+        double compareViews(string_view s, string_view t) const {
+            return compareCounters(tokenizer->tokenize(s), tokenizer->tokenize(t));
+        }
+
+        /**
+         * @brief Comparisons of `s` with each of `count` strings, tokenizing `s` only once.
+         */
+        void compareMany(const string& s, const string* t, size_t count, double* out) const {
+            StringCounter counter = tokenizer->tokenize(s);
+            for (size_t i = 0; i < count; i++) {
+                out[i] = compareCounters(counter, tokenizer->tokenize(t[i]));
+            }
+        }
+
+        using StringComparator::compareMany;
+
+        /**
+         * @brief Comparisons of `s` with each of `count` `string_view`s, tokenizing `s` only once.
+         */
+        void compareManyViews(string_view s, const string_view* t, size_t count, double* out) const {
+            StringCounter counter = tokenizer->tokenize(s);
+            for (size_t i = 0; i < count; i++) {
+                out[i] = compareCounters(counter, tokenizer->tokenize(t[i]));
+            }
+        }
+
+        using StringComparator::compareManyViews;
+
+        /**
+         * @brief Tokenize a list of strings once, into profiles which can be compared any number of times.
+         *
+         * @param l List of strings.
+         * @param vocabulary Vocabulary to intern tokens into. Profiles of lists which are to be compared with each other
+         * should share the same vocabulary.
+         */
+        TokenProfiles profiles(const vector<string>& l, shared_ptr<Vocabulary> vocabulary = make_shared<Vocabulary>()) const {
+            TokenProfiles result;
+            result.vocabulary = vocabulary;
+            result.counters = tokenizer->batchTokenizeIds(l, *vocabulary);
+
+            return result;
+        }
+
+        /**
+         * @brief Tokenize the strings of a column once, into profiles. See profiles(const vector<string>&, shared_ptr<Vocabulary>).
+         */
+        template<class Offset>
+        TokenProfiles profiles(const BasicStringColumn<Offset>& l, shared_ptr<Vocabulary> vocabulary = make_shared<Vocabulary>()) const {
+            TokenProfiles result;
+            result.vocabulary = vocabulary;
+            result.counters = tokenizer->batchTokenizeIds(l, *vocabulary);
+
+            return result;
+        }
+
+        using StringComparator::elementwise;
+        using StringComparator::pairwise;
+        using StringComparator::condensed;
+
+        /**
+         * @brief Elementwise comparisons between profiles. See BatchComparator::elementwise().
+         */
+        vector<double> elementwise(const TokenProfiles& p1, const TokenProfiles& p2, int nthreads = 1) const {
+            checkVocabulary(p1, p2);
+            if (p1.size() != p2.size()) {
+                throw runtime_error("Lists should be of the same size.");
+            }
+
+            vector<double> result(p1.size());
+            size_t ntiles = (p1.size() + ELEMENTWISE_TILE - 1) / ELEMENTWISE_TILE;
+            parallelFor(ntiles, nthreads, [&](size_t tile) {
+                size_t end = min(p1.size(), (tile + 1) * ELEMENTWISE_TILE);
+                for (size_t i = tile * ELEMENTWISE_TILE; i < end; i++) {
+                    result[i] = compareCounters(p1.counters[i], p2.counters[i]);
+                }
+            });
+
+            return result;
+        }
+
+        /**
+         * @brief Pairwise comparisons between profiles. See BatchComparator::pairwise().
+         */
+        Mat<double> pairwise(const TokenProfiles& p1, const TokenProfiles& p2, int nthreads = 1) const {
+            checkVocabulary(p1, p2);
+            Mat<double> result(p1.size(), vector<double>(p2.size()));
+
+            forEachPair(p1.size(), p2.size(), false, nthreads, [&](size_t i, size_t j0, size_t j1) {
+                for (size_t j = j0; j < j1; j++) {
+                    result[i][j] = compareCounters(p1.counters[i], p2.counters[j]);
+                }
+            });
+
+            return result;
+        }
+
+        /**
+         * @brief Condensed pairwise comparisons between profiles. See BatchComparator::condensed().
+         */
+        vector<double> condensed(const TokenProfiles& p, int nthreads = 1) const {
+            size_t n = p.size();
+            vector<double> result(condensedSize(n));
+
+            forEachPair(n, n, true, nthreads, [&](size_t i, size_t j0, size_t j1) {
+                double* out = &result[condensedIndex(n, i, j0)];
+                for (size_t j = j0; j < j1; j++) {
+                    out[j - j0] = compareCounters(p.counters[i], p.counters[j]);
+                }
+            });
+
+            return result;
+        }
+
+    protected:
+
+        static void checkVocabulary(const TokenProfiles& p1, const TokenProfiles& p2) {
+            if (p1.vocabulary != p2.vocabulary) {
+                throw runtime_error("Profiles should share the same vocabulary.");
+            }
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_DISTANCE_TOKENCOMPARATOR_HPP_INCLUDED
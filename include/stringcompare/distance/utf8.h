@@ -0,0 +1,88 @@
+/**
+ * @file utf8.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Character-level comparison of UTF-8 strings.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_DISTANCE_UTF8_HPP_INCLUDED
+#define STRINGCOMPARE_DISTANCE_UTF8_HPP_INCLUDED
+
+#include <string>
+#include <string_view>
+
+#include "comparator.h"
+#include "../utils/unicode.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Comparison of UTF-8 strings by code points rather than bytes.
+     *
+     * Byte-level comparators count each byte of a multi-byte character as a character: "café" and "cafe" are at
+     * Levenshtein distance 2 rather than 1. This wrapper decodes both strings and runs the `compareSequences()` function
+     * of the wrapped comparator on their code points. ASCII strings are compared without decoding.
+     *
+     * @tparam C Comparator with a `compareSequences()` function, such as Levenshtein or JaroWinkler.
+     */
+    template<class C>
+    class Utf8Comparator : public StringComparator {
+    public:
+
+        C comparator;
+
+        explicit Utf8Comparator(const C& comparator = C()) :
+            comparator(comparator) {}
+
+        bool isSimilarity() const {
+            return comparator.isSimilarity();
+        }
+
+        double compare(const string& s, const string& t) const {
+            return withCodePoints(s, t, [&](const auto& a, const auto& b) {
+                return comparator.compareSequences(a, b);
+            });
+        }
+
+        double compareViews(string_view s, string_view t) const {
+            return withCodePoints(s, t, [&](const auto& a, const auto& b) {
+                return comparator.compareSequences(a, b);
+            });
+        }
+
+        /**
+         * @brief Comparison with a score cutoff, for wrapped comparators which support one.
+         */
+        double compare(const string& s, const string& t, double cutoff) const {
+            return withCodePoints(s, t, [&](const auto& a, const auto& b) {
+                return compareWithCutoff(a, b, cutoff, 0);
+            });
+        }
+
+        double compareViews(string_view s, string_view t, double cutoff) const {
+            return withCodePoints(s, t, [&](const auto& a, const auto& b) {
+                return compareWithCutoff(a, b, cutoff, 0);
+            });
+        }
+
+    private:
+
+        template<class Sequence>
+        auto compareWithCutoff(const Sequence& s, const Sequence& t, double cutoff, int) const
+            -> decltype(comparator.compareSequences(s, t, cutoff)) {
+            return comparator.compareSequences(s, t, cutoff);
+        }
+
+        template<class Sequence>
+        double compareWithCutoff(const Sequence& s, const Sequence& t, double cutoff, long) const {
+            return comparator.compareSequences(s, t);
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_DISTANCE_UTF8_HPP_INCLUDED
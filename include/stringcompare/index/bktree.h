@@ -0,0 +1,198 @@
+/**
+ * @file bktree.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Burkhard-Keller tree for range and nearest neighbor search under integer edit distances [<a href="https://en.wikipedia.org/wiki/BK-tree">Wikipedia link</a>]
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_INDEX_BKTREE_HPP_INCLUDED
+#define STRINGCOMPARE_INDEX_BKTREE_HPP_INCLUDED
+
+#include <limits.h>
+#include <math.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../distance/levenshtein.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Node of a BKTree: an indexed string and its children, keyed by their distance to it.
+     */
+    struct BKNode {
+        size_t id;
+        vector<pair<int, size_t>> children;
+    };
+
+    /**
+     * @brief Burkhard-Keller tree over an integer-valued metric.
+     *
+     * Each child subtree of a node holds the strings at a given distance `e` from the node. By the triangle inequality,
+     * strings within `k` of a query at distance `d` from the node can only be in the subtrees with `|e - d| <= k`. The
+     * distance to each node is computed with the cutoff `k + e_max`, where `e_max` is the largest child distance, so
+     * that bounded kernels stop as soon as no subtree can contain a match.
+     *
+     * @tparam C Comparator returning unnormalized distances, such as `Levenshtein(false)`. The distance should satisfy
+     * the triangle inequality: the optimal string alignment distance of DamerauLevenshtein does not, so that searches
+     * with it may miss some matches. Use `DamerauLevenshtein(false, false, 100, true)` for the unrestricted distance,
+     * which does.
+     */
+    template<class C = Levenshtein>
+    class BKTree {
+    public:
+
+        C comparator;
+        vector<string> strings;
+        vector<BKNode> nodes;
+
+        /**
+         * @brief Construct a new BKTree object.
+         *
+         * @param comparator Comparator object, returning unnormalized distances.
+         */
+        explicit BKTree(const C& comparator = C(false, false)) :
+            comparator(comparator) {
+            if (comparator.isSimilarity()) {
+                throw runtime_error("BKTree requires a distance rather than a similarity.");
+            }
+        }
+
+        /**
+         * @brief Index a string, which is given the next id (starting from 0).
+         */
+        size_t insert(const string& s) {
+            size_t id = strings.size();
+            strings.push_back(s);
+            nodes.push_back(BKNode{ id, {} });
+            if (id == 0) {
+                return id;
+            }
+
+            size_t node = 0;
+            while (true) {
+                int d = distance(s, strings[nodes[node].id]);
+                vector<pair<int, size_t>>& children = nodes[node].children;
+                auto it = lower_bound(children.begin(), children.end(), make_pair(d, size_t(0)));
+                if (it != children.end() && it->first == d) {
+                    node = it->second;
+                }
+                else {
+                    children.insert(it, make_pair(d, id));
+                    return id;
+                }
+            }
+        }
+
+        /**
+         * @brief Index all strings of a list, in order.
+         */
+        void insert(const vector<string>& l) {
+            for (const string& s : l) {
+                insert(s);
+            }
+        }
+
+        size_t size() const {
+            return strings.size();
+        }
+
+        /**
+         * @brief Strings within distance `k` of `query`, as (id, distance) pairs sorted by distance and then id.
+         */
+        vector<pair<size_t, double>> range(const string& query, int k) const {
+            vector<pair<size_t, double>> result;
+            if (nodes.empty() || k < 0) {
+                return result;
+            }
+
+            vector<size_t> stack = { 0 };
+            while (!stack.empty()) {
+                const BKNode& node = nodes[stack.back()];
+                stack.pop_back();
+
+                int e_max = node.children.empty() ? 0 : node.children.back().first;
+                int d = distance(query, strings[node.id], k + e_max);
+                if (d <= k) {
+                    result.emplace_back(node.id, d);
+                }
+                pushChildren(node, d, k, stack);
+            }
+            sort(result.begin(), result.end(), closer);
+
+            return result;
+        }
+
+        /**
+         * @brief The `n` strings closest to `query`, as (id, distance) pairs sorted by distance and then id.
+         *
+         * The search radius shrinks to the distance of the nth closest string found so far.
+         */
+        vector<pair<size_t, double>> nearest(const string& query, size_t n) const {
+            vector<pair<size_t, double>> best;
+            if (nodes.empty() || n == 0) {
+                return best;
+            }
+
+            int tau = INT_MAX / 2;
+            vector<size_t> stack = { 0 };
+            while (!stack.empty()) {
+                const BKNode& node = nodes[stack.back()];
+                stack.pop_back();
+
+                int e_max = node.children.empty() ? 0 : node.children.back().first;
+                int d = distance(query, strings[node.id], tau + e_max);
+                if (d <= tau) {
+                    pair<size_t, double> match(node.id, d);
+                    best.insert(upper_bound(best.begin(), best.end(), match, closer), match);
+                    if (best.size() > n) {
+                        best.pop_back();
+                    }
+                    if (best.size() == n) {
+                        tau = (int)best.back().second;
+                    }
+                }
+                pushChildren(node, d, tau, stack);
+            }
+
+            return best;
+        }
+
+    private:
+
+        static bool closer(const pair<size_t, double>& a, const pair<size_t, double>& b) {
+            return (a.second < b.second) || (a.second == b.second && a.first < b.first);
+        }
+
+        /**
+         * @brief Push the children of `node` at distance within `k` of `d`.
+         */
+        static void pushChildren(const BKNode& node, int d, int k, vector<size_t>& stack) {
+            auto it = lower_bound(node.children.begin(), node.children.end(), make_pair(d - k, size_t(0)));
+            for (; it != node.children.end() && it->first <= d + k; it++) {
+                stack.push_back(it->second);
+            }
+        }
+
+        int distance(const string& s, const string& t) const {
+            return (int)lround(comparator.compare(s, t));
+        }
+
+        /**
+         * @brief Distance, exact if it is at most `max_dist` and larger than `max_dist` otherwise.
+         */
+        int distance(const string& s, const string& t, int max_dist) const {
+            return (int)lround(comparator.compare(s, t, max_dist));
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_INDEX_BKTREE_HPP_INCLUDED
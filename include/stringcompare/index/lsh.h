@@ -0,0 +1,200 @@
+/**
+ * @file lsh.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Locality-sensitive hashing (LSH) banding index over MinHash signatures.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_INDEX_LSH_HPP_INCLUDED
+#define STRINGCOMPARE_INDEX_LSH_HPP_INCLUDED
+
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "minhash.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief LSH banding index for candidate pairs of high Jaccard similarity.
+     *
+     * Signatures are split in `bands` bands of `rows` values. Two signatures are candidates when they agree on all
+     * values of at least one band, which happens with probability `1 - (1 - J^rows)^bands` for strings of Jaccard
+     * similarity `J`. This is a steep function of `J`, with threshold about `(1 / bands)^(1 / rows)`.
+     *
+     * Candidates should be verified with exact comparisons, or with MinHash::estimate().
+     *
+     * @tparam T Type of signature values.
+     */
+    template<class T = uint32_t>
+    class LSHIndex {
+    public:
+
+        size_t bands;
+        size_t rows;
+        size_t count;
+        vector<unordered_map<uint64_t, vector<size_t>>> buckets;
+
+        /**
+         * @brief Construct a new LSHIndex object.
+         *
+         * @param bands Number of bands.
+         * @param rows Number of signature values per band. Signatures should have at least `bands * rows` values.
+         */
+        LSHIndex(size_t bands, size_t rows) :
+            bands(bands),
+            rows(rows),
+            count(0),
+            buckets(bands) {
+            if (bands == 0 || rows == 0) {
+                throw runtime_error("Number of bands and rows should be positive.");
+            }
+        }
+
+        /**
+         * @brief Index for signatures of length `num_perm`, with the number of bands and rows whose threshold
+         * `(1 / bands)^(1 / rows)` is closest to the given Jaccard similarity.
+         */
+        static LSHIndex forThreshold(size_t num_perm, double threshold) {
+            size_t best_bands = 1;
+            size_t best_rows = num_perm;
+            double best_gap = INFINITY;
+            for (size_t r = 1; r <= num_perm; r++) {
+                size_t b = num_perm / r;
+                double gap = fabs(pow(1.0 / b, 1.0 / r) - threshold);
+                if (gap < best_gap) {
+                    best_gap = gap;
+                    best_bands = b;
+                    best_rows = r;
+                }
+            }
+
+            return LSHIndex(best_bands, best_rows);
+        }
+
+        /**
+         * @brief Index a signature, which is given the next id (starting from 0).
+         *
+         * @param signature Signature of at least `bands * rows` values, such as returned by MinHash::signature().
+         */
+        size_t insert(const vector<T>& signature) {
+            checkLength(signature.size());
+            return insert(signature.data());
+        }
+
+        /**
+         * @brief Index all signatures of a list, in order.
+         */
+        void insert(const MinHashSignatures<T>& signatures) {
+            checkLength(signatures.num_perm);
+            for (size_t i = 0; i < signatures.size(); i++) {
+                insert(signatures[i]);
+            }
+        }
+
+        /**
+         * @brief Ids of the indexed signatures sharing at least one band with `signature`, in increasing order.
+         *
+         * @param signature Signature of at least `bands * rows` values.
+         */
+        vector<size_t> candidates(const vector<T>& signature) const {
+            checkLength(signature.size());
+            return candidates(signature.data());
+        }
+
+        /**
+         * @brief Ids of the indexed signatures sharing at least one band with the ith signature of a list, in increasing
+         * order.
+         */
+        vector<size_t> candidates(const MinHashSignatures<T>& signatures, size_t i) const {
+            checkLength(signatures.num_perm);
+            if (i >= signatures.size()) {
+                throw runtime_error("Signature index out of range.");
+            }
+            return candidates(signatures[i]);
+        }
+
+        /**
+         * @brief Pairs `(i, j)`, `i < j`, of indexed signatures sharing at least one band, in lexicographic order.
+         */
+        vector<pair<size_t, size_t>> candidatePairs() const {
+            vector<pair<size_t, size_t>> result;
+            for (size_t b = 0; b < bands; b++) {
+                for (const auto& bucket : buckets[b]) {
+                    const vector<size_t>& ids = bucket.second;
+                    for (size_t i = 0; i < ids.size(); i++) {
+                        for (size_t j = i + 1; j < ids.size(); j++) {
+                            result.emplace_back(ids[i], ids[j]);
+                        }
+                    }
+                }
+            }
+            sort(result.begin(), result.end());
+            result.erase(unique(result.begin(), result.end()), result.end());
+
+            return result;
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+    private:
+
+        /**
+         * @brief insert() of a signature whose length is already checked.
+         */
+        size_t insert(const T* signature) {
+            size_t id = count++;
+            for (size_t b = 0; b < bands; b++) {
+                buckets[b][bandHash(signature, b)].push_back(id);
+            }
+
+            return id;
+        }
+
+        /**
+         * @brief candidates() of a signature whose length is already checked.
+         */
+        vector<size_t> candidates(const T* signature) const {
+            vector<size_t> result;
+            for (size_t b = 0; b < bands; b++) {
+                auto it = buckets[b].find(bandHash(signature, b));
+                if (it != buckets[b].end()) {
+                    result.insert(result.end(), it->second.begin(), it->second.end());
+                }
+            }
+            sort(result.begin(), result.end());
+            result.erase(unique(result.begin(), result.end()), result.end());
+
+            return result;
+        }
+
+        uint64_t bandHash(const T* signature, size_t b) const {
+            uint64_t h = b;
+            for (size_t r = b * rows; r < (b + 1) * rows; r++) {
+                h = mix64(h ^ (uint64_t)signature[r]) + r;
+            }
+
+            return h;
+        }
+
+        void checkLength(size_t num_perm) const {
+            if (num_perm < bands * rows) {
+                throw runtime_error("Signatures should have at least bands * rows values.");
+            }
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_INDEX_LSH_HPP_INCLUDED
@@ -0,0 +1,157 @@
+/**
+ * @file minhash.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief MinHash signatures of token sets [<a href="https://en.wikipedia.org/wiki/MinHash">Wikipedia link</a>]
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_INDEX_MINHASH_HPP_INCLUDED
+#define STRINGCOMPARE_INDEX_MINHASH_HPP_INCLUDED
+
+#include <stdint.h>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../preprocessing/tokenizer.h"
+#include "../utils/hash.h"
+#include "../utils/parallel.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief MinHash signatures of a list of strings, stored contiguously.
+     *
+     * The signature of the ith string is `data[i * num_perm]` to `data[(i + 1) * num_perm - 1]`.
+     *
+     * @tparam T Type of signature values, `uint32_t` or `uint64_t`.
+     */
+    template<class T>
+    struct MinHashSignatures {
+        size_t num_perm = 0;
+        vector<T> data;
+
+        size_t size() const {
+            return num_perm ? data.size() / num_perm : 0;
+        }
+
+        const T* operator[](size_t i) const {
+            return &data[i * num_perm];
+        }
+    };
+
+    /**
+     * @brief MinHash signatures of tokenized strings.
+     *
+     * Each of the `num_perm` hash functions is a mix of the token hash with its own seed, and the signature holds the
+     * smallest value of each function over the token set. The fraction of equal signature values between two strings
+     * estimates the Jaccard similarity of their token sets (multiplicities are ignored).
+     *
+     * @tparam T Type of signature values. `uint32_t` halves memory use, at the cost of more spurious collisions.
+     */
+    template<class T = uint32_t>
+    class MinHash {
+    public:
+
+        shared_ptr<const Tokenizer> tokenizer;
+        size_t num_perm;
+        vector<uint64_t> seeds;
+
+        /**
+         * @brief Construct a new MinHash object.
+         *
+         * @param tokenizer Tokenizer object, such as NGramTokenizer. It is copied.
+         * @param num_perm Number of hash functions, which is the length of signatures.
+         * @param seed Seed of the hash functions. Signatures are only comparable between objects of the same seed.
+         */
+        template<class Tok>
+        MinHash(const Tok& tokenizer, size_t num_perm = 128, uint64_t seed = 1) :
+            tokenizer(make_shared<Tok>(tokenizer)),
+            num_perm(num_perm),
+            seeds(num_perm) {
+            if (num_perm == 0) {
+                throw runtime_error("Number of permutations should be positive.");
+            }
+            for (size_t i = 0; i < num_perm; i++) {
+                seeds[i] = mix64(seed * 0x9E3779B97F4A7C15ULL + i);
+            }
+        }
+
+        /**
+         * @brief Signature of a string, written to `out`.
+         *
+         * Strings without tokens have the largest value everywhere, so that they only match each other.
+         *
+         * @param s String to sketch.
+         * @param out Array of at least `num_perm` values.
+         */
+        void signature(string_view s, T* out) const {
+            for (size_t i = 0; i < num_perm; i++) {
+                out[i] = numeric_limits<T>::max();
+            }
+
+            for (string_view token : tokenizer->tokens(s)) {
+                uint64_t h = hashString(token);
+                for (size_t i = 0; i < num_perm; i++) {
+                    T value = static_cast<T>(mix64(h ^ seeds[i]));
+                    out[i] = (value < out[i]) ? value : out[i];
+                }
+            }
+        }
+
+        vector<T> signature(string_view s) const {
+            vector<T> result(num_perm);
+            signature(s, result.data());
+
+            return result;
+        }
+
+        /**
+         * @brief Signatures of a list of strings.
+         *
+         * @param l List of strings.
+         * @param nthreads Number of threads. Values smaller than 1 use all hardware threads. Defaults to 1.
+         */
+        MinHashSignatures<T> signatures(const vector<string>& l, int nthreads = 1) const {
+            MinHashSignatures<T> result;
+            result.num_perm = num_perm;
+            result.data.resize(l.size() * num_perm);
+
+            parallelFor(l.size(), nthreads, [&](size_t i) {
+                signature(l[i], &result.data[i * num_perm]);
+            });
+
+            return result;
+        }
+
+        /**
+         * @brief Estimated Jaccard similarity between two signatures of length `num_perm`.
+         */
+        static double estimate(const T* a, const T* b, size_t num_perm) {
+            size_t equal = 0;
+            for (size_t i = 0; i < num_perm; i++) {
+                equal += (a[i] == b[i]);
+            }
+
+            return (double)equal / num_perm;
+        }
+
+        double estimate(const vector<T>& a, const vector<T>& b) const {
+            if (a.size() != num_perm || b.size() != num_perm) {
+                throw runtime_error("Signatures should be of length num_perm.");
+            }
+
+            return estimate(a.data(), b.data(), num_perm);
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_INDEX_MINHASH_HPP_INCLUDED
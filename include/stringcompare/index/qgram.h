@@ -0,0 +1,342 @@
+/**
+ * @file qgram.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief q-gram inverted index for edit distance range search.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_INDEX_QGRAM_HPP_INCLUDED
+#define STRINGCOMPARE_INDEX_QGRAM_HPP_INCLUDED
+
+#include <stdint.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../distance/dameraulevenshtein.h"
+#include "../distance/levenshtein.h"
+#include "../preprocessing/tokenizer.h"
+#include "../utils/hash.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Entry of a q-gram posting list: a string id and the number of occurrences of the q-gram in the string.
+     */
+    struct QGramPosting {
+        uint32_t id;
+        uint32_t count;
+    };
+
+    /**
+     * @brief Inverted index from q-grams to the strings containing them, for edit distance range search.
+     *
+     * By the q-gram lemma, strings `s` and `t` within `k` edits share at least `max(|s|, |t|) - q + 1 - k * q` q-grams
+     * (counted with multiplicity), and their lengths differ by at most `k`. Queries count the q-grams shared with each
+     * indexed string through the posting lists of the query's q-grams, and only return strings which pass both filters.
+     * Strings too short for the count filter to apply are found through their length.
+     *
+     * q-grams are keyed by their 64 bits hash. Collisions can only add candidates, never lose one.
+     *
+     * Strings can be inserted and removed at any time. Removed strings are freed and marked as removed, and queries skip
+     * their entries in posting lists and length lists. These stale entries are dropped by compact(), which runs once
+     * they make up half of all entries, so that a removal takes amortized time linear in the length of the string
+     * rather than in the length of posting lists. Queries are const and can run concurrently, but not while the index
+     * is modified.
+     */
+    class QGramIndex {
+    public:
+
+        NGramTokenizer tokenizer;
+        int q;
+        vector<string> strings;
+        vector<bool> alive;
+        size_t count;
+        unordered_map<uint64_t, vector<QGramPosting>> postings;
+        vector<vector<uint32_t>> by_length;
+        size_t entries;
+        size_t stale_entries;
+
+        /**
+         * @brief Construct a new QGramIndex object.
+         *
+         * @param q Length of q-grams. Smaller values filter less but apply to shorter strings and larger thresholds.
+         */
+        explicit QGramIndex(int q = 2) :
+            tokenizer(q),
+            q(q),
+            count(0),
+            entries(0),
+            stale_entries(0) {
+            if (q <= 0) {
+                throw runtime_error("q should be positive.");
+            }
+        }
+
+        /**
+         * @brief Index a string, which is given the next id (starting from 0).
+         */
+        size_t insert(const string& s) {
+            size_t id = strings.size();
+            strings.push_back(s);
+            alive.push_back(true);
+            count++;
+
+            vector<pair<uint64_t, uint32_t>> g = grams(s);
+            for (const auto& gram : g) {
+                postings[gram.first].push_back(QGramPosting{ (uint32_t)id, gram.second });
+            }
+            if (by_length.size() <= s.size()) {
+                by_length.resize(s.size() + 1);
+            }
+            by_length[s.size()].push_back(id);
+            entries += g.size() + 1;
+
+            return id;
+        }
+
+        /**
+         * @brief Index all strings of a list, in order.
+         */
+        void insert(const vector<string>& l) {
+            for (const string& s : l) {
+                insert(s);
+            }
+        }
+
+        /**
+         * @brief Remove the string of a given id from the index. Ids of other strings are unchanged.
+         *
+         * The string is freed, and its entries in posting lists become stale until the next compact().
+         */
+        void remove(size_t id) {
+            if (id >= strings.size() || !alive[id]) {
+                throw runtime_error("Id is not in the index.");
+            }
+
+            stale_entries += grams(strings[id]).size() + 1;
+            string().swap(strings[id]);
+            alive[id] = false;
+            count--;
+
+            if (2 * stale_entries > entries) {
+                compact();
+            }
+        }
+
+        /**
+         * @brief Drop the entries of removed strings from posting lists and length lists.
+         *
+         * This runs automatically once stale entries make up half of all entries.
+         */
+        void compact() {
+            auto removed = [&](uint32_t id) {
+                return !alive[id];
+            };
+
+            for (auto it = postings.begin(); it != postings.end();) {
+                vector<QGramPosting>& list = it->second;
+                list.erase(remove_if(list.begin(), list.end(), [&](const QGramPosting& posting) {
+                    return removed(posting.id);
+                }), list.end());
+                if (list.empty()) {
+                    it = postings.erase(it);
+                }
+                else {
+                    list.shrink_to_fit();
+                    it++;
+                }
+            }
+            for (vector<uint32_t>& ids : by_length) {
+                ids.erase(remove_if(ids.begin(), ids.end(), removed), ids.end());
+            }
+
+            entries -= stale_entries;
+            stale_entries = 0;
+        }
+
+        bool contains(size_t id) const {
+            return id < strings.size() && alive[id];
+        }
+
+        /**
+         * @brief String of a given id.
+         */
+        const string& get(size_t id) const {
+            if (!contains(id)) {
+                throw runtime_error("Id is not in the index.");
+            }
+
+            return strings[id];
+        }
+
+        /**
+         * @brief Number of strings in the index.
+         */
+        size_t size() const {
+            return count;
+        }
+
+        /**
+         * @brief Ids of the strings which may be within `k` edits of `query`, in increasing order.
+         *
+         * @param query String to search for.
+         * @param k Edit distance threshold.
+         * @param transpositions Whether edits include transpositions of adjacent characters, as for the optimal string
+         * alignment distance of DamerauLevenshtein. A transposition changes up to `q + 1` q-grams rather than `q`.
+         */
+        vector<size_t> candidates(const string& query, int k, bool transpositions = false) const {
+            vector<size_t> result;
+            if (k < 0 || by_length.empty()) {
+                return result;
+            }
+
+            int m = query.size();
+            int per_edit = transpositions ? q + 1 : q;
+            size_t lo = max(0, m - k);
+            size_t hi = min((size_t)m + k, by_length.size() - 1);
+
+            // Lengths for which the count filter does not apply.
+            bool counting = false;
+            for (size_t len = lo; len <= hi; len++) {
+                if (minShared(m, len, k, per_edit) <= 0) {
+                    for (uint32_t id : by_length[len]) {
+                        if (alive[id]) {
+                            result.push_back(id);
+                        }
+                    }
+                }
+                else {
+                    counting = true;
+                }
+            }
+
+            if (counting) {
+                vector<uint32_t>& shared = sharedBuffer();
+                vector<uint32_t>& touched = touchedBuffer();
+                if (shared.size() < strings.size()) {
+                    shared.resize(strings.size(), 0);
+                }
+
+                for (const auto& gram : grams(query)) {
+                    auto it = postings.find(gram.first);
+                    if (it == postings.end()) {
+                        continue;
+                    }
+                    for (const QGramPosting& posting : it->second) {
+                        if (!alive[posting.id]) {
+                            continue;
+                        }
+                        if (shared[posting.id] == 0) {
+                            touched.push_back(posting.id);
+                        }
+                        shared[posting.id] += min(gram.second, posting.count);
+                    }
+                }
+
+                for (uint32_t id : touched) {
+                    size_t len = strings[id].size();
+                    int bound = minShared(m, len, k, per_edit);
+                    if (len >= lo && len <= hi && bound > 0 && (int)shared[id] >= bound) {
+                        result.push_back(id);
+                    }
+                    shared[id] = 0;
+                }
+                touched.clear();
+            }
+
+            sort(result.begin(), result.end());
+
+            return result;
+        }
+
+        /**
+         * @brief Strings within `k` Levenshtein edits of `query`, as (id, distance) pairs in increasing order of id.
+         *
+         * Candidates are verified with the banded Levenshtein kernel, which stops beyond `k` edits.
+         */
+        vector<pair<size_t, int>> search(const string& query, int k) const {
+            vector<pair<size_t, int>> result;
+            for (size_t id : candidates(query, k)) {
+                int dist = Levenshtein::levenshtein(query, strings[id], k);
+                if (dist <= k) {
+                    result.emplace_back(id, dist);
+                }
+            }
+
+            return result;
+        }
+
+        /**
+         * @brief Strings within `k` Damerau-Levenshtein (optimal string alignment) edits of `query`. See search().
+         */
+        vector<pair<size_t, int>> searchDamerau(const string& query, int k) const {
+            vector<pair<size_t, int>> result;
+            for (size_t id : candidates(query, k, true)) {
+                int dist = DamerauLevenshtein::dameraulevenshtein(query, strings[id], k);
+                if (dist <= k) {
+                    result.emplace_back(id, dist);
+                }
+            }
+
+            return result;
+        }
+
+    private:
+
+        /**
+         * @brief Least number of q-grams shared by strings of lengths `m` and `n` within `k` edits.
+         */
+        int minShared(int m, int n, int k, int per_edit) const {
+            return max(m, n) - q + 1 - k * per_edit;
+        }
+
+        /**
+         * @brief Distinct q-gram hashes of a string, with their number of occurrences.
+         */
+        vector<pair<uint64_t, uint32_t>> grams(string_view s) const {
+            vector<pair<uint64_t, uint32_t>> result;
+            for (string_view gram : tokenizer.tokens(s)) {
+                result.emplace_back(hashString(gram), 1);
+            }
+            sort(result.begin(), result.end());
+
+            size_t k = 0;
+            for (size_t i = 0; i < result.size(); i++) {
+                if (k > 0 && result[k - 1].first == result[i].first) {
+                    result[k - 1].second++;
+                }
+                else {
+                    result[k++] = result[i];
+                }
+            }
+            result.resize(k);
+
+            return result;
+        }
+
+        /**
+         * @brief Shared q-gram counts of the calling thread, indexed by id and left zeroed between queries.
+         */
+        static vector<uint32_t>& sharedBuffer() {
+            static thread_local vector<uint32_t> shared;
+            return shared;
+        }
+
+        static vector<uint32_t>& touchedBuffer() {
+            static thread_local vector<uint32_t> touched;
+            return touched;
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_INDEX_QGRAM_HPP_INCLUDED
@@ -0,0 +1,213 @@
+/**
+ * @file vptree.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Vantage-point tree for range and nearest neighbor search under normalized distances [<a href="https://en.wikipedia.org/wiki/Vantage-point_tree">Wikipedia link</a>]
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_INDEX_VPTREE_HPP_INCLUDED
+#define STRINGCOMPARE_INDEX_VPTREE_HPP_INCLUDED
+
+#include <math.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../distance/levenshtein.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Node of a VPTree: a vantage point, the median distance `mu` of its subtree to it, and the subtrees of
+     * strings closer (inside) and farther (outside) than `mu`. Missing subtrees are -1.
+     */
+    struct VPNode {
+        size_t id;
+        double mu;
+        long inside;
+        long outside;
+    };
+
+    /**
+     * @brief Vantage-point tree over a real-valued metric.
+     *
+     * Each node splits the strings of its subtree at their median distance `mu` to the vantage point. By the triangle
+     * inequality, strings within `r` of a query at distance `d` from the vantage point can only be inside if
+     * `d <= mu + r`, and outside if `d >= mu - r`. The distance to each vantage point is computed with the cutoff
+     * `mu + r`, beyond which its exact value is not needed.
+     *
+     * The tree is built at once from a list of strings, with `O(n log n)` comparisons.
+     *
+     * @tparam C Comparator returning distances which satisfy the triangle inequality. The normalized Levenshtein distance
+     * `2 * dist / (|s| + |t| + dist)` of the default `Levenshtein()` comparator is a metric.
+     */
+    template<class C = Levenshtein>
+    class VPTree {
+    public:
+
+        C comparator;
+        vector<string> strings;
+        vector<VPNode> nodes;
+
+        /**
+         * @brief Construct a new VPTree object.
+         *
+         * @param l List of strings to index. Ids are positions in the list.
+         * @param comparator Comparator object, returning distances.
+         */
+        explicit VPTree(const vector<string>& l, const C& comparator = C()) :
+            comparator(comparator),
+            strings(l) {
+            if (comparator.isSimilarity()) {
+                throw runtime_error("VPTree requires a distance rather than a similarity.");
+            }
+
+            vector<pair<double, size_t>> items(l.size());
+            for (size_t i = 0; i < l.size(); i++) {
+                items[i] = make_pair(0.0, i);
+            }
+            nodes.reserve(l.size());
+            build(items, 0, items.size());
+        }
+
+        size_t size() const {
+            return strings.size();
+        }
+
+        /**
+         * @brief Strings within distance `r` of `query`, as (id, distance) pairs sorted by distance and then id.
+         */
+        vector<pair<size_t, double>> range(const string& query, double r) const {
+            vector<pair<size_t, double>> result;
+            if (nodes.empty() || r < 0) {
+                return result;
+            }
+
+            vector<long> stack = { 0 };
+            while (!stack.empty()) {
+                const VPNode& node = nodes[stack.back()];
+                stack.pop_back();
+
+                double d = comparator.compare(query, strings[node.id], node.mu + r);
+                if (d <= r) {
+                    result.emplace_back(node.id, d);
+                }
+                pushChildren(node, d, r, stack);
+            }
+            sort(result.begin(), result.end(), closer);
+
+            return result;
+        }
+
+        /**
+         * @brief The `n` strings closest to `query`, as (id, distance) pairs sorted by distance and then id.
+         *
+         * The search radius shrinks to the distance of the nth closest string found so far, and the subtree on the side
+         * of the query is searched first.
+         */
+        vector<pair<size_t, double>> nearest(const string& query, size_t n) const {
+            vector<pair<size_t, double>> best;
+            if (nodes.empty() || n == 0) {
+                return best;
+            }
+
+            double tau = INFINITY;
+            vector<long> stack = { 0 };
+            while (!stack.empty()) {
+                const VPNode& node = nodes[stack.back()];
+                stack.pop_back();
+
+                double d = comparator.compare(query, strings[node.id], node.mu + tau);
+                if (d <= tau) {
+                    pair<size_t, double> match(node.id, d);
+                    best.insert(upper_bound(best.begin(), best.end(), match, closer), match);
+                    if (best.size() > n) {
+                        best.pop_back();
+                    }
+                    if (best.size() == n) {
+                        tau = best.back().second;
+                    }
+                }
+                pushChildren(node, d, tau, stack);
+            }
+
+            return best;
+        }
+
+    private:
+
+        static bool closer(const pair<size_t, double>& a, const pair<size_t, double>& b) {
+            return (a.second < b.second) || (a.second == b.second && a.first < b.first);
+        }
+
+        /**
+         * @brief Push the subtrees of `node` which may hold strings within `r` of a query at distance `d`. The subtree
+         * on the side of the query is pushed last, so that it is searched first.
+         */
+        static void pushChildren(const VPNode& node, double d, double r, vector<long>& stack) {
+            bool inside = (node.inside >= 0 && d <= node.mu + r);
+            bool outside = (node.outside >= 0 && d >= node.mu - r);
+            if (d <= node.mu) {
+                if (outside) {
+                    stack.push_back(node.outside);
+                }
+                if (inside) {
+                    stack.push_back(node.inside);
+                }
+            }
+            else {
+                if (inside) {
+                    stack.push_back(node.inside);
+                }
+                if (outside) {
+                    stack.push_back(node.outside);
+                }
+            }
+        }
+
+        /**
+         * @brief Build the subtree of `items[begin:end]` and return the index of its root, or -1 if it is empty.
+         */
+        long build(vector<pair<double, size_t>>& items, size_t begin, size_t end) {
+            if (begin == end) {
+                return -1;
+            }
+
+            long index = nodes.size();
+            size_t vp = items[begin].second;
+            nodes.push_back(VPNode{ vp, 0.0, -1, -1 });
+            if (end - begin == 1) {
+                return index;
+            }
+
+            for (size_t i = begin + 1; i < end; i++) {
+                items[i].first = comparator.compare(strings[vp], strings[items[i].second]);
+            }
+
+            // Strings at distance at most mu go inside.
+            size_t median = begin + 1 + (end - begin - 1) / 2;
+            nth_element(items.begin() + begin + 1, items.begin() + median, items.begin() + end);
+            double mu = items[median].first;
+            auto split = partition(items.begin() + begin + 1, items.begin() + end,
+                [&](const pair<double, size_t>& item) { return item.first <= mu; });
+            size_t middle = split - items.begin();
+
+            nodes[index].mu = mu;
+            long inside = build(items, begin + 1, middle);
+            long outside = build(items, middle, end);
+            nodes[index].inside = inside;
+            nodes[index].outside = outside;
+
+            return index;
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_INDEX_VPTREE_HPP_INCLUDED
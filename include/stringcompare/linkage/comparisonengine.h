@@ -0,0 +1,271 @@
+/**
+ * @file comparisonengine.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Field by field comparison vectors of record pairs, for record linkage.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_LINKAGE_COMPARISONENGINE_HPP_INCLUDED
+#define STRINGCOMPARE_LINKAGE_COMPARISONENGINE_HPP_INCLUDED
+
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../distance/comparator.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Table of records stored by column: `columns[f][i]` is field `f` of record `i`.
+     */
+    typedef vector<vector<string>> RecordTable;
+
+    /**
+     * @brief Table of records stored by column, with columns in the Apache Arrow layout. See StringColumn.
+     */
+    typedef vector<StringColumn> ColumnTable;
+
+    /**
+     * @brief Comparison of one field of record pairs.
+     *
+     * Comparison values are discretized into agreement levels by `thresholds`: the level is the number of thresholds
+     * reached, where similarities reach thresholds they are at least equal to and distances reach thresholds they are
+     * at most equal to. Pairs with a missing (empty) value have level 0 and comparison value NaN.
+     */
+    struct FieldComparison {
+        size_t left_column;
+        size_t right_column;
+        shared_ptr<const StringComparator> comparator;
+        vector<double> thresholds;
+
+        /**
+         * @brief Agreement level of a comparison value.
+         */
+        uint8_t level(double value) const {
+            if (isnan(value)) {
+                return 0;
+            }
+
+            uint8_t result = 1;
+            for (double threshold : thresholds) {
+                if (comparator->isSimilarity() ? (value >= threshold) : (value <= threshold)) {
+                    result++;
+                }
+            }
+
+            return result;
+        }
+    };
+
+    /**
+     * @brief Comparison vectors of record pairs, with one comparator per field.
+     *
+     * All fields of all pairs are compared in a single pass over tiles of pairs, which are shared between threads. Within
+     * a tile, pairs are grouped by left record, and each field compares the value of a left record to the values of all
+     * of its right records with a single Comparator::compareManyViews() call. Comparators with batch kernels,
+     * such as Levenshtein, thus prepare the left value once, and each comparator's code and scratch space stay hot.
+     *
+     * Agreement levels only depend on the thresholds reached, so that levels() passes the first threshold of each field
+     * to comparisons as a score cutoff. Comparators with cutoff kernels then stop early on pairs which do not reach it.
+     *
+     * Tables are either RecordTable or ColumnTable objects, whose strings are read in place.
+     *
+     * Outputs are row-major matrices with one row per pair and one column per field, either of comparison values or of
+     * `uint8_t` agreement levels.
+     */
+    class ComparisonEngine {
+    public:
+
+        vector<FieldComparison> fields;
+
+        ComparisonEngine() {}
+
+        /**
+         * @brief Add a field comparison.
+         *
+         * @param left_column Column of the field in the left table.
+         * @param right_column Column of the field in the right table.
+         * @param comparator Comparator object, such as `JaroWinkler(true)` or `Levenshtein()`. It is copied.
+         * @param thresholds Thresholds of agreement levels, in increasing order of agreement. Comparison values reaching
+         * `k` of them have level `k + 1`.
+         */
+        template<class C>
+        ComparisonEngine& add(size_t left_column, size_t right_column, const C& comparator, const vector<double>& thresholds = {}) {
+            if (thresholds.size() > 254) {
+                throw runtime_error("At most 254 thresholds are supported.");
+            }
+            fields.push_back(FieldComparison{ left_column, right_column, make_shared<C>(comparator), thresholds });
+
+            return *this;
+        }
+
+        size_t size() const {
+            return fields.size();
+        }
+
+        /**
+         * @brief Comparison vectors of record pairs.
+         *
+         * @param left Left table of records, a RecordTable or a ColumnTable.
+         * @param right Right table of records. Pass the same table twice for deduplication.
+         * @param pairs Pairs (i, j) of a left record index and a right record index.
+         * @param nthreads Number of threads. Values smaller than 1 use all hardware threads. Defaults to 1.
+         * @return vector<double> Matrix of `pairs.size()` rows and size() columns, in row-major order.
+         */
+        template<class Table>
+        vector<double> compare(const Table& left, const Table& right, const vector<pair<size_t, size_t>>& pairs, int nthreads = 1) const {
+            vector<double> result(pairs.size() * fields.size());
+            compare(left, right, pairs, result.data(), nthreads);
+
+            return result;
+        }
+
+        /**
+         * @brief Comparison vectors written to a caller-provided row-major buffer of at least `pairs.size() * size()`
+         * elements.
+         */
+        template<class Table>
+        void compare(const Table& left, const Table& right, const vector<pair<size_t, size_t>>& pairs, double* out, int nthreads = 1) const {
+            forEachField(left, right, pairs, false, nthreads, [&](size_t p, size_t f, double value) {
+                out[p * fields.size() + f] = value;
+            });
+        }
+
+        /**
+         * @brief Agreement levels of record pairs. See FieldComparison::level().
+         *
+         * @return vector<uint8_t> Matrix of `pairs.size()` rows and size() columns, in row-major order.
+         */
+        template<class Table>
+        vector<uint8_t> levels(const Table& left, const Table& right, const vector<pair<size_t, size_t>>& pairs, int nthreads = 1) const {
+            vector<uint8_t> result(pairs.size() * fields.size());
+            levels(left, right, pairs, result.data(), nthreads);
+
+            return result;
+        }
+
+        /**
+         * @brief Agreement levels written to a caller-provided row-major buffer of at least `pairs.size() * size()`
+         * elements.
+         */
+        template<class Table>
+        void levels(const Table& left, const Table& right, const vector<pair<size_t, size_t>>& pairs, uint8_t* out, int nthreads = 1) const {
+            forEachField(left, right, pairs, true, nthreads, [&](size_t p, size_t f, double value) {
+                out[p * fields.size() + f] = fields[f].level(value);
+            });
+        }
+
+    private:
+
+        /**
+         * @brief Call `f(p, field, value)` for the comparison value of every pair and field, in parallel over tiles of
+         * pairs.
+         *
+         * @param cutoffs Whether to use the first threshold of fields as a score cutoff. Values which do not reach it are
+         * then only known to have level 1.
+         */
+        template<class Table, class F>
+        void forEachField(const Table& left, const Table& right, const vector<pair<size_t, size_t>>& pairs, bool cutoffs,
+            int nthreads, const F& f) const {
+            size_t n_left = checkTable(left, true);
+            size_t n_right = checkTable(right, false);
+            for (const auto& p : pairs) {
+                if (p.first >= n_left || p.second >= n_right) {
+                    throw runtime_error("Record pair index out of range.");
+                }
+            }
+
+            size_t ntiles = (pairs.size() + ELEMENTWISE_TILE - 1) / ELEMENTWISE_TILE;
+            parallelFor(ntiles, nthreads, [&](size_t tile) {
+                size_t begin = tile * ELEMENTWISE_TILE;
+                size_t end = min(pairs.size(), begin + ELEMENTWISE_TILE);
+
+                vector<size_t> order(end - begin);
+                iota(order.begin(), order.end(), begin);
+                stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                    return pairs[a].first < pairs[b].first;
+                });
+
+                vector<string_view> views;
+                vector<size_t> batch;
+                vector<double> values;
+                for (size_t k = 0; k < fields.size(); k++) {
+                    const FieldComparison& field = fields[k];
+                    const auto& l = left[field.left_column];
+                    const auto& r = right[field.right_column];
+                    bool has_cutoff = cutoffs && !field.thresholds.empty();
+
+                    size_t g1;
+                    for (size_t g0 = 0; g0 < order.size(); g0 = g1) {
+                        size_t i = pairs[order[g0]].first;
+                        string_view s = l[i];
+
+                        views.clear();
+                        batch.clear();
+                        for (g1 = g0; g1 < order.size() && pairs[order[g1]].first == i; g1++) {
+                            size_t p = order[g1];
+                            string_view t = r[pairs[p].second];
+                            if (s.empty() || t.empty()) {
+                                f(p, k, NAN);
+                            }
+                            else {
+                                views.push_back(t);
+                                batch.push_back(p);
+                            }
+                        }
+                        if (batch.empty()) {
+                            continue;
+                        }
+
+                        values.resize(batch.size());
+                        if (has_cutoff) {
+                            field.comparator->compareManyViews(s, views.data(), views.size(), values.data(), field.thresholds[0]);
+                        }
+                        else {
+                            field.comparator->compareManyViews(s, views.data(), views.size(), values.data());
+                        }
+                        for (size_t j = 0; j < batch.size(); j++) {
+                            f(batch[j], k, values[j]);
+                        }
+                    }
+                }
+            });
+        }
+
+        /**
+         * @brief Check that a table has the columns used by the fields and that they are of equal length, which is
+         * returned.
+         */
+        template<class Table>
+        size_t checkTable(const Table& table, bool is_left) const {
+            size_t n = table.empty() ? 0 : table[0].size();
+            for (const auto& column : table) {
+                if (column.size() != n) {
+                    throw runtime_error("Columns should be of the same size.");
+                }
+            }
+            for (const auto& field : fields) {
+                if ((is_left ? field.left_column : field.right_column) >= table.size()) {
+                    throw runtime_error("Field column out of range.");
+                }
+            }
+
+            return n;
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_LINKAGE_COMPARISONENGINE_HPP_INCLUDED
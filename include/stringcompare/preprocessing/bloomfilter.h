@@ -0,0 +1,201 @@
+/**
+ * @file bloomfilter.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Bloom filter encodings of tokenized strings, such as cryptographic long-term keys (CLK).
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_PREPROCESSING_BLOOMFILTER_HPP_INCLUDED
+#define STRINGCOMPARE_PREPROCESSING_BLOOMFILTER_HPP_INCLUDED
+
+#include <stdint.h>
+#include <string.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tokenizer.h"
+#include "../utils/hash.h"
+#include "../utils/parallel.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Bloom filters of `num_bits` bits, packed in 64 bits words and stored contiguously.
+     *
+     * The filter of the ith string is `data[i * words]` to `data[(i + 1) * words - 1]`. Bits past `num_bits` in the last
+     * word are zero.
+     */
+    struct BloomFilters {
+        size_t num_bits = 0;
+        size_t words = 0;
+        vector<uint64_t> data;
+
+        BloomFilters() {}
+
+        /**
+         * @brief `count` empty filters of `num_bits` bits.
+         */
+        explicit BloomFilters(size_t num_bits, size_t count = 0) :
+            num_bits(num_bits),
+            words((num_bits + 63) / 64),
+            data(count * words, 0) {}
+
+        size_t size() const {
+            return words ? data.size() / words : 0;
+        }
+
+        const uint64_t* operator[](size_t i) const {
+            return &data[i * words];
+        }
+
+        uint64_t* operator[](size_t i) {
+            return &data[i * words];
+        }
+
+        /**
+         * @brief Filters received as packed bytes, such as base64-decoded CLKs.
+         *
+         * Each filter is `(num_bits + 7) / 8` consecutive bytes. Bytes are copied as is, so that bits are permuted
+         * within words compared to their order in the input. This does not affect the comparisons of BloomComparator,
+         * which only count bits.
+         *
+         * @param bytes Array of `count * ((num_bits + 7) / 8)` bytes.
+         * @param count Number of filters.
+         * @param num_bits Number of bits of each filter.
+         */
+        static BloomFilters fromBytes(const uint8_t* bytes, size_t count, size_t num_bits) {
+            BloomFilters result(num_bits, count);
+            size_t nbytes = (num_bits + 7) / 8;
+            for (size_t i = 0; i < count; i++) {
+                uint64_t* filter = result[i];
+                memcpy(filter, bytes + i * nbytes, nbytes);
+                // Zero any bits past num_bits in the last byte, which are copied at the start of its word.
+                if (num_bits % 8 != 0) {
+                    uint8_t* last = (uint8_t*)filter + nbytes - 1;
+                    *last &= (uint8_t)((1u << (num_bits % 8)) - 1);
+                }
+            }
+
+            return result;
+        }
+    };
+
+    /**
+     * @brief Bloom filter encoder of tokenized strings.
+     *
+     * Each token sets `num_hashes` bits of the filter, at positions `(h1 + i * h2) mod num_bits` given by two keyed
+     * 64 bits hashes of the token (double hashing, as in the cryptographic long-term keys of Schnell et al., 2011).
+     * Token multiplicities are ignored. With `NGramTokenizer(2)`, similar strings share most of their bigrams and
+     * therefore most of their bits.
+     *
+     * The hashes are keyed mixes of hashString(), which are fast but not cryptographic: filters encoded here are not
+     * private. Filters produced by a cryptographic encoder can be loaded with BloomFilters::fromBytes() and compared
+     * in the same way.
+     */
+    class BloomEncoder {
+    public:
+
+        shared_ptr<const Tokenizer> tokenizer;
+        size_t num_bits;
+        int num_hashes;
+        uint64_t key;
+
+        /**
+         * @brief Encoder of bigrams into 1024 bits filters, with 20 bits per bigram.
+         */
+        BloomEncoder() :
+            BloomEncoder(NGramTokenizer(2)) {}
+
+        /**
+         * @brief Construct a new BloomEncoder object.
+         *
+         * @param tokenizer Tokenizer object, such as NGramTokenizer. It is copied.
+         * @param num_bits Number of bits of the filters.
+         * @param num_hashes Number of bits set by each token.
+         * @param key Key of the hash functions. Filters are only comparable between encoders of the same key.
+         */
+        template<class T>
+        explicit BloomEncoder(const T& tokenizer, size_t num_bits = 1024, int num_hashes = 20, uint64_t key = 0) :
+            tokenizer(make_shared<T>(tokenizer)),
+            num_bits(num_bits),
+            num_hashes(num_hashes),
+            key(key) {
+            if (num_bits == 0 || num_hashes <= 0) {
+                throw runtime_error("Number of bits and of hashes should be positive.");
+            }
+        }
+
+        size_t words() const {
+            return (num_bits + 63) / 64;
+        }
+
+        /**
+         * @brief Filter of a string, written to `out`.
+         *
+         * @param s String to encode.
+         * @param out Array of at least words() words.
+         */
+        void encode(string_view s, uint64_t* out) const {
+            for (size_t k = 0; k < words(); k++) {
+                out[k] = 0;
+            }
+
+            vector<string_view>& buffer = tokenBuffer();
+            buffer.clear();
+            tokenizer->appendTokens(s, buffer);
+            uint64_t seed = mix64(key);
+            for (string_view token : buffer) {
+                uint64_t h1 = mix64(hashString(token) ^ seed);
+                uint64_t h2 = mix64(h1 ^ 0x9E3779B97F4A7C15ULL);
+                for (int i = 0; i < num_hashes; i++) {
+                    uint64_t bit = (h1 + i * h2) % num_bits;
+                    out[bit / 64] |= uint64_t(1) << (bit % 64);
+                }
+            }
+        }
+
+        vector<uint64_t> encode(string_view s) const {
+            vector<uint64_t> result(words());
+            encode(s, result.data());
+
+            return result;
+        }
+
+        /**
+         * @brief Filters of a list of strings, or of a StringColumn.
+         *
+         * @param l List of strings.
+         * @param nthreads Number of threads. Values smaller than 1 use all hardware threads. Defaults to 1.
+         */
+        template<class List>
+        BloomFilters encodeMany(const List& l, int nthreads = 1) const {
+            BloomFilters result(num_bits, l.size());
+
+            parallelFor(l.size(), nthreads, [&](size_t i) {
+                encode(l[i], result[i]);
+            });
+
+            return result;
+        }
+
+    private:
+
+        /**
+         * @brief Token views buffer of the calling thread.
+         */
+        static vector<string_view>& tokenBuffer() {
+            static thread_local vector<string_view> buffer;
+            return buffer;
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_PREPROCESSING_BLOOMFILTER_HPP_INCLUDED
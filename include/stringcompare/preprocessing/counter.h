@@ -3,17 +3,23 @@
  * @author Olivier Binette (https://olivierbinette.ca)
  * @brief (pybind11-friendly) multiset implementation.
  * @date 2022-04-24
- * 
+ *
  */
 
 #ifndef STRINGCOMPARE_PREPROCESSING_COUNTER_HPP_INCLUDED
 #define STRINGCOMPARE_PREPROCESSING_COUNTER_HPP_INCLUDED
 
+#include <stdint.h>
 #include <vector>
 #include <map>
 #include <set>
 #include <algorithm>
-#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "vocabulary.h"
+#include "../utils/arena.h"
+#include "../utils/hash.h"
 
 using namespace std;
 
@@ -22,87 +28,154 @@ namespace stringcompare {
     typedef unsigned long int count_t;
 
     /**
-     * @brief brief String multiset implemented as a map from elements to their count.
+     * @brief Element of a StringCounter with its hash and count.
+     */
+    struct CounterEntry {
+        uint64_t hash;
+        string element;
+        count_t count;
+    };
+
+    /**
+     * @brief String multiset implemented as a vector of elements and counts, sorted by element hash.
      *
-     * \note This is for ease of use with pybind11.
+     * Elements are ordered by hash, and by value among equal hashes, so that lookups are binary searches over contiguous
+     * memory and that intersections and unions are linear merges which mostly compare integers. The total count is
+     * kept up to date on every change.
+     *
+     * New elements are appended to the end of the vector, and are sorted and merged into the other entries when the
+     * counter is next read, or once they outnumber them. Building a counter element by element thus takes
+     * `O(n log n)` time, as fromList() does. Reading a counter with pending elements modifies it, so that it should
+     * not be read by several threads at once before merge() is called. Counters returned by fromList() and tokenizers
+     * have no pending element.
+     *
+     * \note getDict() returns a map from elements to their count, for ease of use with pybind11. It replaces the `dict`
+     * member of the former `std::map` implementation, which no longer exists.
+     *
+     * Each element is a separately allocated string. Batches of multisets are better stored in a StringCounterBatch.
      */
     class StringCounter {
     public:
-        map<string, count_t> dict;
+        count_t total_count;
+
+        StringCounter() : total_count(0), sorted(0) {}
 
-        StringCounter() {};
+        map<string, count_t> getDict() const {
+            map<string, count_t> result;
+            for (const CounterEntry& entry : getEntries()) {
+                result.emplace(entry.element, entry.count);
+            }
 
-        map<string, count_t> getDict() {
-            return this->dict;
+            return result;
+        }
+
+        /**
+         * @brief Entries of the counter, sorted by hash and by element among equal hashes.
+         */
+        const vector<CounterEntry>& getEntries() const {
+            merge();
+            return entries;
+        }
+
+        /**
+         * @brief Hash of an element, which determines its position in the counter. See hashString().
+         */
+        static uint64_t hashElement(string_view element) {
+            return hashString(element);
         }
 
         /**
          * @brief Size of the intersection of two bags.
          */
-        count_t intersectionCount(const StringCounter& other) {
+        count_t intersectionCount(const StringCounter& other) const {
+            const vector<CounterEntry>& a = this->getEntries();
+            const vector<CounterEntry>& b = other.getEntries();
 
-            // Swap `this` and `other` for efficiency, if needed.
             count_t sum = 0;
-            if (dict.size() < other.dict.size()) {
-                const map<string, count_t>& a = this->dict;
-                const map<string, count_t>& b = other.dict;
-
-                for (auto it = a.begin(); it != a.end(); it++) {
-                    auto search = b.find(it->first);
-                    if (search != b.end()) {
-                        sum += min(it->second, search->second);
-                    }
+            size_t i = 0;
+            size_t j = 0;
+            while (i < a.size() && j < b.size()) {
+                if (a[i].hash < b[j].hash) {
+                    i++;
                 }
-
-                return sum;
-            }
-            else {
-                const map<string, count_t>& b = this->dict;
-                const map<string, count_t>& a = other.dict;
-
-                for (auto it = a.begin(); it != a.end(); it++) {
-                    auto search = b.find(it->first);
-                    if (search != b.end()) {
-                        sum += min(it->second, search->second);
+                else if (b[j].hash < a[i].hash) {
+                    j++;
+                }
+                else {
+                    int order = a[i].element.compare(b[j].element);
+                    if (order == 0) {
+                        sum += min(a[i].count, b[j].count);
+                        i++;
+                        j++;
+                    }
+                    else if (order < 0) {
+                        i++;
+                    }
+                    else {
+                        j++;
                     }
                 }
-
-                return sum;
             }
+
+            return sum;
         }
 
         /**
          * @brief Size of the union of two bags.
          */
-        count_t unionCount(const StringCounter& other) {
+        count_t unionCount(const StringCounter& other) const {
             return this->total() + other.total() - this->intersectionCount(other);
         }
 
+        /**
+         * @brief Count of the given element.
+         */
+        count_t count(string_view element) const {
+            merge();
+            auto it = position(element, hashElement(element));
+            if (it != entries.end() && it->element == element) {
+                return it->count;
+            }
+
+            return 0;
+        }
+
         /**
          * @brief Insert one count of the given element.
+         *
+         * Elements already in the sorted entries are counted in place. New elements are appended, and merged once they
+         * outnumber the sorted entries, so that inserts take amortized `O(log n)` time.
          */
-        void insert(const string& element) {
-            auto it = dict.find(element);
-            if (it != dict.end()) {
-                it->second++;
+        void insert(string_view element) {
+            uint64_t h = hashElement(element);
+            auto it = position(element, h);
+            if (it != entries.begin() + sorted && it->element == element) {
+                it->count++;
             }
             else {
-                dict.insert(pair<string, int>(element, 1));
+                entries.push_back(CounterEntry{ h, string(element), 1 });
+                if (entries.size() > 2 * sorted + 16) {
+                    merge();
+                }
             }
+            total_count++;
         }
 
         /**
          * @brief Remove one count of the given element.
          */
-        void remove(const string& element) {
-            auto it = dict.find(element);
-            if (it != dict.end()) {
-                if (it->second <= 1) {
-                    dict.erase(it);
+        void remove(string_view element) {
+            merge();
+            auto it = position(element, hashElement(element));
+            if (it != entries.end() && it->element == element) {
+                if (it->count <= 1) {
+                    entries.erase(it);
+                    sorted--;
                 }
                 else {
-                    it->second--;
+                    it->count--;
                 }
+                total_count--;
             }
         }
 
@@ -111,8 +184,8 @@ namespace stringcompare {
          */
         set<string> elements() const {
             set<string> result;
-            for (auto it = dict.begin(); it != dict.end(); it++) {
-                result.insert(it->first);
+            for (const CounterEntry& entry : getEntries()) {
+                result.insert(entry.element);
             }
 
             return result;
@@ -122,34 +195,533 @@ namespace stringcompare {
          * @brief Total number of elements (including multiplicity) in the Counter.
          */
         count_t total() const {
-            int total = 0;
-            for (auto it = dict.begin(); it != dict.end(); it++) {
-                total += it->second;
-            }
-
-            return total;
+            return total_count;
         }
 
         /**
          * @brief Number of unique elements in the bag.
          */
         count_t unique() const {
-            return dict.size();
+            return getEntries().size();
         }
 
         /**
          * @brief Construct StringCounter object from a list.
+         *
+         * Elements are appended, sorted once and merged, rather than inserted one at a time.
+         *
+         * @param vect List of strings or `string_view`s.
          */
-        static StringCounter fromList(const vector<string>& vect) {
+        template<class List>
+        static StringCounter fromList(const List& vect) {
             StringCounter result;
+            result.entries.reserve(vect.size());
             for (auto it = vect.begin(); it != vect.end(); it++) {
-                result.insert(*it);
+                result.entries.push_back(CounterEntry{ hashElement(*it), string(*it), 1 });
             }
+            result.total_count = result.entries.size();
+            result.merge();
 
             return result;
         }
+
+        static StringCounter fromList(const vector<string>& vect) {
+            return fromList<vector<string>>(vect);
+        }
+
+        /**
+         * @brief Sort pending elements and merge them into the sorted entries.
+         */
+        void merge() const {
+            if (sorted == entries.size()) {
+                return;
+            }
+
+            auto middle = entries.begin() + sorted;
+            sort(middle, entries.end(), entryLess);
+            inplace_merge(entries.begin(), middle, entries.end(), entryLess);
+
+            size_t k = 0;
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (k > 0 && entries[k - 1].hash == entries[i].hash && entries[k - 1].element == entries[i].element) {
+                    entries[k - 1].count += entries[i].count;
+                }
+                else {
+                    if (k != i) {
+                        entries[k] = move(entries[i]);
+                    }
+                    k++;
+                }
+            }
+            entries.resize(k);
+            sorted = k;
+        }
+
+    private:
+
+        /**
+         * @brief Entries, of which the first `sorted` are sorted by entryLess() and have distinct elements.
+         */
+        mutable vector<CounterEntry> entries;
+        mutable size_t sorted;
+
+        static bool entryLess(const CounterEntry& a, const CounterEntry& b) {
+            return (a.hash < b.hash) || (a.hash == b.hash && a.element < b.element);
+        }
+
+        /**
+         * @brief First sorted entry which is not ordered before `element`.
+         */
+        vector<CounterEntry>::iterator position(string_view element, uint64_t h) const {
+            return lower_bound(entries.begin(), entries.begin() + sorted, h, [&](const CounterEntry& entry, uint64_t h) {
+                return (entry.hash < h) || (entry.hash == h && string_view(entry.element) < element);
+            });
+        }
+    };
+
+    /**
+     * @brief Multiset of token ids, implemented as a sorted vector of ids and their counts.
+     *
+     * Ids are given by a Vocabulary shared by the counters of a batch or corpus, and counters of different vocabularies
+     * cannot be compared. Intersections and unions are linear merges over integers.
+     */
+    class IdCounter {
+    public:
+        vector<token_id> ids;
+        vector<count_t> counts;
+        count_t total_count;
+
+        IdCounter() : total_count(0) {}
+
+        /**
+         * @brief Size of the intersection of two bags.
+         */
+        count_t intersectionCount(const IdCounter& other) const {
+            count_t sum = 0;
+            size_t i = 0;
+            size_t j = 0;
+            while (i < ids.size() && j < other.ids.size()) {
+                if (ids[i] < other.ids[j]) {
+                    i++;
+                }
+                else if (other.ids[j] < ids[i]) {
+                    j++;
+                }
+                else {
+                    sum += min(counts[i], other.counts[j]);
+                    i++;
+                    j++;
+                }
+            }
+
+            return sum;
+        }
+
+        /**
+         * @brief Size of the union of two bags.
+         */
+        count_t unionCount(const IdCounter& other) const {
+            return this->total() + other.total() - this->intersectionCount(other);
+        }
+
+        /**
+         * @brief Count of the given id.
+         */
+        count_t count(token_id id) const {
+            auto it = lower_bound(ids.begin(), ids.end(), id);
+            if (it != ids.end() && *it == id) {
+                return counts[it - ids.begin()];
+            }
+
+            return 0;
+        }
+
+        /**
+         * @brief Insert one count of the given id.
+         */
+        void insert(token_id id) {
+            auto it = lower_bound(ids.begin(), ids.end(), id);
+            size_t k = it - ids.begin();
+            if (it != ids.end() && *it == id) {
+                counts[k]++;
+            }
+            else {
+                ids.insert(it, id);
+                counts.insert(counts.begin() + k, 1);
+            }
+            total_count++;
+        }
+
+        /**
+         * @brief Remove one count of the given id.
+         */
+        void remove(token_id id) {
+            auto it = lower_bound(ids.begin(), ids.end(), id);
+            size_t k = it - ids.begin();
+            if (it != ids.end() && *it == id) {
+                if (counts[k] <= 1) {
+                    ids.erase(it);
+                    counts.erase(counts.begin() + k);
+                }
+                else {
+                    counts[k]--;
+                }
+                total_count--;
+            }
+        }
+
+        /**
+         * @brief Total number of ids (including multiplicity) in the Counter.
+         */
+        count_t total() const {
+            return total_count;
+        }
+
+        /**
+         * @brief Number of unique ids in the bag.
+         */
+        count_t unique() const {
+            return ids.size();
+        }
+
+        /**
+         * @brief Construct IdCounter object from a list of ids, which is sorted once.
+         */
+        static IdCounter fromList(vector<token_id> vect) {
+            IdCounter result;
+            result.total_count = vect.size();
+            sort(vect.begin(), vect.end());
+            for (size_t i = 0; i < vect.size(); i++) {
+                if (i > 0 && vect[i] == vect[i - 1]) {
+                    result.counts.back()++;
+                }
+                else {
+                    result.ids.push_back(vect[i]);
+                    result.counts.push_back(1);
+                }
+            }
+
+            return result;
+        }
+    };
+
+    /**
+     * @brief Read-only view of a multiset of token ids stored in an IdCounterBatch.
+     */
+    class IdCounterView {
+    public:
+        const token_id* ids;
+        const count_t* counts;
+        size_t length;
+        count_t total_count;
+
+        /**
+         * @brief Size of the intersection of two bags.
+         */
+        count_t intersectionCount(const IdCounterView& other) const {
+            count_t sum = 0;
+            size_t i = 0;
+            size_t j = 0;
+            while (i < length && j < other.length) {
+                if (ids[i] < other.ids[j]) {
+                    i++;
+                }
+                else if (other.ids[j] < ids[i]) {
+                    j++;
+                }
+                else {
+                    sum += min(counts[i], other.counts[j]);
+                    i++;
+                    j++;
+                }
+            }
+
+            return sum;
+        }
+
+        /**
+         * @brief Size of the union of two bags.
+         */
+        count_t unionCount(const IdCounterView& other) const {
+            return this->total() + other.total() - this->intersectionCount(other);
+        }
+
+        /**
+         * @brief Count of the given id.
+         */
+        count_t count(token_id id) const {
+            const token_id* it = lower_bound(ids, ids + length, id);
+            if (it != ids + length && *it == id) {
+                return counts[it - ids];
+            }
+
+            return 0;
+        }
+
+        /**
+         * @brief Total number of ids (including multiplicity) in the bag.
+         */
+        count_t total() const {
+            return total_count;
+        }
+
+        /**
+         * @brief Number of unique ids in the bag.
+         */
+        count_t unique() const {
+            return length;
+        }
+    };
+
+    /**
+     * @brief Batch of multisets of token ids, stored back to back in flat buffers.
+     *
+     * The ith multiset is made of the ids and counts from `offsets[i]` to `offsets[i + 1] - 1`, as rows of a sparse
+     * matrix in compressed row format. A batch of any size thus makes a handful of allocations, rather than two per
+     * multiset for a vector of IdCounter objects, and is read sequentially when comparing consecutive multisets.
+     * Clearing a batch keeps its capacity, so that it can be refilled without allocating.
+     */
+    class IdCounterBatch {
+    public:
+        vector<token_id> ids;
+        vector<count_t> counts;
+        vector<size_t> offsets;
+        vector<count_t> totals;
+
+        IdCounterBatch() : offsets(1, 0) {}
+
+        size_t size() const {
+            return totals.size();
+        }
+
+        IdCounterView operator[](size_t i) const {
+            size_t begin = offsets[i];
+            return IdCounterView{ ids.data() + begin, counts.data() + begin, offsets[i + 1] - begin, totals[i] };
+        }
+
+        /**
+         * @brief Append the multiset of a list of ids. The list is sorted in place.
+         */
+        void push_back(token_id* list, size_t n) {
+            sort(list, list + n);
+            for (size_t i = 0; i < n; i++) {
+                if (i > 0 && list[i] == list[i - 1]) {
+                    counts.back()++;
+                }
+                else {
+                    ids.push_back(list[i]);
+                    counts.push_back(1);
+                }
+            }
+            offsets.push_back(ids.size());
+            totals.push_back(n);
+        }
+
+        /**
+         * @brief Reserve space for `n` multisets of `entries` distinct ids in total.
+         */
+        void reserve(size_t n, size_t entries) {
+            offsets.reserve(n + 1);
+            totals.reserve(n);
+            ids.reserve(entries);
+            counts.reserve(entries);
+        }
+
+        /**
+         * @brief Remove all multisets, keeping allocated buffers.
+         */
+        void clear() {
+            ids.clear();
+            counts.clear();
+            offsets.resize(1);
+            totals.clear();
+        }
+    };
+
+    /**
+     * @brief Element of a StringCounterView with its hash and count. The element is a view into the arena of a
+     * StringCounterBatch.
+     */
+    struct CounterViewEntry {
+        uint64_t hash;
+        string_view element;
+        count_t count;
+    };
+
+    /**
+     * @brief Read-only view of a string multiset stored in a StringCounterBatch.
+     *
+     * Entries are sorted by hash, and by element among equal hashes, as those of a StringCounter.
+     */
+    class StringCounterView {
+    public:
+        const CounterViewEntry* entries;
+        size_t length;
+        count_t total_count;
+
+        /**
+         * @brief Size of the intersection of two bags.
+         */
+        count_t intersectionCount(const StringCounterView& other) const {
+            count_t sum = 0;
+            size_t i = 0;
+            size_t j = 0;
+            while (i < length && j < other.length) {
+                const CounterViewEntry& a = entries[i];
+                const CounterViewEntry& b = other.entries[j];
+                if (a.hash < b.hash) {
+                    i++;
+                }
+                else if (b.hash < a.hash) {
+                    j++;
+                }
+                else {
+                    int order = a.element.compare(b.element);
+                    if (order == 0) {
+                        sum += min(a.count, b.count);
+                        i++;
+                        j++;
+                    }
+                    else if (order < 0) {
+                        i++;
+                    }
+                    else {
+                        j++;
+                    }
+                }
+            }
+
+            return sum;
+        }
+
+        /**
+         * @brief Size of the union of two bags.
+         */
+        count_t unionCount(const StringCounterView& other) const {
+            return this->total() + other.total() - this->intersectionCount(other);
+        }
+
+        /**
+         * @brief Count of the given element.
+         */
+        count_t count(string_view element) const {
+            uint64_t h = StringCounter::hashElement(element);
+            const CounterViewEntry* it = lower_bound(entries, entries + length, h, [&](const CounterViewEntry& entry, uint64_t h) {
+                return (entry.hash < h) || (entry.hash == h && entry.element < element);
+            });
+            if (it != entries + length && it->element == element) {
+                return it->count;
+            }
+
+            return 0;
+        }
+
+        /**
+         * @brief Total number of elements (including multiplicity) in the bag.
+         */
+        count_t total() const {
+            return total_count;
+        }
+
+        /**
+         * @brief Number of unique elements in the bag.
+         */
+        count_t unique() const {
+            return length;
+        }
+    };
+
+    /**
+     * @brief Batch of string multisets, stored back to back in flat buffers.
+     *
+     * The ith multiset is made of the entries from `offsets[i]` to `offsets[i + 1] - 1`, as for IdCounterBatch. Elements
+     * are views into an arena owned by the batch, so that a batch of any size makes a handful of allocations, rather
+     * than one per element and two per multiset for a vector of StringCounter objects. Views returned by operator[]
+     * are valid as long as the batch is not modified.
+     */
+    class StringCounterBatch {
+    public:
+        vector<CounterViewEntry> entries;
+        vector<size_t> offsets;
+        vector<count_t> totals;
+
+        StringCounterBatch() : offsets(1, 0) {}
+
+        size_t size() const {
+            return totals.size();
+        }
+
+        StringCounterView operator[](size_t i) const {
+            size_t begin = offsets[i];
+            return StringCounterView{ entries.data() + begin, offsets[i + 1] - begin, totals[i] };
+        }
+
+        /**
+         * @brief Append the multiset of a list of tokens, which are copied into the arena of the batch.
+         */
+        void push_back(const string_view* tokens, size_t n) {
+            size_t begin = entries.size();
+            for (size_t i = 0; i < n; i++) {
+                entries.push_back(CounterViewEntry{ StringCounter::hashElement(tokens[i]), tokens[i], 1 });
+            }
+            sort(entries.begin() + begin, entries.end(), [](const CounterViewEntry& a, const CounterViewEntry& b) {
+                return (a.hash < b.hash) || (a.hash == b.hash && a.element < b.element);
+            });
+
+            size_t k = begin;
+            for (size_t i = begin; i < entries.size(); i++) {
+                if (k > begin && entries[k - 1].hash == entries[i].hash && entries[k - 1].element == entries[i].element) {
+                    entries[k - 1].count++;
+                }
+                else {
+                    entries[k] = entries[i];
+                    entries[k].element = arena.store(entries[i].element);
+                    k++;
+                }
+            }
+            entries.resize(k);
+            offsets.push_back(k);
+            totals.push_back(n);
+        }
+
+        /**
+         * @brief Append all multisets of another batch, taking ownership of its arena. The other batch is cleared.
+         */
+        void append(StringCounterBatch& other) {
+            size_t shift = entries.size();
+            entries.insert(entries.end(), other.entries.begin(), other.entries.end());
+            for (size_t i = 1; i < other.offsets.size(); i++) {
+                offsets.push_back(other.offsets[i] + shift);
+            }
+            totals.insert(totals.end(), other.totals.begin(), other.totals.end());
+            arena.splice(other.arena);
+            other.clear();
+        }
+
+        /**
+         * @brief Reserve space for `n` multisets of `entries` distinct elements in total.
+         */
+        void reserve(size_t n, size_t entries) {
+            offsets.reserve(n + 1);
+            totals.reserve(n);
+            this->entries.reserve(entries);
+        }
+
+        /**
+         * @brief Remove all multisets and free their elements, keeping the allocated entry buffers.
+         */
+        void clear() {
+            entries.clear();
+            offsets.resize(1);
+            totals.clear();
+            arena.clear();
+        }
+
+    private:
+
+        ByteArena arena;
     };
 
 }
 
-#endif // STRINGCOMPARE_PREPROCESSING_COUNTER_HPP_INCLUDED
\ No newline at end of file
+#endif // STRINGCOMPARE_PREPROCESSING_COUNTER_HPP_INCLUDED
@@ -9,15 +9,26 @@
 #ifndef STRINGCOMPARE_PREPROCESSING_TOKENIZER_HPP_INCLUDED
 #define STRINGCOMPARE_PREPROCESSING_TOKENIZER_HPP_INCLUDED
 
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <sstream>
 
 #include "counter.h"
+#include "vocabulary.h"
+#include "../utils/parallel.h"
+#include "../utils/stringcolumn.h"
 
 using namespace std;
 
 namespace stringcompare {
 
+    /**
+     * @brief Number of sentences per unit of work in parallel batch tokenization.
+     */
+    const size_t TOKENIZE_TILE = 256;
+
     /**
      * @brief String tokenizer base class.
      * 
@@ -25,24 +36,195 @@ namespace stringcompare {
     class Tokenizer {
     public:
 
-        StringCounter tokenize(const string& sentence) const {
-            StringCounter result;
+        virtual ~Tokenizer() {}
+
+        /**
+         * @brief Append the tokens of a sentence to `out`, as views into the sentence.
+         *
+         * Tokenizers override this function. No token is copied, so that the views are only valid as long as the
+         * sentence is.
+         */
+        virtual void appendTokens(string_view /*sentence*/, vector<string_view>& /*out*/) const {}
+
+        /**
+         * @brief Tokens of a sentence, as views into the sentence.
+         */
+        vector<string_view> tokens(string_view sentence) const {
+            vector<string_view> result;
+            this->appendTokens(sentence, result);
             return result;
         }
 
-        StringCounter operator()(const string& sentence) const {
+        StringCounter tokenize(string_view sentence) const {
+            vector<string_view>& buffer = tokenBuffer();
+            buffer.clear();
+            this->appendTokens(sentence, buffer);
+            return StringCounter::fromList(buffer);
+        }
+
+        StringCounter operator()(string_view sentence) const {
             return this->tokenize(sentence);
         }
 
-        vector<StringCounter> batchTokenize(const vector<string>& sentences) const {
-            vector<StringCounter> result(sentences.size());
-            for (size_t i = 0; i < sentences.size(); i++) {
-                result[i] = this->tokenize(sentences[i]);
+        /**
+         * @brief Multiset of the vocabulary ids of the tokens of a sentence. New tokens are added to the vocabulary.
+         */
+        IdCounter tokenizeIds(string_view sentence, Vocabulary& vocabulary) const {
+            vector<string_view>& buffer = tokenBuffer();
+            buffer.clear();
+            this->appendTokens(sentence, buffer);
+
+            vector<token_id> ids(buffer.size());
+            for (size_t i = 0; i < buffer.size(); i++) {
+                ids[i] = vocabulary.id(buffer[i]);
+            }
+
+            return IdCounter::fromList(move(ids));
+        }
+
+        /**
+         * @brief Multisets of the tokens of a batch of sentences.
+         *
+         * @deprecated Each element of the returned counters is a separate string allocation. Use batchCount(), whose
+         * elements are stored in a single arena.
+         *
+         * @param sentences List of sentences.
+         * @param nthreads Number of threads. Values smaller than 1 use all hardware threads. Defaults to 1.
+         */
+        vector<StringCounter> batchTokenize(const vector<string>& sentences, int nthreads = 1) const {
+            return batchTokenize(sentences, sentences.size(), nthreads);
+        }
+
+        /**
+         * @brief Multisets of the tokens of the strings of a column, read in place.
+         *
+         * @deprecated See batchTokenize(const vector<string>&, int).
+         */
+        template<class Offset>
+        vector<StringCounter> batchTokenize(const BasicStringColumn<Offset>& sentences, int nthreads = 1) const {
+            return batchTokenize(sentences, sentences.size(), nthreads);
+        }
+
+        /**
+         * @brief Multisets of the tokens of a batch of sentences, collected into a single arena-backed batch. See
+         * StringCounterBatch.
+         *
+         * Sentences are tokenized by tiles of `TOKENIZE_TILE`, shared between threads, into batches which are then
+         * appended in order.
+         *
+         * @param sentences List of sentences.
+         * @param nthreads Number of threads. Values smaller than 1 use all hardware threads. Defaults to 1.
+         */
+        StringCounterBatch batchCount(const vector<string>& sentences, int nthreads = 1) const {
+            return batchCount(sentences, sentences.size(), nthreads);
+        }
+
+        /**
+         * @brief Multisets of the tokens of the strings of a column, read in place. See batchCount().
+         */
+        template<class Offset>
+        StringCounterBatch batchCount(const BasicStringColumn<Offset>& sentences, int nthreads = 1) const {
+            return batchCount(sentences, sentences.size(), nthreads);
+        }
+
+        /**
+         * @brief Id multisets of a batch of sentences, with tokens interned in a shared vocabulary. See IdCounterBatch.
+         */
+        IdCounterBatch batchTokenizeIds(const vector<string>& sentences, Vocabulary& vocabulary) const {
+            return batchTokenizeIds(sentences, sentences.size(), vocabulary);
+        }
+
+        /**
+         * @brief Id multisets of the strings of a column, read in place. See batchTokenizeIds().
+         */
+        template<class Offset>
+        IdCounterBatch batchTokenizeIds(const BasicStringColumn<Offset>& sentences, Vocabulary& vocabulary) const {
+            return batchTokenizeIds(sentences, sentences.size(), vocabulary);
+        }
+
+    protected:
+
+        /**
+         * @brief Multisets of the tokens of `n` sentences `sentences[i]`, tokenized by tiles shared between threads.
+         */
+        template<class List>
+        vector<StringCounter> batchTokenize(const List& sentences, size_t n, int nthreads) const {
+            vector<StringCounter> result(n);
+            size_t ntiles = (n + TOKENIZE_TILE - 1) / TOKENIZE_TILE;
+            parallelFor(ntiles, nthreads, [&](size_t tile) {
+                size_t end = min(n, (tile + 1) * TOKENIZE_TILE);
+                for (size_t i = tile * TOKENIZE_TILE; i < end; i++) {
+                    result[i] = this->tokenize(sentences[i]);
+                }
+            });
+
+            return result;
+        }
+
+        /**
+         * @brief String multisets of `n` sentences `sentences[i]`, tokenized by tiles into batches which are appended in
+         * order.
+         */
+        template<class List>
+        StringCounterBatch batchCount(const List& sentences, size_t n, int nthreads) const {
+            size_t ntiles = (n + TOKENIZE_TILE - 1) / TOKENIZE_TILE;
+            vector<StringCounterBatch> tiles(ntiles);
+            parallelFor(ntiles, nthreads, [&](size_t tile) {
+                size_t end = min(n, (tile + 1) * TOKENIZE_TILE);
+                vector<string_view>& buffer = tokenBuffer();
+                for (size_t i = tile * TOKENIZE_TILE; i < end; i++) {
+                    buffer.clear();
+                    this->appendTokens(sentences[i], buffer);
+                    tiles[tile].push_back(buffer.data(), buffer.size());
+                }
+            });
+
+            StringCounterBatch result;
+            size_t entries = 0;
+            for (const StringCounterBatch& tile : tiles) {
+                entries += tile.entries.size();
+            }
+            result.reserve(n, entries);
+            for (StringCounterBatch& tile : tiles) {
+                result.append(tile);
             }
 
             return result;
         }
 
+        /**
+         * @brief Id multisets of `n` sentences `sentences[i]`, collected into a single batch.
+         *
+         * Tokens and ids of each sentence go through scratch buffers of the calling thread, so that the only allocations
+         * are the growth of the batch buffers and of the vocabulary.
+         */
+        template<class List>
+        IdCounterBatch batchTokenizeIds(const List& sentences, size_t n, Vocabulary& vocabulary) const {
+            IdCounterBatch result;
+            result.reserve(n, 0);
+            vector<string_view>& buffer = tokenBuffer();
+            static thread_local vector<token_id> ids;
+            for (size_t i = 0; i < n; i++) {
+                buffer.clear();
+                this->appendTokens(sentences[i], buffer);
+                ids.resize(buffer.size());
+                for (size_t k = 0; k < buffer.size(); k++) {
+                    ids[k] = vocabulary.id(buffer[k]);
+                }
+                result.push_back(ids.data(), ids.size());
+            }
+
+            return result;
+        }
+
+        /**
+         * @brief Token views buffer of the calling thread.
+         */
+        static vector<string_view>& tokenBuffer() {
+            static thread_local vector<string_view> buffer;
+            return buffer;
+        }
+
     };
 
     /**
@@ -59,28 +241,24 @@ namespace stringcompare {
             }
         }
 
-        StringCounter tokenize(const string& sentence) const {
-            StringCounter result;
-
+        void appendTokens(string_view sentence, vector<string_view>& out) const {
             if (sentence.size() == 0) {
-                return result;
+                return;
             }
 
             size_t k = this->delim.size();
             size_t pos = 0;
             size_t match = 0;
 
-            while ((match = sentence.find(this->delim, pos)) != string::npos) {
+            while ((match = sentence.find(this->delim, pos)) != string_view::npos) {
                 if (match != pos) {
-                    result.insert(sentence.substr(pos, match - pos));
+                    out.push_back(sentence.substr(pos, match - pos));
                 }
                 pos = match + k;
             }
             if (pos < sentence.size()) {
-                result.insert(sentence.substr(pos));
+                out.push_back(sentence.substr(pos));
             }
-
-            return result;
         }
     };
 
@@ -104,18 +282,14 @@ namespace stringcompare {
             this->n = n;
         }
 
-        StringCounter tokenize(const string& sentence) const {
-            StringCounter result;
-
+        void appendTokens(string_view sentence, vector<string_view>& out) const {
             if (this->n <= 0) {
-                return result;
+                return;
             }
 
-            for (size_t i = 0; i < sentence.size() - this->n; i++) {
-                result.insert(sentence.substr(i, this->n));
+            for (size_t i = 0; i + this->n <= sentence.size(); i++) {
+                out.push_back(sentence.substr(i, this->n));
             }
-
-            return result;
         }
     };
 
@@ -0,0 +1,161 @@
+/**
+ * @file vocabulary.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Interned token vocabulary mapping tokens to integer ids.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_PREPROCESSING_VOCABULARY_HPP_INCLUDED
+#define STRINGCOMPARE_PREPROCESSING_VOCABULARY_HPP_INCLUDED
+
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../utils/arena.h"
+#include "../utils/hash.h"
+
+using namespace std;
+
+namespace stringcompare {
+
+    typedef uint32_t token_id;
+
+    /**
+     * @brief Vocabulary of interned tokens.
+     *
+     * Each distinct token is stored once and given the next integer id, so that token multisets of a batch or corpus
+     * can be represented by ids only (see IdCounter). Token bytes are stored in a ByteArena and looked up through an
+     * open addressing hash table of ids, so that a vocabulary makes a handful of allocations however many tokens it
+     * holds, and frees them at once.
+     *
+     * Lookups of known tokens are const and can run concurrently; adding tokens cannot.
+     */
+    class Vocabulary {
+    public:
+
+        Vocabulary() : slots(16, 0) {}
+
+        Vocabulary(const Vocabulary& other) : Vocabulary() {
+            for (string_view token : other.tokens) {
+                id(token);
+            }
+        }
+
+        Vocabulary& operator=(const Vocabulary& other) {
+            if (this != &other) {
+                clear();
+                for (string_view token : other.tokens) {
+                    id(token);
+                }
+            }
+
+            return *this;
+        }
+
+        Vocabulary(Vocabulary&&) = default;
+        Vocabulary& operator=(Vocabulary&&) = default;
+
+        /**
+         * @brief Id of a token, which is added to the vocabulary if it is new.
+         */
+        token_id id(string_view token) {
+            uint64_t h = hashString(token);
+            size_t i = slot(token, h);
+            if (slots[i] != 0) {
+                return slots[i] - 1;
+            }
+
+            token_id result = tokens.size();
+            tokens.push_back(arena.store(token));
+            hashes.push_back(h);
+            slots[i] = result + 1;
+            if (2 * tokens.size() > slots.size()) {
+                rehash(2 * slots.size());
+            }
+
+            return result;
+        }
+
+        /**
+         * @brief Whether or not a token is in the vocabulary.
+         */
+        bool contains(string_view token) const {
+            return slots[slot(token, hashString(token))] != 0;
+        }
+
+        /**
+         * @brief Id of a token already in the vocabulary.
+         */
+        token_id find(string_view token) const {
+            uint32_t entry = slots[slot(token, hashString(token))];
+            if (entry == 0) {
+                throw runtime_error("Token is not in the vocabulary.");
+            }
+
+            return entry - 1;
+        }
+
+        /**
+         * @brief Token of a given id.
+         */
+        string_view token(token_id id) const {
+            return tokens.at(id);
+        }
+
+        size_t size() const {
+            return tokens.size();
+        }
+
+        /**
+         * @brief Remove all tokens at once.
+         */
+        void clear() {
+            tokens.clear();
+            hashes.clear();
+            slots.assign(16, 0);
+            arena.clear();
+        }
+
+    private:
+
+        ByteArena arena;
+        vector<string_view> tokens;
+        vector<uint64_t> hashes;
+        vector<uint32_t> slots;
+
+        /**
+         * @brief Slot of the hash table holding `token`, or the empty slot where it would be inserted.
+         *
+         * Slots hold token ids plus one, and 0 when empty. The table size is a power of two.
+         */
+        size_t slot(string_view token, uint64_t h) const {
+            size_t mask = slots.size() - 1;
+            size_t i = h & mask;
+            while (slots[i] != 0 && (hashes[slots[i] - 1] != h || tokens[slots[i] - 1] != token)) {
+                i = (i + 1) & mask;
+            }
+
+            return i;
+        }
+
+        void rehash(size_t size) {
+            slots.assign(size, 0);
+            size_t mask = size - 1;
+            for (size_t id = 0; id < tokens.size(); id++) {
+                size_t i = hashes[id] & mask;
+                while (slots[i] != 0) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = id + 1;
+            }
+        }
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_PREPROCESSING_VOCABULARY_HPP_INCLUDED
@@ -0,0 +1,102 @@
+/**
+ * @file arena.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Arena allocation of bytes for batch-scoped data.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_UTILS_ARENA_HPP_INCLUDED
+#define STRINGCOMPARE_UTILS_ARENA_HPP_INCLUDED
+
+#include <string.h>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Bump allocator for strings which share a lifetime.
+     *
+     * Strings are copied into large chunks, so that storing many small strings makes a handful of allocations, and
+     * freeing them all with clear() or the destructor releases whole chunks at once. Stored strings never move.
+     */
+    class ByteArena {
+    public:
+
+        /**
+         * @brief Size of allocated chunks. Larger strings are given a chunk of their own.
+         */
+        static const size_t CHUNK_SIZE = 1 << 16;
+
+        ByteArena() : used(CHUNK_SIZE) {}
+
+        ByteArena(const ByteArena&) = delete;
+        ByteArena& operator=(const ByteArena&) = delete;
+        ByteArena(ByteArena&&) = default;
+        ByteArena& operator=(ByteArena&&) = default;
+
+        /**
+         * @brief Copy a string into the arena, and return a view of the copy.
+         */
+        string_view store(string_view s) {
+            if (s.empty()) {
+                return string_view();
+            }
+            if (s.size() > CHUNK_SIZE) {
+                chunks.emplace_back(new char[s.size()]);
+                memcpy(chunks.back().get(), s.data(), s.size());
+                // Keep filling the previous chunk, if any.
+                if (chunks.size() > 1) {
+                    swap(chunks[chunks.size() - 1], chunks[chunks.size() - 2]);
+                    return string_view(chunks[chunks.size() - 2].get(), s.size());
+                }
+                used = CHUNK_SIZE;
+                return string_view(chunks.back().get(), s.size());
+            }
+
+            if (used + s.size() > CHUNK_SIZE) {
+                chunks.emplace_back(new char[CHUNK_SIZE]);
+                used = 0;
+            }
+            char* result = chunks.back().get() + used;
+            memcpy(result, s.data(), s.size());
+            used += s.size();
+
+            return string_view(result, s.size());
+        }
+
+        /**
+         * @brief Take ownership of the strings stored in another arena, which is left empty. Views of these strings stay
+         * valid.
+         */
+        void splice(ByteArena& other) {
+            // Keep filling the current chunk, if any, which stays last.
+            auto position = chunks.empty() ? chunks.end() : chunks.end() - 1;
+            chunks.insert(position, make_move_iterator(other.chunks.begin()), make_move_iterator(other.chunks.end()));
+            other.clear();
+        }
+
+        /**
+         * @brief Free all stored strings at once.
+         */
+        void clear() {
+            chunks.clear();
+            used = CHUNK_SIZE;
+        }
+
+    private:
+
+        vector<unique_ptr<char[]>> chunks;
+        size_t used;
+
+    };
+
+}
+
+#endif // STRINGCOMPARE_UTILS_ARENA_HPP_INCLUDED
@@ -0,0 +1,114 @@
+/**
+ * @file cpu.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Runtime detection of CPU features, for the dispatch of vectorized kernels.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_UTILS_CPU_HPP_INCLUDED
+#define STRINGCOMPARE_UTILS_CPU_HPP_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+
+using namespace std;
+
+/*
+ * Kernels are compiled for the baseline instruction set chosen by the consumer, and again for wider instruction sets
+ * through function target attributes. The widest version supported by the running CPU is selected at runtime, so that
+ * a binary built for baseline x86-64 still uses AVX2 and AVX-512 where available.
+ *
+ * Target attributes are available with GCC and Clang on x86. Elsewhere, or when STRINGCOMPARE_NO_DISPATCH is defined,
+ * the attributes are empty and all kernels are the baseline ones.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) && !defined(STRINGCOMPARE_NO_DISPATCH)
+#define STRINGCOMPARE_DISPATCH
+#define STRINGCOMPARE_TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#define STRINGCOMPARE_TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2,popcnt")))
+#define STRINGCOMPARE_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx512vpopcntdq,avx2,bmi,bmi2,popcnt")))
+#define STRINGCOMPARE_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define STRINGCOMPARE_TARGET_SSE42
+#define STRINGCOMPARE_TARGET_AVX2
+#define STRINGCOMPARE_TARGET_AVX512
+#define STRINGCOMPARE_ALWAYS_INLINE inline
+#endif
+
+namespace stringcompare {
+
+    /**
+     * @brief Instruction set levels of dispatched kernels, from narrowest to widest.
+     *
+     * - `CPU_SCALAR`: the baseline instruction set of the build.
+     * - `CPU_SSE42`: SSE4.2 with hardware popcount.
+     * - `CPU_AVX2`: AVX2, BMI2 and popcount.
+     * - `CPU_AVX512`: AVX-512 F, BW, VL and VPOPCNTDQ (vectorized popcount).
+     */
+    enum CpuLevel {
+        CPU_SCALAR = 0,
+        CPU_SSE42 = 1,
+        CPU_AVX2 = 2,
+        CPU_AVX512 = 3
+    };
+
+    /**
+     * @brief Widest level supported by the running CPU, from CPUID.
+     */
+    inline CpuLevel detectCpuLevel() {
+#ifdef STRINGCOMPARE_DISPATCH
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl")
+            && __builtin_cpu_supports("avx512vpopcntdq") && __builtin_cpu_supports("bmi2")) {
+            return CPU_AVX512;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("popcnt")) {
+            return CPU_AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")) {
+            return CPU_SSE42;
+        }
+#endif
+        return CPU_SCALAR;
+    }
+
+    /**
+     * @brief Largest level allowed by setCpuLevel().
+     */
+    inline atomic<int>& cpuLevelLimit() {
+        static atomic<int> limit(CPU_AVX512);
+        return limit;
+    }
+
+    /**
+     * @brief Level of the kernels to run: the widest level supported by the CPU, up to the limit set by setCpuLevel().
+     */
+    inline CpuLevel cpuLevel() {
+        static const CpuLevel detected = detectCpuLevel();
+        return (CpuLevel)min((int)detected, cpuLevelLimit().load(memory_order_relaxed));
+    }
+
+    /**
+     * @brief Restrict kernels to a level, such as `CPU_SCALAR` to compare implementations. Levels wider than the CPU
+     * supports have no effect.
+     */
+    inline void setCpuLevel(CpuLevel level) {
+        cpuLevelLimit().store(level, memory_order_relaxed);
+    }
+
+    inline const char* cpuLevelName(CpuLevel level) {
+        switch (level) {
+        case CPU_SSE42:
+            return "sse4.2";
+        case CPU_AVX2:
+            return "avx2";
+        case CPU_AVX512:
+            return "avx512";
+        default:
+            return "scalar";
+        }
+    }
+
+}
+
+#endif // STRINGCOMPARE_UTILS_CPU_HPP_INCLUDED
@@ -0,0 +1,50 @@
+/**
+ * @file hash.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Portable 64 bits hash functions for tokens and sketches.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_UTILS_HASH_HPP_INCLUDED
+#define STRINGCOMPARE_UTILS_HASH_HPP_INCLUDED
+
+#include <stdint.h>
+#include <string_view>
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Finalizer of the splitmix64 generator, a bijective mix of the bits of `x`.
+     */
+    inline uint64_t mix64(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+
+        return x;
+    }
+
+    /**
+     * @brief 64 bits FNV-1a hash of a string, with mixed output bits.
+     *
+     * Unlike `std::hash`, values are the same on every platform, so that sketches built from them can be stored and
+     * compared across runs.
+     */
+    inline uint64_t hashString(string_view s) {
+        uint64_t h = 0xCBF29CE484222325ULL;
+        for (size_t i = 0; i < s.size(); i++) {
+            h ^= (unsigned char)s[i];
+            h *= 0x100000001B3ULL;
+        }
+
+        return mix64(h);
+    }
+
+}
+
+#endif // STRINGCOMPARE_UTILS_HASH_HPP_INCLUDED
@@ -0,0 +1,148 @@
+/**
+ * @file parallel.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Work-stealing parallel loops for batch comparisons.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_UTILS_PARALLEL_HPP_INCLUDED
+#define STRINGCOMPARE_UTILS_PARALLEL_HPP_INCLUDED
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Resolve a requested number of threads.
+     *
+     * @param nthreads Requested number of threads. Values smaller than 1 use all hardware threads.
+     * @param ntasks Number of tasks to run. No more threads than tasks are used.
+     */
+    inline int resolveThreads(int nthreads, size_t ntasks) {
+        if (nthreads < 1) {
+            nthreads = max(1u, thread::hardware_concurrency());
+        }
+
+        return (int)max(size_t(1), min((size_t)nthreads, ntasks));
+    }
+
+    /**
+     * @brief Range of task indices owned by one worker of parallelFor().
+     */
+    struct TaskRange {
+        mutex lock;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    /**
+     * @brief Run `task(i)` for every `i` in `[0, ntasks)` on `nthreads` threads.
+     *
+     * Each worker starts with a contiguous range of tasks and takes them from the front. Once its range is exhausted,
+     * it steals the back half of the largest remaining range of another worker, so that the load stays balanced when
+     * task costs are skewed. The first exception thrown by a task is rethrown once all workers have stopped.
+     *
+     * @param ntasks Number of tasks.
+     * @param nthreads Number of threads. Values smaller than 1 use all hardware threads.
+     * @param task Callable taking a task index.
+     */
+    template<class Task>
+    void parallelFor(size_t ntasks, int nthreads, const Task& task) {
+        nthreads = resolveThreads(nthreads, ntasks);
+        if (nthreads == 1) {
+            for (size_t i = 0; i < ntasks; i++) {
+                task(i);
+            }
+            return;
+        }
+
+        vector<TaskRange> ranges(nthreads);
+        for (int k = 0; k < nthreads; k++) {
+            ranges[k].begin = ntasks * k / nthreads;
+            ranges[k].end = ntasks * (k + 1) / nthreads;
+        }
+
+        mutex error_lock;
+        exception_ptr error = nullptr;
+
+        auto worker = [&](int k) {
+            while (true) {
+                size_t i = 0;
+                bool found = false;
+                {
+                    lock_guard<mutex> guard(ranges[k].lock);
+                    if (ranges[k].begin < ranges[k].end) {
+                        i = ranges[k].begin++;
+                        found = true;
+                    }
+                }
+
+                if (!found) {
+                    // Steal the back half of the largest remaining range.
+                    int victim = -1;
+                    size_t largest = 0;
+                    for (int v = 0; v < nthreads; v++) {
+                        if (v != k) {
+                            lock_guard<mutex> guard(ranges[v].lock);
+                            if (ranges[v].end - ranges[v].begin > largest) {
+                                largest = ranges[v].end - ranges[v].begin;
+                                victim = v;
+                            }
+                        }
+                    }
+                    if (victim < 0) {
+                        return;
+                    }
+
+                    size_t begin, end;
+                    {
+                        lock_guard<mutex> guard(ranges[victim].lock);
+                        end = ranges[victim].end;
+                        begin = ranges[victim].begin + (end - ranges[victim].begin) / 2;
+                        ranges[victim].end = begin;
+                    }
+                    if (begin < end) {
+                        lock_guard<mutex> guard(ranges[k].lock);
+                        ranges[k].begin = begin;
+                        ranges[k].end = end;
+                    }
+                    continue;
+                }
+
+                try {
+                    task(i);
+                }
+                catch (...) {
+                    lock_guard<mutex> guard(error_lock);
+                    if (!error) {
+                        error = current_exception();
+                    }
+                }
+            }
+        };
+
+        vector<thread> threads;
+        threads.reserve(nthreads - 1);
+        for (int k = 1; k < nthreads; k++) {
+            threads.emplace_back(worker, k);
+        }
+        worker(0);
+        for (auto& th : threads) {
+            th.join();
+        }
+
+        if (error) {
+            rethrow_exception(error);
+        }
+    }
+
+}
+
+#endif // STRINGCOMPARE_UTILS_PARALLEL_HPP_INCLUDED
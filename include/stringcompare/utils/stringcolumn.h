@@ -0,0 +1,198 @@
+/**
+ * @file stringcolumn.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Columns of strings stored as offsets into a contiguous byte buffer.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_UTILS_STRINGCOLUMN_HPP_INCLUDED
+#define STRINGCOMPARE_UTILS_STRINGCOLUMN_HPP_INCLUDED
+
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Column of strings in the Apache Arrow layout.
+     *
+     * The ith string is made of the bytes `data[offsets[i]]` to `data[offsets[i + 1] - 1]`, so that `offsets` holds
+     * `size() + 1` values starting from 0. This is the layout of Arrow's `string` (32 bits offsets) and `large_string`
+     * (64 bits offsets) arrays.
+     *
+     * A column either owns its buffers, or is a view of external buffers (such as Arrow or numpy buffers shared by the
+     * Python bindings) which are neither copied nor freed, and must outlive it.
+     *
+     * @tparam Offset Offset type, `int32_t` or `int64_t`.
+     */
+    template<class Offset>
+    class BasicStringColumn {
+    public:
+
+        /**
+         * @brief Empty column with owned buffers.
+         */
+        BasicStringColumn() :
+            offset_buffer(1, 0) {
+            point();
+        }
+
+        /**
+         * @brief Column with owned buffers, holding a copy of a list of strings.
+         */
+        explicit BasicStringColumn(const vector<string>& l) :
+            offset_buffer(1, 0) {
+            size_t bytes = 0;
+            for (const string& s : l) {
+                bytes += s.size();
+            }
+            offset_buffer.reserve(l.size() + 1);
+            data_buffer.reserve(bytes);
+            for (const string& s : l) {
+                data_buffer.append(s);
+                offset_buffer.push_back(checkedOffset(data_buffer.size()));
+            }
+            point();
+        }
+
+        BasicStringColumn(const BasicStringColumn& other) :
+            offset_buffer(other.offset_buffer),
+            data_buffer(other.data_buffer),
+            owned(other.owned),
+            length(other.length),
+            offsets(other.offsets),
+            data(other.data) {
+            if (owned) {
+                point();
+            }
+        }
+
+        BasicStringColumn& operator=(const BasicStringColumn& other) {
+            if (this != &other) {
+                offset_buffer = other.offset_buffer;
+                data_buffer = other.data_buffer;
+                owned = other.owned;
+                length = other.length;
+                offsets = other.offsets;
+                data = other.data;
+                if (owned) {
+                    point();
+                }
+            }
+
+            return *this;
+        }
+
+        /**
+         * @brief Column viewing external buffers, which are not copied.
+         *
+         * @param offsets Array of `length + 1` offsets.
+         * @param data Byte buffer of at least `offsets[length]` bytes.
+         * @param length Number of strings.
+         */
+        static BasicStringColumn view(const Offset* offsets, const char* data, size_t length) {
+            BasicStringColumn result;
+            result.offset_buffer.clear();
+            result.owned = false;
+            result.length = length;
+            result.offsets = offsets;
+            result.data = data;
+
+            return result;
+        }
+
+        size_t size() const {
+            return length;
+        }
+
+        string_view operator[](size_t i) const {
+            return string_view(data + offsets[i], offsets[i + 1] - offsets[i]);
+        }
+
+        string_view at(size_t i) const {
+            if (i >= length) {
+                throw runtime_error("Index out of range.");
+            }
+
+            return (*this)[i];
+        }
+
+        /**
+         * @brief Append a string to a column which owns its buffers.
+         */
+        void push_back(string_view s) {
+            if (!owned) {
+                throw runtime_error("Cannot append to a view of external buffers.");
+            }
+            data_buffer.append(s);
+            offset_buffer.push_back(checkedOffset(data_buffer.size()));
+            point();
+        }
+
+        /**
+         * @brief Copy of the strings of the column.
+         */
+        vector<string> toList() const {
+            vector<string> result(length);
+            for (size_t i = 0; i < length; i++) {
+                result[i] = string((*this)[i]);
+            }
+
+            return result;
+        }
+
+        const Offset* offsetData() const {
+            return offsets;
+        }
+
+        const char* byteData() const {
+            return data;
+        }
+
+    private:
+
+        vector<Offset> offset_buffer;
+        string data_buffer;
+        bool owned = true;
+        size_t length = 0;
+        const Offset* offsets = nullptr;
+        const char* data = nullptr;
+
+        /**
+         * @brief Point the column to its owned buffers.
+         */
+        void point() {
+            length = offset_buffer.size() - 1;
+            offsets = offset_buffer.data();
+            data = data_buffer.data();
+        }
+
+        static Offset checkedOffset(size_t offset) {
+            if ((Offset)offset < 0 || (size_t)(Offset)offset != offset) {
+                throw runtime_error("Column data is too large for its offset type.");
+            }
+
+            return (Offset)offset;
+        }
+
+    };
+
+    /**
+     * @brief Column of strings with 32 bits offsets, as Arrow's `string` arrays.
+     */
+    typedef BasicStringColumn<int32_t> StringColumn;
+
+    /**
+     * @brief Column of strings with 64 bits offsets, as Arrow's `large_string` arrays.
+     */
+    typedef BasicStringColumn<int64_t> LargeStringColumn;
+
+}
+
+#endif // STRINGCOMPARE_UTILS_STRINGCOLUMN_HPP_INCLUDED
@@ -0,0 +1,123 @@
+/**
+ * @file unicode.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief UTF-8 decoding to code points for character-level comparisons.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_UTILS_UNICODE_HPP_INCLUDED
+#define STRINGCOMPARE_UTILS_UNICODE_HPP_INCLUDED
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+namespace stringcompare {
+
+    /**
+     * @brief Code point substituted for invalid UTF-8 sequences.
+     */
+    const char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+    /**
+     * @brief Whether or not a string only contains ASCII characters, in which case its bytes are its code points.
+     */
+    inline bool isAscii(string_view s) {
+        unsigned char any = 0;
+        for (size_t i = 0; i < s.size(); i++) {
+            any |= (unsigned char)s[i];
+        }
+
+        return any < 0x80;
+    }
+
+    /**
+     * @brief Decode a UTF-8 string to code points.
+     *
+     * Invalid, overlong or truncated sequences and surrogates are each decoded as one REPLACEMENT_CHARACTER.
+     *
+     * @param s UTF-8 string.
+     * @param out Output code points. Its previous contents are replaced.
+     */
+    inline void decodeUtf8(string_view s, u32string& out) {
+        out.clear();
+        out.reserve(s.size());
+
+        size_t i = 0;
+        size_t n = s.size();
+        while (i < n) {
+            unsigned char c = s[i];
+            if (c < 0x80) {
+                out.push_back(c);
+                i += 1;
+                continue;
+            }
+
+            int length;
+            char32_t code;
+            char32_t smallest;
+            if ((c & 0xE0) == 0xC0) {
+                length = 2;
+                code = c & 0x1F;
+                smallest = 0x80;
+            }
+            else if ((c & 0xF0) == 0xE0) {
+                length = 3;
+                code = c & 0x0F;
+                smallest = 0x800;
+            }
+            else if ((c & 0xF8) == 0xF0) {
+                length = 4;
+                code = c & 0x07;
+                smallest = 0x10000;
+            }
+            else {
+                out.push_back(REPLACEMENT_CHARACTER);
+                i += 1;
+                continue;
+            }
+
+            int k = 1;
+            while (k < length && i + k < n && ((unsigned char)s[i + k] & 0xC0) == 0x80) {
+                code = (code << 6) | ((unsigned char)s[i + k] & 0x3F);
+                k++;
+            }
+
+            if (k < length || code < smallest || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) {
+                out.push_back(REPLACEMENT_CHARACTER);
+            }
+            else {
+                out.push_back(code);
+            }
+            i += k;
+        }
+    }
+
+    /**
+     * @brief Apply `f` to the code points of two UTF-8 strings.
+     *
+     * ASCII strings are passed as is, as `string_view`s, so that no decoding nor copy happens in the common case.
+     * Other strings are decoded into per-thread buffers and passed as `u32string_view`s.
+     *
+     * @param f Callable taking two sequences of characters of the same type.
+     */
+    template<class F>
+    auto withCodePoints(string_view s, string_view t, const F& f) {
+        if (isAscii(s) && isAscii(t)) {
+            return f(s, t);
+        }
+
+        static thread_local u32string s_codes;
+        static thread_local u32string t_codes;
+        decodeUtf8(s, s_codes);
+        decodeUtf8(t, t_codes);
+
+        return f(u32string_view(s_codes), u32string_view(t_codes));
+    }
+
+}
+
+#endif // STRINGCOMPARE_UTILS_UNICODE_HPP_INCLUDED
@@ -0,0 +1,48 @@
+/**
+ * @file main.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Test runner: runs the registered test cases whose name contains the first argument, if any.
+ * @date 2022-04-24
+ *
+ */
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "test.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    string filter = (argc > 1) ? argv[1] : "";
+
+    size_t run = 0;
+    size_t failed = 0;
+    for (const test::TestCase& c : test::registry()) {
+        if (c.name.find(filter) == string::npos) {
+            continue;
+        }
+
+        test::failures() = 0;
+        try {
+            c.run();
+        }
+        catch (const exception& e) {
+            test::fail(string("uncaught exception: ") + e.what(), __FILE__, __LINE__);
+        }
+
+        run++;
+        if (test::failures() > 0) {
+            failed++;
+            cout << "FAILED " << c.name << " (" << test::failures() << " failed checks)" << endl;
+        }
+        else {
+            cout << "ok     " << c.name << endl;
+        }
+    }
+
+    cout << run - failed << " of " << run << " test cases passed." << endl;
+
+    return (failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file reference.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Naive reference implementations of string distances, against which the kernels are tested.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_TESTS_REFERENCE_HPP_INCLUDED
+#define STRINGCOMPARE_TESTS_REFERENCE_HPP_INCLUDED
+
+#include <math.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace reference {
+
+    /**
+     * @brief Levenshtein distance, from the full dynamic programming matrix.
+     */
+    template<class Sequence>
+    int levenshtein(const Sequence& s, const Sequence& t) {
+        size_t m = s.size();
+        size_t n = t.size();
+        vector<vector<int>> d(m + 1, vector<int>(n + 1));
+        for (size_t i = 0; i <= m; i++) {
+            d[i][0] = i;
+        }
+        for (size_t j = 0; j <= n; j++) {
+            d[0][j] = j;
+        }
+        for (size_t i = 1; i <= m; i++) {
+            for (size_t j = 1; j <= n; j++) {
+                d[i][j] = min({ d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + (s[i - 1] != t[j - 1]) });
+            }
+        }
+
+        return d[m][n];
+    }
+
+    /**
+     * @brief Optimal string alignment distance: Levenshtein with transpositions of adjacent characters, which are not
+     * edited further.
+     */
+    template<class Sequence>
+    int osa(const Sequence& s, const Sequence& t) {
+        size_t m = s.size();
+        size_t n = t.size();
+        vector<vector<int>> d(m + 1, vector<int>(n + 1));
+        for (size_t i = 0; i <= m; i++) {
+            d[i][0] = i;
+        }
+        for (size_t j = 0; j <= n; j++) {
+            d[0][j] = j;
+        }
+        for (size_t i = 1; i <= m; i++) {
+            for (size_t j = 1; j <= n; j++) {
+                d[i][j] = min({ d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + (s[i - 1] != t[j - 1]) });
+                if (i > 1 && j > 1 && s[i - 1] == t[j - 2] && s[i - 2] == t[j - 1]) {
+                    d[i][j] = min(d[i][j], d[i - 2][j - 2] + 1);
+                }
+            }
+        }
+
+        return d[m][n];
+    }
+
+    /**
+     * @brief Unrestricted Damerau-Levenshtein distance, from the algorithm of Lowrance and Wagner.
+     */
+    template<class Sequence>
+    int damerauLevenshtein(const Sequence& s, const Sequence& t) {
+        int m = s.size();
+        int n = t.size();
+        int infinity = m + n;
+        vector<vector<int>> d(m + 2, vector<int>(n + 2));
+        d[0][0] = infinity;
+        for (int i = 0; i <= m; i++) {
+            d[i + 1][0] = infinity;
+            d[i + 1][1] = i;
+        }
+        for (int j = 0; j <= n; j++) {
+            d[0][j + 1] = infinity;
+            d[1][j + 1] = j;
+        }
+
+        map<typename Sequence::value_type, int> last_row;
+        for (int i = 1; i <= m; i++) {
+            int last_column = 0;
+            for (int j = 1; j <= n; j++) {
+                auto it = last_row.find(t[j - 1]);
+                int k = (it == last_row.end()) ? 0 : it->second;
+                int l = last_column;
+                int cost = 1;
+                if (s[i - 1] == t[j - 1]) {
+                    cost = 0;
+                    last_column = j;
+                }
+                d[i + 1][j + 1] = min({ d[i][j] + cost, d[i + 1][j] + 1, d[i][j + 1] + 1,
+                    d[k][l] + (i - k - 1) + 1 + (j - l - 1) });
+            }
+            last_row[s[i - 1]] = i;
+        }
+
+        return d[m + 1][n + 1];
+    }
+
+    /**
+     * @brief Length of the longest common subsequence.
+     */
+    template<class Sequence>
+    int lcs(const Sequence& s, const Sequence& t) {
+        size_t m = s.size();
+        size_t n = t.size();
+        vector<vector<int>> d(m + 1, vector<int>(n + 1, 0));
+        for (size_t i = 1; i <= m; i++) {
+            for (size_t j = 1; j <= n; j++) {
+                d[i][j] = (s[i - 1] == t[j - 1]) ? d[i - 1][j - 1] + 1 : max(d[i - 1][j], d[i][j - 1]);
+            }
+        }
+
+        return d[m][n];
+    }
+
+    template<class Sequence>
+    int hamming(const Sequence& s, const Sequence& t) {
+        size_t n = min(s.size(), t.size());
+        int dist = max(s.size(), t.size()) - n;
+        for (size_t i = 0; i < n; i++) {
+            dist += (s[i] != t[i]);
+        }
+
+        return dist;
+    }
+
+    /**
+     * @brief Jaro similarity, matching each character of `s` to the first unmatched equal character of `t` at distance
+     * less than the window.
+     */
+    template<class Sequence>
+    double jaro(const Sequence& s, const Sequence& t) {
+        size_t m = s.size();
+        size_t n = t.size();
+        if (m + n == 0) {
+            return 1.0;
+        }
+        int window = max(1.0, floor(max(m, n) / 2.0) - 1);
+
+        double matches = 0;
+        vector<bool> found_s(m, false);
+        vector<bool> found_t(n, false);
+        for (size_t i = 0; i < m; i++) {
+            for (size_t j = 0; j < n; j++) {
+                if (!found_t[j] && s[i] == t[j] && abs(int(i) - int(j)) < window) {
+                    matches++;
+                    found_s[i] = true;
+                    found_t[j] = true;
+                    break;
+                }
+            }
+        }
+        if (matches == 0) {
+            return 0.0;
+        }
+
+        double transpositions = 0;
+        size_t j = 0;
+        for (size_t i = 0; i < m; i++) {
+            if (found_s[i]) {
+                while (!found_t[j]) {
+                    j++;
+                }
+                transpositions += (s[i] != t[j]);
+                j++;
+            }
+        }
+
+        return (matches / m + matches / n + (matches - transpositions / 2.0) / matches) / 3.0;
+    }
+
+    template<class Sequence>
+    double jaroWinkler(const Sequence& s, const Sequence& t, double p = 0.1) {
+        int ell = 0;
+        while (ell < 4 && size_t(ell) < min(s.size(), t.size()) && s[ell] == t[ell]) {
+            ell++;
+        }
+        double sim = jaro(s, t);
+
+        return sim + ell * p * (1 - sim);
+    }
+
+    /**
+     * @brief Comparison value of an edit distance, given the sum `len` of the string lengths.
+     */
+    inline double editScore(double dist, double len, bool normalize, bool similarity) {
+        if (len == 0) {
+            return similarity;
+        }
+        if (similarity) {
+            double sim = (len - dist) / 2.0;
+            return normalize ? sim / (len - sim) : sim;
+        }
+
+        return normalize ? 2 * dist / (len + dist) : dist;
+    }
+
+    /**
+     * @brief Whether a comparison value beats a score cutoff.
+     */
+    inline bool beats(double value, double cutoff, bool similarity) {
+        return similarity ? (value >= cutoff) : (value <= cutoff);
+    }
+
+}
+
+#endif // STRINGCOMPARE_TESTS_REFERENCE_HPP_INCLUDED
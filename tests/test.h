@@ -0,0 +1,197 @@
+/**
+ * @file test.h
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Test harness: self-registering test cases, checks, and sample strings.
+ * @date 2022-04-24
+ *
+ */
+
+#ifndef STRINGCOMPARE_TESTS_TEST_HPP_INCLUDED
+#define STRINGCOMPARE_TESTS_TEST_HPP_INCLUDED
+
+#include <math.h>
+#include <stdint.h>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "stringcompare/utils/cpu.h"
+
+using namespace std;
+
+namespace test {
+
+    /**
+     * @brief Test case, registered by the TEST_CASE() macro and run by tests/main.cpp.
+     */
+    struct TestCase {
+        string name;
+        void (*run)();
+    };
+
+    inline vector<TestCase>& registry() {
+        static vector<TestCase> cases;
+        return cases;
+    }
+
+    /**
+     * @brief Number of failed checks of the running test case.
+     */
+    inline size_t& failures() {
+        static size_t count = 0;
+        return count;
+    }
+
+    struct Registration {
+        Registration(const char* name, void (*run)()) {
+            registry().push_back(TestCase{ name, run });
+        }
+    };
+
+    /**
+     * @brief Record a failed check. Only the first failures of a test case are printed.
+     */
+    inline void fail(const string& message, const char* file, int line) {
+        if (failures()++ < 10) {
+            cerr << "    " << file << ":" << line << ": " << message << endl;
+        }
+    }
+
+    template<class T>
+    string show(const T& value) {
+        ostringstream out;
+        out << value;
+        return out.str();
+    }
+
+    inline string show(const string& value) {
+        return "\"" + value + "\"";
+    }
+
+    /**
+     * @brief Whether two comparison values are equal, up to rounding errors. NaN is equal to NaN.
+     */
+    inline bool near(double a, double b, double eps = 1e-9) {
+        if (isnan(a) || isnan(b)) {
+            return isnan(a) && isnan(b);
+        }
+        return fabs(a - b) <= eps * max(1.0, fabs(b));
+    }
+
+    /**
+     * @brief Edge cases of string inputs: empty strings, single characters, strings around 64 bytes (the width of
+     * bit-parallel kernels) and longer, and UTF-8 encoded non-ASCII text.
+     */
+    inline vector<string> edgeStrings() {
+        return {
+            "", "a", "b", "ab", "ba", "abc", "acb", "ca", "abcd", "dcba",
+            "kitten", "sitting", "martha", "marhta", "dixon", "dicksonx", "jellyfish", "smellyfish",
+            string(63, 'a'), string(64, 'a'), string(65, 'a'), string(64, 'a') + "b", "b" + string(64, 'a'),
+            string(127, 'x') + "y", string(200, 'z'),
+            "héllo", "hello", "hèllo", "naïve", "naive", "straße", "strasse", "日本語", "日本", "本日",
+            "Ελληνικά", "ελληνικα", "😀a", "a😀",
+        };
+    }
+
+    /**
+     * @brief Random strings over the first `alphabet` letters, and sometimes a non-ASCII character, with lengths from 0 to
+     * `max_length`.
+     */
+    inline vector<string> randomStrings(mt19937& gen, size_t n, size_t max_length, int alphabet = 4) {
+        vector<string> result;
+        for (size_t i = 0; i < n; i++) {
+            size_t length = gen() % (max_length + 1);
+            string s;
+            while (s.size() < length) {
+                if (gen() % 16 == 0) {
+                    s += "é";
+                }
+                else {
+                    s += char('a' + gen() % alphabet);
+                }
+            }
+            result.push_back(s);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Edge cases followed by random strings, short and long.
+     */
+    inline vector<string> sampleStrings(unsigned seed = 1, size_t n = 60) {
+        mt19937 gen(seed);
+        vector<string> result = edgeStrings();
+        for (const string& s : randomStrings(gen, n, 12)) {
+            result.push_back(s);
+        }
+        for (const string& s : randomStrings(gen, n / 2, 150)) {
+            result.push_back(s);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Run `f()` with kernels restricted to each instruction set level in turn, so that every dispatched kernel
+     * supported by the CPU is tested. See stringcompare::setCpuLevel().
+     */
+    template<class F>
+    void forEachCpuLevel(const F& f) {
+        for (int level = stringcompare::CPU_SCALAR; level <= stringcompare::CPU_AVX512; level++) {
+            stringcompare::setCpuLevel(stringcompare::CpuLevel(level));
+            f();
+        }
+        stringcompare::setCpuLevel(stringcompare::CPU_AVX512);
+    }
+
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static test::Registration name##_registration(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            test::fail("CHECK(" #condition ") failed", __FILE__, __LINE__); \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        auto check_a = (a); \
+        auto check_b = (b); \
+        if (!(check_a == check_b)) { \
+            test::fail("CHECK_EQ(" #a ", " #b ") failed: " + test::show(check_a) + " != " + test::show(check_b), __FILE__, __LINE__); \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(a, b) \
+    do { \
+        double check_a = (a); \
+        double check_b = (b); \
+        if (!test::near(check_a, check_b)) { \
+            test::fail("CHECK_NEAR(" #a ", " #b ") failed: " + test::show(check_a) + " != " + test::show(check_b), __FILE__, __LINE__); \
+        } \
+    } while (0)
+
+#define CHECK_THROWS(statement) \
+    do { \
+        bool check_thrown = false; \
+        try { \
+            statement; \
+        } \
+        catch (const exception&) { \
+            check_thrown = true; \
+        } \
+        if (!check_thrown) { \
+            test::fail("CHECK_THROWS(" #statement ") failed", __FILE__, __LINE__); \
+        } \
+    } while (0)
+
+#endif // STRINGCOMPARE_TESTS_TEST_HPP_INCLUDED
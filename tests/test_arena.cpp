@@ -0,0 +1,159 @@
+/**
+ * @file test_arena.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Tests of the byte arena, and of arena-backed and parallel batch tokenization.
+ * @date 2022-04-24
+ *
+ */
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "stringcompare/preprocessing/counter.h"
+#include "stringcompare/preprocessing/tokenizer.h"
+#include "stringcompare/utils/arena.h"
+#include "stringcompare/utils/stringcolumn.h"
+
+#include "test.h"
+
+using namespace std;
+using namespace stringcompare;
+
+namespace {
+
+    /**
+     * @brief Random strings, some of them longer than arena chunks.
+     */
+    vector<string> arenaStrings(mt19937& gen, size_t n) {
+        vector<string> result = test::edgeStrings();
+        for (size_t i = 0; i < n; i++) {
+            size_t length = (gen() % 50 == 0) ? ByteArena::CHUNK_SIZE - 10 + gen() % 20 : gen() % 3000;
+            string s(length, ' ');
+            for (char& c : s) {
+                c = char(gen());
+            }
+            result.push_back(s);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Sentences of more than one tile of batch tokenization.
+     */
+    vector<string> sentences() {
+        mt19937 gen(51);
+        vector<string> words = test::edgeStrings();
+        vector<string> result;
+        for (size_t i = 0; i < 3 * TOKENIZE_TILE + 17; i++) {
+            string s;
+            size_t n = gen() % 10;
+            for (size_t k = 0; k < n; k++) {
+                s += words[gen() % words.size()] + " ";
+            }
+            result.push_back(s);
+        }
+        return result;
+    }
+
+    void checkCounter(const StringCounterView& view, const StringCounter& counter) {
+        CHECK_EQ(view.total(), counter.total());
+        CHECK_EQ(view.unique(), counter.unique());
+        for (const CounterEntry& entry : counter.getEntries()) {
+            CHECK_EQ(view.count(entry.element), entry.count);
+        }
+        CHECK_EQ(view.count("not a token"), 0ul);
+        for (size_t i = 0; i + 1 < view.length; i++) {
+            CHECK(view.entries[i].hash < view.entries[i + 1].hash
+                || (view.entries[i].hash == view.entries[i + 1].hash && view.entries[i].element < view.entries[i + 1].element));
+        }
+    }
+
+}
+
+TEST_CASE(byte_arena) {
+    mt19937 gen(52);
+    vector<string> stored = arenaStrings(gen, 400);
+    vector<string> strings;
+    vector<string_view> views;
+    ByteArena arena;
+    for (size_t i = 0; i < stored.size(); i++) {
+        strings.push_back(stored[i]);
+        views.push_back(arena.store(stored[i]));
+
+        // Strings of other arenas are taken over and stay valid.
+        if (i % 100 == 50) {
+            ByteArena other;
+            for (size_t j = 0; j < 40; j++) {
+                strings.push_back(stored[j * 7 % stored.size()]);
+                views.push_back(other.store(strings.back()));
+            }
+            arena.splice(other);
+            CHECK_EQ(string(other.store("abc")), string("abc"));
+        }
+    }
+
+    CHECK_EQ(strings.size(), views.size());
+    for (size_t i = 0; i < strings.size(); i++) {
+        CHECK(views[i] == strings[i]);
+    }
+    arena.clear();
+    CHECK(arena.store("").empty());
+    CHECK_EQ(string(arena.store("héllo")), string("héllo"));
+}
+
+TEST_CASE(string_counter_batch) {
+    vector<string> l = sentences();
+    StringColumn column(l);
+    WhitespaceTokenizer tokenizer;
+
+    for (int nthreads : { 1, 4 }) {
+        StringCounterBatch batch = tokenizer.batchCount(l, nthreads);
+        StringCounterBatch column_batch = tokenizer.batchCount(column, nthreads);
+        vector<StringCounter> counters = tokenizer.batchTokenize(l, nthreads);
+        vector<StringCounter> column_counters = tokenizer.batchTokenize(column, nthreads);
+        CHECK_EQ(batch.size(), l.size());
+        CHECK_EQ(column_batch.size(), l.size());
+        CHECK_EQ(counters.size(), l.size());
+        CHECK_EQ(column_counters.size(), l.size());
+
+        for (size_t i = 0; i < l.size(); i++) {
+            StringCounter counter = tokenizer.tokenize(l[i]);
+            checkCounter(batch[i], counter);
+            checkCounter(column_batch[i], counter);
+            CHECK(counters[i].getDict() == counter.getDict());
+            CHECK(column_counters[i].getDict() == counter.getDict());
+
+            size_t j = (i * 11) % l.size();
+            StringCounter other = tokenizer.tokenize(l[j]);
+            CHECK_EQ(batch[i].intersectionCount(batch[j]), counter.intersectionCount(other));
+            CHECK_EQ(batch[i].unionCount(column_batch[j]), counter.unionCount(other));
+        }
+    }
+
+    // Appended batches own the strings of the other batch, which is cleared.
+    StringCounterBatch batch;
+    StringCounterBatch other;
+    vector<string_view> tokens = { "b", "a", "héllo", "b", "" };
+    batch.push_back(tokens.data(), tokens.size());
+    batch.push_back(nullptr, 0);
+    {
+        string long_token(2 * ByteArena::CHUNK_SIZE, 'x');
+        vector<string_view> other_tokens = { long_token, "a", long_token };
+        other.push_back(other_tokens.data(), other_tokens.size());
+    }
+    batch.append(other);
+    CHECK_EQ(other.size(), 0ul);
+    CHECK_EQ(batch.size(), 3ul);
+    CHECK_EQ(batch[0].count("b"), 2ul);
+    CHECK_EQ(batch[0].count(""), 1ul);
+    CHECK_EQ(batch[0].unique(), 4ul);
+    CHECK_EQ(batch[1].total(), 0ul);
+    CHECK_EQ(batch[2].count(string(2 * ByteArena::CHUNK_SIZE, 'x')), 2ul);
+    CHECK_EQ(batch[2].intersectionCount(batch[0]), 1ul);
+
+    batch.clear();
+    CHECK_EQ(batch.size(), 0ul);
+    CHECK(batch.entries.empty());
+}
@@ -0,0 +1,168 @@
+/**
+ * @file test_batch.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Tests of the one-to-many batch kernels of Levenshtein and Hamming.
+ * @date 2022-04-24
+ *
+ */
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "stringcompare/distance/hamming.h"
+#include "stringcompare/distance/levenshtein.h"
+
+#include "reference.h"
+#include "test.h"
+
+using namespace std;
+using namespace stringcompare;
+
+namespace {
+
+    /**
+     * @brief Reference Levenshtein distances between all pairs of sample strings.
+     */
+    const vector<vector<int>>& levenshteinMatrix(const vector<string>& l) {
+        static vector<vector<int>> d;
+        if (d.empty()) {
+            for (const string& s : l) {
+                d.emplace_back();
+                for (const string& t : l) {
+                    d.back().push_back(reference::levenshtein(s, t));
+                }
+            }
+        }
+        return d;
+    }
+
+    /**
+     * @brief Check a row of comparisons with a cutoff: values beating the cutoff are exact, and others do not beat it.
+     */
+    void checkCutoffRow(const double* values, const vector<double>& exact, double cutoff, bool similarity) {
+        for (size_t j = 0; j < exact.size(); j++) {
+            if (reference::beats(exact[j], cutoff, similarity)) {
+                CHECK_NEAR(values[j], exact[j]);
+            }
+            else {
+                CHECK(!reference::beats(values[j], cutoff, similarity) || test::near(values[j], exact[j]));
+            }
+        }
+    }
+
+}
+
+TEST_CASE(levenshtein_distance) {
+    vector<string> l = test::sampleStrings();
+    const auto& d = levenshteinMatrix(l);
+    test::forEachCpuLevel([&] {
+        for (size_t i = 0; i < l.size(); i++) {
+            for (size_t j = 0; j < l.size(); j++) {
+                CHECK_EQ(Levenshtein::levenshtein(l[i], l[j]), d[i][j]);
+                for (int k : { 0, 1, 3, 70 }) {
+                    int bounded = Levenshtein::levenshtein(l[i], l[j], k);
+                    CHECK((d[i][j] <= k) ? (bounded == d[i][j]) : (bounded > k));
+                }
+            }
+        }
+    });
+}
+
+TEST_CASE(levenshtein_compare_many) {
+    vector<string> l = test::sampleStrings();
+    vector<string_view> views(l.begin(), l.end());
+    const auto& d = levenshteinMatrix(l);
+
+    test::forEachCpuLevel([&] {
+        for (bool normalize : { true, false }) {
+            for (bool similarity : { false, true }) {
+                Levenshtein comparator(normalize, similarity);
+                vector<double> out(l.size());
+                for (size_t i = 0; i < l.size(); i++) {
+                    vector<double> exact(l.size());
+                    for (size_t j = 0; j < l.size(); j++) {
+                        exact[j] = reference::editScore(d[i][j], l[i].size() + l[j].size(), normalize, similarity);
+                    }
+
+                    comparator.compareMany(l[i], l.data(), l.size(), out.data());
+                    for (size_t j = 0; j < l.size(); j++) {
+                        CHECK_NEAR(out[j], exact[j]);
+                    }
+                    comparator.compareManyViews(views[i], views.data(), views.size(), out.data());
+                    for (size_t j = 0; j < l.size(); j++) {
+                        CHECK_NEAR(out[j], exact[j]);
+                    }
+                    Levenshtein::Cached cached = comparator.prepare(l[i]);
+                    cached.compareMany(l.data(), l.size(), out.data());
+                    for (size_t j = 0; j < l.size(); j++) {
+                        CHECK_NEAR(out[j], exact[j]);
+                    }
+
+                    for (double cutoff : { 0.0, 0.3, 0.5, 2.0, 10.0 }) {
+                        comparator.compareMany(l[i], l.data(), l.size(), out.data(), cutoff);
+                        checkCutoffRow(out.data(), exact, cutoff, similarity);
+                        comparator.compareManyViews(views[i], views.data(), views.size(), out.data(), cutoff);
+                        checkCutoffRow(out.data(), exact, cutoff, similarity);
+                        cached.compareMany(l.data(), l.size(), out.data(), cutoff);
+                        checkCutoffRow(out.data(), exact, cutoff, similarity);
+                    }
+                }
+            }
+        }
+    });
+}
+
+TEST_CASE(static_levenshtein_compare_many) {
+    vector<string> l = test::sampleStrings();
+    const auto& d = levenshteinMatrix(l);
+
+    test::forEachCpuLevel([&] {
+        StaticLevenshtein<true, false> comparator;
+        vector<double> out(l.size());
+        for (size_t i = 0; i < l.size(); i++) {
+            vector<double> exact(l.size());
+            for (size_t j = 0; j < l.size(); j++) {
+                exact[j] = reference::editScore(d[i][j], l[i].size() + l[j].size(), true, false);
+            }
+
+            comparator.compareMany(l[i], l.data(), l.size(), out.data());
+            for (size_t j = 0; j < l.size(); j++) {
+                CHECK_NEAR(out[j], exact[j]);
+            }
+            for (double cutoff : { 0.0, 0.25, 0.6 }) {
+                comparator.compareMany(l[i], l.data(), l.size(), out.data(), cutoff);
+                checkCutoffRow(out.data(), exact, cutoff, false);
+            }
+        }
+    });
+}
+
+TEST_CASE(hamming_compare_many) {
+    vector<string> l = test::sampleStrings();
+    vector<string_view> views(l.begin(), l.end());
+
+    test::forEachCpuLevel([&] {
+        for (bool normalize : { true, false }) {
+            for (bool similarity : { false, true }) {
+                Hamming comparator(normalize, similarity);
+                vector<double> out(l.size());
+                for (size_t i = 0; i < l.size(); i++) {
+                    comparator.compareMany(l[i], l.data(), l.size(), out.data());
+                    for (size_t j = 0; j < l.size(); j++) {
+                        double len = max(l[i].size(), l[j].size());
+                        double dist = reference::hamming(l[i], l[j]);
+                        double value = similarity ? len - dist : dist;
+                        double exact = (len == 0) ? similarity : (normalize ? value / len : value);
+                        CHECK_NEAR(out[j], exact);
+                        CHECK_NEAR(comparator.compare(l[i], l[j]), exact);
+                    }
+
+                    vector<double> from_views(l.size());
+                    comparator.compareManyViews(views[i], views.data(), views.size(), from_views.data());
+                    CHECK(from_views == out);
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,231 @@
+/**
+ * @file test_bloom.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Tests of Bloom filter encoding, and of Bloom filter comparisons against naive bit counts.
+ * @date 2022-04-24
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "stringcompare/distance/bloom.h"
+#include "stringcompare/preprocessing/bloomfilter.h"
+#include "stringcompare/utils/stringcolumn.h"
+
+#include "test.h"
+
+using namespace std;
+using namespace stringcompare;
+
+namespace {
+
+    bool bit(const uint64_t* a, size_t k) {
+        return (a[k / 64] >> (k % 64)) & 1;
+    }
+
+    size_t naiveBitCount(const uint64_t* a, size_t num_bits) {
+        size_t count = 0;
+        for (size_t k = 0; k < num_bits; k++) {
+            count += bit(a, k);
+        }
+        return count;
+    }
+
+    size_t naiveIntersectionCount(const uint64_t* a, const uint64_t* b, size_t num_bits) {
+        size_t count = 0;
+        for (size_t k = 0; k < num_bits; k++) {
+            count += bit(a, k) && bit(b, k);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Random filters, with sparse, dense, empty and full words.
+     */
+    BloomFilters randomFilters(mt19937_64& gen, size_t num_bits, size_t count) {
+        BloomFilters result(num_bits, count);
+        for (uint64_t& word : result.data) {
+            switch (gen() % 4) {
+            case 0:
+                word = gen() & gen() & gen();
+                break;
+            case 1:
+                word = gen();
+                break;
+            case 2:
+                word = 0;
+                break;
+            default:
+                word = ~uint64_t(0);
+            }
+        }
+        // Bits past num_bits are zero.
+        if (num_bits % 64 != 0) {
+            for (size_t i = 0; i < count; i++) {
+                result[i][result.words - 1] &= (uint64_t(1) << (num_bits % 64)) - 1;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Check the batch functions of a Bloom comparator against comparisons of naive bit counts.
+     */
+    void checkComparator(const BloomComparator& comparator, const BloomFilters& f1, const BloomFilters& f2) {
+        size_t num_bits = f1.num_bits;
+        auto exact = [&](const uint64_t* a, const uint64_t* b) {
+            return comparator.compareCounts(naiveIntersectionCount(a, b, num_bits), naiveBitCount(a, num_bits), naiveBitCount(b, num_bits), num_bits);
+        };
+
+        Mat<double> pairwise = comparator.pairwise(f1, f2, 2);
+        vector<float> buffer(f1.size() * f2.size());
+        comparator.pairwise(f1, f2, buffer.data());
+        for (size_t i = 0; i < f1.size(); i++) {
+            for (size_t j = 0; j < f2.size(); j++) {
+                double value = exact(f1[i], f2[j]);
+                CHECK_NEAR(pairwise[i][j], value);
+                CHECK_NEAR(comparator.compareFilters(f1[i], f2[j], num_bits), value);
+                CHECK(fabs(buffer[i * f2.size() + j] - value) <= 1e-6 * max(1.0, fabs(value)));
+            }
+        }
+
+        vector<double> condensed = comparator.condensed(f1, 3);
+        for (size_t i = 0; i < f1.size(); i++) {
+            for (size_t j = i + 1; j < f1.size(); j++) {
+                CHECK_NEAR(condensed[condensedIndex(f1.size(), i, j)], exact(f1[i], f1[j]));
+            }
+        }
+
+        BloomFilters head(num_bits, min(f1.size(), f2.size()));
+        memcpy(head.data.data(), f2.data.data(), head.data.size() * sizeof(uint64_t));
+        BloomFilters first(num_bits, head.size());
+        memcpy(first.data.data(), f1.data.data(), first.data.size() * sizeof(uint64_t));
+        vector<double> elementwise = comparator.elementwise(first, head);
+        for (size_t i = 0; i < head.size(); i++) {
+            CHECK_NEAR(elementwise[i], exact(f1[i], f2[i]));
+        }
+
+        CHECK_THROWS(comparator.pairwise(f1, BloomFilters(num_bits + 64, 2)));
+    }
+
+}
+
+TEST_CASE(bloom_bit_counts) {
+    mt19937_64 gen(61);
+    test::forEachCpuLevel([&] {
+        for (size_t num_bits : { 1, 63, 64, 65, 128, 1000, 1024, 2050 }) {
+            BloomFilters a = randomFilters(gen, num_bits, 1);
+            BloomFilters b = randomFilters(gen, num_bits, 37);
+            vector<uint32_t> counts(b.size());
+            BloomComparator::intersectionCounts(a[0], b[0], b.size(), b.words, counts.data());
+
+            CHECK_EQ(BloomComparator::bitCount(a[0], a.words), naiveBitCount(a[0], num_bits));
+            for (size_t i = 0; i < b.size(); i++) {
+                size_t expected = naiveIntersectionCount(a[0], b[i], num_bits);
+                CHECK_EQ(BloomComparator::intersectionCount(a[0], b[i], b.words), expected);
+                CHECK_EQ((size_t)counts[i], expected);
+            }
+        }
+    });
+}
+
+TEST_CASE(bloom_comparators) {
+    mt19937_64 gen(62);
+    test::forEachCpuLevel([&] {
+        for (size_t num_bits : { 64, 100, 1024 }) {
+            BloomFilters f1 = randomFilters(gen, num_bits, 23);
+            BloomFilters f2 = randomFilters(gen, num_bits, 41);
+            for (bool similarity : { false, true }) {
+                checkComparator(BloomDice(BloomEncoder(), similarity), f1, f2);
+                checkComparator(BloomJaccard(BloomEncoder(), similarity), f1, f2);
+                checkComparator(BloomHamming(BloomEncoder(), true, similarity), f1, f2);
+                checkComparator(BloomHamming(BloomEncoder(), false, similarity), f1, f2);
+            }
+        }
+    });
+
+    // Empty filters are identical.
+    BloomFilters empty(1024, 2);
+    CHECK_NEAR(BloomDice().compareFilters(empty[0], empty[1], 1024), 0.0);
+    CHECK_NEAR(BloomJaccard(BloomEncoder(), true).compareFilters(empty[0], empty[1], 1024), 1.0);
+}
+
+TEST_CASE(bloom_encoder) {
+    vector<string> l = test::sampleStrings(6, 40);
+    StringColumn column(l);
+    CHECK_THROWS(BloomEncoder(NGramTokenizer(2), 0));
+    CHECK_THROWS(BloomEncoder(NGramTokenizer(2), 1024, 0));
+
+    for (size_t num_bits : { 1024, 1000, 77 }) {
+        BloomEncoder encoder(NGramTokenizer(2), num_bits, 5, 7);
+        BloomFilters filters = encoder.encodeMany(l, 4);
+        BloomFilters column_filters = encoder.encodeMany(column);
+        CHECK_EQ(filters.size(), l.size());
+        CHECK_EQ(filters.words, encoder.words());
+        CHECK(filters.data == column_filters.data);
+
+        for (size_t i = 0; i < l.size(); i++) {
+            vector<uint64_t> filter = encoder.encode(l[i]);
+            CHECK(equal(filter.begin(), filter.end(), filters[i]));
+            CHECK(encoder.encode(string(l[i])) == filter);
+            CHECK_EQ(BloomComparator::bitCount(filter.data(), filter.size()), naiveBitCount(filter.data(), num_bits));
+
+            // The filter of a string is the union of the filters of its bigrams, each of which sets at most 5 bits.
+            vector<uint64_t> expected(encoder.words(), 0);
+            for (size_t k = 0; k + 2 <= l[i].size(); k++) {
+                vector<uint64_t> token = encoder.encode(l[i].substr(k, 2));
+                CHECK(BloomComparator::bitCount(token.data(), token.size()) <= 5);
+                for (size_t w = 0; w < expected.size(); w++) {
+                    expected[w] |= token[w];
+                }
+            }
+            CHECK(filter == expected);
+        }
+
+        // Filters depend on the key.
+        BloomEncoder other(NGramTokenizer(2), num_bits, 5, 8);
+        CHECK(other.encode("martha") != encoder.encode("martha"));
+    }
+
+    BloomDice comparator;
+    CHECK_NEAR(comparator.compare("martha", "martha"), 0.0);
+    CHECK_NEAR(comparator.compare("", ""), 0.0);
+    CHECK_NEAR(comparator.compare("héllo", "héllo"), 0.0);
+    CHECK(comparator.compare("martha", "marhta") < comparator.compare("martha", "dixon"));
+}
+
+TEST_CASE(bloom_from_bytes) {
+    mt19937_64 gen(63);
+    for (size_t num_bits : { 8, 77, 1000, 1024 }) {
+        size_t nbytes = (num_bits + 7) / 8;
+        size_t count = 9;
+        vector<uint8_t> bytes(count * nbytes);
+        for (uint8_t& byte : bytes) {
+            byte = (uint8_t)gen();
+        }
+
+        BloomFilters filters = BloomFilters::fromBytes(bytes.data(), count, num_bits);
+        CHECK_EQ(filters.size(), count);
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t* filter = (const uint8_t*)filters[i];
+            size_t expected_bits = 0;
+            for (size_t k = 0; k < nbytes; k++) {
+                uint8_t expected = bytes[i * nbytes + k];
+                if (k == nbytes - 1 && num_bits % 8 != 0) {
+                    expected &= (1u << (num_bits % 8)) - 1;
+                }
+                CHECK_EQ((int)filter[k], (int)expected);
+                expected_bits += popcount64(expected);
+            }
+            for (size_t k = nbytes; k < filters.words * 8; k++) {
+                CHECK_EQ((int)filter[k], 0);
+            }
+            CHECK_EQ(BloomComparator::bitCount(filters[i], filters.words), expected_bits);
+        }
+    }
+}
@@ -0,0 +1,193 @@
+/**
+ * @file test_column.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Tests of string columns, of the batch functions over columns, and of the comparison engine.
+ * @date 2022-04-24
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "stringcompare/distance/dameraulevenshtein.h"
+#include "stringcompare/distance/hamming.h"
+#include "stringcompare/distance/jaro.h"
+#include "stringcompare/distance/jarowinkler.h"
+#include "stringcompare/distance/lcs.h"
+#include "stringcompare/distance/levenshtein.h"
+#include "stringcompare/linkage/comparisonengine.h"
+#include "stringcompare/utils/stringcolumn.h"
+
+#include "test.h"
+
+using namespace std;
+using namespace stringcompare;
+
+namespace {
+
+    void checkNear(const vector<double>& a, const vector<double>& b) {
+        CHECK_EQ(a.size(), b.size());
+        for (size_t i = 0; i < min(a.size(), b.size()); i++) {
+            CHECK_NEAR(a[i], b[i]);
+        }
+    }
+
+    void checkMatches(const vector<pair<size_t, double>>& a, const vector<pair<size_t, double>>& b) {
+        CHECK_EQ(a.size(), b.size());
+        for (size_t i = 0; i < min(a.size(), b.size()); i++) {
+            CHECK_EQ(a[i].first, b[i].first);
+            CHECK_NEAR(a[i].second, b[i].second);
+        }
+    }
+
+    /**
+     * @brief Check that the batch functions over columns agree with the ones over vectors.
+     */
+    template<class C>
+    void checkColumnBatch(const C& comparator, const vector<string>& l, const vector<double>& cutoffs) {
+        StringColumn column(l);
+        vector<string> reversed(l.rbegin(), l.rend());
+        StringColumn reversed_column(reversed);
+
+        checkNear(comparator.elementwise(column, reversed_column), comparator.elementwise(l, reversed));
+        checkNear(comparator.elementwise(column, reversed_column, 4), comparator.elementwise(l, reversed));
+        checkNear(comparator.condensed(column, 3), comparator.condensed(l));
+
+        Mat<double> pairwise = comparator.pairwise(l, reversed);
+        Mat<double> column_pairwise = comparator.pairwise(column, reversed_column, 2);
+        CHECK_EQ(column_pairwise.size(), pairwise.size());
+        vector<float> buffer(l.size() * l.size());
+        comparator.pairwise(column, reversed_column, buffer.data());
+        for (size_t i = 0; i < min(pairwise.size(), column_pairwise.size()); i++) {
+            checkNear(column_pairwise[i], pairwise[i]);
+            for (size_t j = 0; j < l.size(); j++) {
+                CHECK_NEAR(buffer[i * l.size() + j], (float)pairwise[i][j]);
+            }
+        }
+
+        for (size_t i = 0; i < l.size(); i += 7) {
+            checkMatches(comparator.extract(l[i], column, 5), comparator.extract(l[i], l, 5));
+            CHECK(comparator.extractOne(l[i], column) == comparator.extractOne(l[i], l));
+            for (double cutoff : cutoffs) {
+                checkMatches(comparator.extract(l[i], column, 5, cutoff), comparator.extract(l[i], l, 5, cutoff));
+                CHECK(comparator.extractOne(l[i], column, cutoff) == comparator.extractOne(l[i], l, cutoff));
+            }
+        }
+    }
+
+    template<class Cached>
+    void checkCachedExtract(const Cached& cached, const vector<string>& l, const vector<double>& cutoffs) {
+        StringColumn column(l);
+        checkMatches(cached.extract(column, 5), cached.extract(l, 5));
+        CHECK(cached.extractOne(column) == cached.extractOne(l));
+        for (double cutoff : cutoffs) {
+            checkMatches(cached.extract(column, 5, cutoff), cached.extract(l, 5, cutoff));
+            CHECK(cached.extractOne(column, cutoff) == cached.extractOne(l, cutoff));
+        }
+    }
+
+}
+
+TEST_CASE(string_column) {
+    vector<string> l = test::sampleStrings();
+    StringColumn column(l);
+    CHECK_EQ(column.size(), l.size());
+    CHECK(column.toList() == l);
+    for (size_t i = 0; i < l.size(); i++) {
+        CHECK_EQ(string(column[i]), l[i]);
+        CHECK_EQ(string(column.at(i)), l[i]);
+    }
+    CHECK_THROWS(column.at(l.size()));
+
+    StringColumn appended;
+    CHECK_EQ(appended.size(), 0ul);
+    for (const string& s : l) {
+        appended.push_back(s);
+    }
+    CHECK(appended.toList() == l);
+
+    // Copies own their buffers, and views read external buffers in place.
+    StringColumn copy = column;
+    copy.push_back("extra");
+    CHECK_EQ(column.size(), l.size());
+    CHECK_EQ(string(copy[l.size()]), string("extra"));
+
+    LargeStringColumn large(l);
+    StringColumn view = StringColumn::view(column.offsetData(), column.byteData(), column.size());
+    CHECK(view.toList() == l);
+    CHECK(large.toList() == l);
+    CHECK_EQ(view.byteData(), column.byteData());
+    CHECK_THROWS(view.push_back("a"));
+}
+
+TEST_CASE(column_batch) {
+    vector<string> l = test::sampleStrings(2, 40);
+    test::forEachCpuLevel([&] {
+        checkColumnBatch(Levenshtein(), l, { 0.0, 0.4 });
+        checkColumnBatch(Levenshtein(false, true), l, { 3.0, 20.0 });
+        checkColumnBatch(DamerauLevenshtein(), l, { 0.0, 0.4 });
+        checkColumnBatch(DamerauLevenshtein(true, false, 100, true), l, { 0.4 });
+        checkColumnBatch(LCSDistance(false, false), l, { 0.0, 5.0 });
+        checkColumnBatch(Hamming(), l, { 0.5 });
+        checkColumnBatch(Jaro(), l, { 0.2 });
+        checkColumnBatch(JaroWinkler(true), l, { 0.8 });
+        checkColumnBatch(StaticLevenshtein<true, false>(), l, { 0.4 });
+        checkColumnBatch(StaticJaro<true>(), l, { 0.8 });
+        checkColumnBatch(DynamicComparator<StaticJaroWinkler<false>>(), l, { 0.2 });
+        checkColumnBatch(DynamicComparator<StaticLCSDistance<true, true>>(), l, { 0.5 });
+    });
+}
+
+TEST_CASE(column_cached_extract) {
+    vector<string> l = test::sampleStrings(3, 40);
+    test::forEachCpuLevel([&] {
+        for (size_t i = 0; i < l.size(); i += 9) {
+            checkCachedExtract(Levenshtein().prepare(l[i]), l, { 0.0, 0.4 });
+            checkCachedExtract(Levenshtein(false, true).prepare(l[i]), l, { 4.0 });
+            checkCachedExtract(DamerauLevenshtein().prepare(l[i]), l, { 0.4 });
+            checkCachedExtract(LCSDistance().prepare(l[i]), l, { 0.4 });
+            checkCachedExtract(Jaro(true).prepare(l[i]), l, { 0.8 });
+            checkCachedExtract(JaroWinkler().prepare(l[i]), l, { 0.2 });
+        }
+    });
+}
+
+TEST_CASE(comparison_engine_tables) {
+    vector<string> names = test::sampleStrings(4, 40);
+    vector<string> cities(names.rbegin(), names.rend());
+    cities[3] = "";
+    RecordTable records = { names, cities };
+    ColumnTable columns = { StringColumn(names), StringColumn(cities) };
+
+    ComparisonEngine engine;
+    engine.add(0, 0, Levenshtein(), { 0.5, 0.2 });
+    engine.add(1, 1, JaroWinkler(true), { 0.8, 0.95 });
+    engine.add(0, 1, DamerauLevenshtein(false, false), { 4, 1 });
+
+    vector<pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < names.size(); i++) {
+        for (size_t j = 0; j < names.size(); j += 1 + i % 5) {
+            pairs.emplace_back((i * 13) % names.size(), j);
+        }
+    }
+
+    vector<double> values = engine.compare(records, records, pairs);
+    checkNear(engine.compare(columns, columns, pairs, 4), values);
+    vector<uint8_t> levels = engine.levels(records, records, pairs, 3);
+    CHECK(engine.levels(columns, columns, pairs) == levels);
+
+    CHECK_EQ(values.size(), pairs.size() * engine.size());
+    CHECK_EQ(levels.size(), pairs.size() * engine.size());
+    for (size_t p = 0; p < pairs.size(); p++) {
+        for (size_t f = 0; f < engine.size(); f++) {
+            const FieldComparison& field = engine.fields[f];
+            const string& s = records[field.left_column][pairs[p].first];
+            const string& t = records[field.right_column][pairs[p].second];
+            double expected = (s.empty() || t.empty()) ? NAN : field.comparator->compare(s, t);
+            CHECK_NEAR(values[p * engine.size() + f], expected);
+            CHECK_EQ((int)levels[p * engine.size() + f], (int)field.level(expected));
+        }
+    }
+}
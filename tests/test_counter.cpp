@@ -0,0 +1,185 @@
+/**
+ * @file test_counter.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Tests of the StringCounter and IdCounter multisets against std::map.
+ * @date 2022-04-24
+ *
+ */
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "stringcompare/preprocessing/counter.h"
+
+#include "test.h"
+
+using namespace std;
+using namespace stringcompare;
+
+namespace {
+
+    template<class K>
+    count_t intersectionCount(const map<K, count_t>& a, const map<K, count_t>& b) {
+        count_t sum = 0;
+        for (const auto& entry : a) {
+            auto it = b.find(entry.first);
+            if (it != b.end()) {
+                sum += min(entry.second, it->second);
+            }
+        }
+        return sum;
+    }
+
+    template<class K>
+    count_t total(const map<K, count_t>& a) {
+        count_t sum = 0;
+        for (const auto& entry : a) {
+            sum += entry.second;
+        }
+        return sum;
+    }
+
+    void insert(map<string, count_t>& a, const string& element) {
+        a[element]++;
+    }
+
+    void remove(map<string, count_t>& a, const string& element) {
+        auto it = a.find(element);
+        if (it != a.end() && --it->second == 0) {
+            a.erase(it);
+        }
+    }
+
+}
+
+TEST_CASE(string_counter_operations) {
+    mt19937 gen(12);
+    vector<string> elements = test::edgeStrings();
+
+    for (int round = 0; round < 20; round++) {
+        StringCounter a;
+        StringCounter b;
+        map<string, count_t> ref_a;
+        map<string, count_t> ref_b;
+
+        size_t n = gen() % 400;
+        for (size_t i = 0; i < n; i++) {
+            const string& element = elements[gen() % elements.size()];
+            bool to_a = gen() % 2;
+            StringCounter& counter = to_a ? a : b;
+            map<string, count_t>& ref = to_a ? ref_a : ref_b;
+            if (gen() % 4 == 0) {
+                counter.remove(element);
+                remove(ref, element);
+            }
+            else {
+                counter.insert(element);
+                insert(ref, element);
+            }
+
+            if (gen() % 16 == 0) {
+                CHECK_EQ(counter.count(element), ref.count(element) ? ref[element] : 0);
+            }
+        }
+
+        CHECK(a.getDict() == ref_a);
+        CHECK(b.getDict() == ref_b);
+        CHECK_EQ(a.total(), total(ref_a));
+        CHECK_EQ(a.unique(), ref_a.size());
+        CHECK_EQ(a.intersectionCount(b), intersectionCount(ref_a, ref_b));
+        CHECK_EQ(b.intersectionCount(a), intersectionCount(ref_a, ref_b));
+        CHECK_EQ(a.unionCount(b), total(ref_a) + total(ref_b) - intersectionCount(ref_a, ref_b));
+        CHECK_EQ(a.elements().size(), ref_a.size());
+        for (const string& element : elements) {
+            CHECK_EQ(a.count(element), ref_a.count(element) ? ref_a[element] : 0);
+        }
+
+        const vector<CounterEntry>& entries = a.getEntries();
+        for (size_t i = 0; i + 1 < entries.size(); i++) {
+            CHECK(entries[i].hash < entries[i + 1].hash || (entries[i].hash == entries[i + 1].hash && entries[i].element < entries[i + 1].element));
+        }
+        for (const CounterEntry& entry : entries) {
+            CHECK_EQ(entry.hash, StringCounter::hashElement(entry.element));
+        }
+    }
+}
+
+TEST_CASE(string_counter_from_list) {
+    mt19937 gen(13);
+    vector<string> elements = test::edgeStrings();
+    for (int round = 0; round < 20; round++) {
+        vector<string> list;
+        map<string, count_t> ref;
+        size_t n = gen() % 200;
+        for (size_t i = 0; i < n; i++) {
+            list.push_back(elements[gen() % elements.size()]);
+            insert(ref, list.back());
+        }
+
+        StringCounter counter = StringCounter::fromList(list);
+        CHECK(counter.getDict() == ref);
+        CHECK_EQ(counter.total(), n);
+        CHECK_EQ(counter.unique(), ref.size());
+    }
+
+    StringCounter empty;
+    CHECK_EQ(empty.total(), 0ul);
+    CHECK_EQ(empty.unique(), 0ul);
+    CHECK_EQ(empty.count(""), 0ul);
+    CHECK_EQ(empty.intersectionCount(StringCounter::fromList(elements)), 0ul);
+}
+
+TEST_CASE(string_counter_hash_is_portable) {
+    // Element hashes decide the order of entries, and should not depend on the standard library.
+    CHECK_EQ(StringCounter::hashElement("abc"), hashString("abc"));
+    CHECK_EQ(StringCounter::hashElement(""), hashString(""));
+    CHECK(StringCounter::hashElement("ab") != StringCounter::hashElement("ba"));
+}
+
+TEST_CASE(id_counter_operations) {
+    mt19937 gen(14);
+    for (int round = 0; round < 20; round++) {
+        IdCounter a;
+        IdCounter b;
+        map<token_id, count_t> ref_a;
+        map<token_id, count_t> ref_b;
+
+        size_t n = gen() % 400;
+        for (size_t i = 0; i < n; i++) {
+            token_id id = gen() % 50;
+            bool to_a = gen() % 2;
+            IdCounter& counter = to_a ? a : b;
+            map<token_id, count_t>& ref = to_a ? ref_a : ref_b;
+            if (gen() % 4 == 0) {
+                counter.remove(id);
+                auto it = ref.find(id);
+                if (it != ref.end() && --it->second == 0) {
+                    ref.erase(it);
+                }
+            }
+            else {
+                counter.insert(id);
+                ref[id]++;
+            }
+        }
+
+        CHECK_EQ(a.total(), total(ref_a));
+        CHECK_EQ(a.unique(), ref_a.size());
+        CHECK_EQ(a.intersectionCount(b), intersectionCount(ref_a, ref_b));
+        CHECK_EQ(a.unionCount(b), total(ref_a) + total(ref_b) - intersectionCount(ref_a, ref_b));
+        for (token_id id = 0; id < 50; id++) {
+            CHECK_EQ(a.count(id), ref_a.count(id) ? ref_a[id] : 0);
+        }
+
+        vector<token_id> list;
+        for (const auto& entry : ref_a) {
+            list.insert(list.end(), entry.second, entry.first);
+        }
+        shuffle(list.begin(), list.end(), gen);
+        IdCounter from_list = IdCounter::fromList(list);
+        CHECK(from_list.ids == a.ids);
+        CHECK(from_list.counts == a.counts);
+    }
+}
@@ -0,0 +1,196 @@
+/**
+ * @file test_dameraulevenshtein.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Tests of the optimal string alignment and unrestricted Damerau-Levenshtein distances.
+ * @date 2022-04-24
+ *
+ */
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "stringcompare/distance/dameraulevenshtein.h"
+
+#include "reference.h"
+#include "test.h"
+
+using namespace std;
+using namespace stringcompare;
+
+namespace {
+
+    typedef vector<vector<int>> Matrix;
+
+    template<class Distance>
+    Matrix distanceMatrix(const vector<string>& l, const Distance& distance) {
+        Matrix d;
+        for (const string& s : l) {
+            d.emplace_back();
+            for (const string& t : l) {
+                d.back().push_back(distance(s, t));
+            }
+        }
+        return d;
+    }
+
+    const Matrix& osaMatrix(const vector<string>& l) {
+        static Matrix d = distanceMatrix(l, [](const string& s, const string& t) { return reference::osa(s, t); });
+        return d;
+    }
+
+    const Matrix& unrestrictedMatrix(const vector<string>& l) {
+        static Matrix d = distanceMatrix(l, [](const string& s, const string& t) { return reference::damerauLevenshtein(s, t); });
+        return d;
+    }
+
+    /**
+     * @brief Check a distance bounded by `max_dist`: exact if at most `max_dist`, and above `max_dist` otherwise.
+     */
+    void checkBounded(int bounded, int exact, int max_dist) {
+        CHECK((exact <= max_dist) ? (bounded == exact) : (bounded > max_dist));
+    }
+
+    void checkCutoffRow(const double* values, const vector<double>& exact, double cutoff, bool similarity) {
+        for (size_t j = 0; j < exact.size(); j++) {
+            if (reference::beats(exact[j], cutoff, similarity)) {
+                CHECK_NEAR(values[j], exact[j]);
+            }
+            else {
+                CHECK(!reference::beats(values[j], cutoff, similarity) || test::near(values[j], exact[j]));
+            }
+        }
+    }
+
+    /**
+     * @brief Check the comparator, its batch and view functions, and its cached comparator against exact distances.
+     */
+    void checkComparator(const vector<string>& l, const Matrix& d, bool unrestricted) {
+        vector<string_view> views(l.begin(), l.end());
+        for (bool normalize : { true, false }) {
+            for (bool similarity : { false, true }) {
+                DamerauLevenshtein comparator(normalize, similarity, 100, unrestricted);
+                vector<double> out(l.size());
+                for (size_t i = 0; i < l.size(); i++) {
+                    vector<double> exact(l.size());
+                    for (size_t j = 0; j < l.size(); j++) {
+                        exact[j] = reference::editScore(d[i][j], l[i].size() + l[j].size(), normalize, similarity);
+                    }
+
+                    DamerauLevenshtein::Cached cached = comparator.prepare(l[i]);
+                    for (size_t j = 0; j < l.size(); j++) {
+                        CHECK_NEAR(comparator.compare(l[i], l[j]), exact[j]);
+                        CHECK_NEAR(comparator.compareViews(views[i], views[j]), exact[j]);
+                        CHECK_NEAR(cached.compare(l[j]), exact[j]);
+                        CHECK_EQ(cached.dameraulevenshtein(l[j]), d[i][j]);
+                    }
+                    comparator.compareMany(l[i], l.data(), l.size(), out.data());
+                    for (size_t j = 0; j < l.size(); j++) {
+                        CHECK_NEAR(out[j], exact[j]);
+                    }
+
+                    for (double cutoff : { 0.0, 0.3, 0.5, 2.0, 10.0 }) {
+                        comparator.compareMany(l[i], l.data(), l.size(), out.data(), cutoff);
+                        checkCutoffRow(out.data(), exact, cutoff, similarity);
+                        comparator.compareManyViews(views[i], views.data(), views.size(), out.data(), cutoff);
+                        checkCutoffRow(out.data(), exact, cutoff, similarity);
+                        cached.compareMany(l.data(), l.size(), out.data(), cutoff);
+                        checkCutoffRow(out.data(), exact, cutoff, similarity);
+                    }
+                }
+            }
+        }
+    }
+
+}
+
+TEST_CASE(osa_distance) {
+    vector<string> l = test::sampleStrings();
+    const Matrix& d = osaMatrix(l);
+    test::forEachCpuLevel([&] {
+        for (size_t i = 0; i < l.size(); i++) {
+            PatternMatchVector pm;
+            BlockPatternMatchVector block_pm(l[i]);
+            int m = l[i].size();
+            if (m <= 64) {
+                pm.insert(l[i]);
+            }
+
+            for (size_t j = 0; j < l.size(); j++) {
+                CHECK_EQ(DamerauLevenshtein::dameraulevenshtein(l[i], l[j]), d[i][j]);
+                for (int k : { 0, 1, 3, 70 }) {
+                    checkBounded(DamerauLevenshtein::dameraulevenshtein(l[i], l[j], k), d[i][j], k);
+                }
+
+                // Kernels, with the pattern as the first string.
+                if (m == 0) {
+                    continue;
+                }
+                if (m <= 64) {
+                    CHECK_EQ(DamerauLevenshtein::osa(pm, m, l[j]), d[i][j]);
+                    checkBounded(DamerauLevenshtein::osa(pm, m, l[j], 2), d[i][j], 2);
+                }
+                CHECK_EQ(DamerauLevenshtein::osaBlock(block_pm, m, l[j]), d[i][j]);
+                checkBounded(DamerauLevenshtein::osaBlock(block_pm, m, l[j], 2), d[i][j], 2);
+            }
+        }
+    });
+
+    // Transpositions of adjacent characters, which are not edited again.
+    CHECK_EQ(DamerauLevenshtein::dameraulevenshtein(string("ab"), string("ba")), 1);
+    CHECK_EQ(DamerauLevenshtein::dameraulevenshtein(string("ca"), string("abc")), 3);
+    CHECK_EQ(DamerauLevenshtein::dameraulevenshtein(string(64, 'a') + "bc", string(64, 'a') + "cb"), 1);
+}
+
+TEST_CASE(unrestricted_damerau_levenshtein_distance) {
+    vector<string> l = test::sampleStrings();
+    const Matrix& d = unrestrictedMatrix(l);
+    for (size_t i = 0; i < l.size(); i++) {
+        for (size_t j = 0; j < l.size(); j++) {
+            CHECK_EQ(DamerauLevenshtein::unrestrictedDamerauLevenshtein(l[i], l[j]), d[i][j]);
+            for (int k : { 0, 1, 3, 70 }) {
+                checkBounded(DamerauLevenshtein::unrestrictedDamerauLevenshtein(l[i], l[j], k), d[i][j], k);
+            }
+        }
+    }
+    CHECK_EQ(DamerauLevenshtein::unrestrictedDamerauLevenshtein(string("ca"), string("abc")), 2);
+}
+
+TEST_CASE(osa_comparator) {
+    vector<string> l = test::sampleStrings();
+    const Matrix& d = osaMatrix(l);
+    test::forEachCpuLevel([&] {
+        checkComparator(l, d, false);
+    });
+}
+
+TEST_CASE(unrestricted_damerau_levenshtein_comparator) {
+    vector<string> l = test::sampleStrings();
+    checkComparator(l, unrestrictedMatrix(l), true);
+}
+
+TEST_CASE(static_damerau_levenshtein) {
+    vector<string> l = test::sampleStrings();
+    const Matrix& d = osaMatrix(l);
+    test::forEachCpuLevel([&] {
+        StaticDamerauLevenshtein<true, false> comparator;
+        DynamicComparator<StaticDamerauLevenshtein<false, true>> dynamic;
+        vector<double> out(l.size());
+        for (size_t i = 0; i < l.size(); i++) {
+            vector<double> exact(l.size());
+            for (size_t j = 0; j < l.size(); j++) {
+                exact[j] = reference::editScore(d[i][j], l[i].size() + l[j].size(), true, false);
+                CHECK_NEAR(dynamic.compare(l[i], l[j]), reference::editScore(d[i][j], l[i].size() + l[j].size(), false, true));
+            }
+
+            comparator.compareMany(l[i], l.data(), l.size(), out.data());
+            for (size_t j = 0; j < l.size(); j++) {
+                CHECK_NEAR(out[j], exact[j]);
+            }
+            for (double cutoff : { 0.0, 0.25, 0.6 }) {
+                comparator.compareMany(l[i], l.data(), l.size(), out.data(), cutoff);
+                checkCutoffRow(out.data(), exact, cutoff, false);
+            }
+        }
+    });
+}
@@ -0,0 +1,179 @@
+/**
+ * @file test_dispatch.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Tests of the bit-parallel Jaro and LCS kernels and of the vectorized Hamming kernels, at each instruction set
+ * level.
+ * @date 2022-04-24
+ *
+ */
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "stringcompare/distance/hamming.h"
+#include "stringcompare/distance/jaro.h"
+#include "stringcompare/distance/jarowinkler.h"
+#include "stringcompare/distance/lcs.h"
+#include "stringcompare/utils/cpu.h"
+#include "stringcompare/utils/unicode.h"
+
+#include "reference.h"
+#include "test.h"
+
+using namespace std;
+using namespace stringcompare;
+
+namespace {
+
+    /**
+     * @brief Check a similarity with a cutoff: exact if it reaches the cutoff, and 0 otherwise.
+     */
+    void checkSimilarityCutoff(double value, double exact, double cutoff) {
+        if (exact >= cutoff + 1e-9) {
+            CHECK_NEAR(value, exact);
+        }
+        else if (exact < cutoff - 1e-9) {
+            CHECK_EQ(value, 0.0);
+        }
+        else {
+            CHECK(value == 0.0 || test::near(value, exact));
+        }
+    }
+
+    vector<u32string> codePoints(const vector<string>& l) {
+        vector<u32string> result(l.size());
+        for (size_t i = 0; i < l.size(); i++) {
+            decodeUtf8(l[i], result[i]);
+        }
+        return result;
+    }
+
+}
+
+TEST_CASE(jaro_kernels) {
+    vector<string> l = test::sampleStrings();
+    vector<u32string> u = codePoints(l);
+    vector<vector<double>> exact(l.size(), vector<double>(l.size()));
+    vector<vector<double>> exact_u(l.size(), vector<double>(l.size()));
+    for (size_t i = 0; i < l.size(); i++) {
+        for (size_t j = 0; j < l.size(); j++) {
+            exact[i][j] = reference::jaro(l[i], l[j]);
+            exact_u[i][j] = reference::jaro(u[i], u[j]);
+        }
+    }
+
+    test::forEachCpuLevel([&] {
+        for (size_t i = 0; i < l.size(); i++) {
+            Jaro::Cached cached = Jaro(true).prepare(l[i]);
+            for (size_t j = 0; j < l.size(); j++) {
+                CHECK_NEAR(Jaro::jaro(l[i], l[j]), exact[i][j]);
+                CHECK_NEAR(Jaro::jaro(string_view(l[i]), string_view(l[j])), exact[i][j]);
+                CHECK_NEAR(Jaro::jaro(u[i], u[j]), exact_u[i][j]);
+                CHECK_NEAR(cached.compare(l[j]), exact[i][j]);
+                CHECK_NEAR(Jaro().compare(l[i], l[j]), 1 - exact[i][j]);
+                for (double cutoff : { 0.3, 0.7, 0.9, 1.0 }) {
+                    checkSimilarityCutoff(Jaro::jaro(l[i], l[j], cutoff), exact[i][j], cutoff);
+                    checkSimilarityCutoff(cached.compare(l[j], cutoff), exact[i][j], cutoff);
+                }
+            }
+        }
+    });
+}
+
+TEST_CASE(jarowinkler_kernels) {
+    vector<string> l = test::sampleStrings(7);
+    test::forEachCpuLevel([&] {
+        for (size_t i = 0; i < l.size(); i++) {
+            JaroWinkler::Cached cached = JaroWinkler(true).prepare(l[i]);
+            vector<double> out(l.size());
+            JaroWinkler(true).compareMany(l[i], l.data(), l.size(), out.data());
+            for (size_t j = 0; j < l.size(); j++) {
+                double exact = reference::jaroWinkler(l[i], l[j]);
+                CHECK_NEAR(JaroWinkler::jarowinkler(l[i], l[j]), exact);
+                CHECK_NEAR(JaroWinkler::jarowinkler(l[i], l[j], 0.2), reference::jaroWinkler(l[i], l[j], 0.2));
+                CHECK_NEAR(cached.compare(l[j]), exact);
+                CHECK_NEAR(out[j], exact);
+                CHECK_NEAR(JaroWinkler().compare(l[i], l[j]), 1 - exact);
+                for (double cutoff : { 0.5, 0.8, 0.95, 1.0 }) {
+                    checkSimilarityCutoff(JaroWinkler::jarowinkler(l[i], l[j], 0.1, cutoff), exact, cutoff);
+                    checkSimilarityCutoff(cached.compare(l[j], cutoff), exact, cutoff);
+                }
+            }
+        }
+    });
+}
+
+TEST_CASE(lcs_kernels) {
+    vector<string> l = test::sampleStrings(8);
+    vector<u32string> u = codePoints(l);
+    vector<vector<int>> exact(l.size(), vector<int>(l.size()));
+    for (size_t i = 0; i < l.size(); i++) {
+        for (size_t j = 0; j < l.size(); j++) {
+            exact[i][j] = reference::lcs(l[i], l[j]);
+        }
+    }
+
+    test::forEachCpuLevel([&] {
+        for (size_t i = 0; i < l.size(); i++) {
+            LCSDistance::Cached cached = LCSDistance(false, false).prepare(l[i]);
+            for (size_t j = 0; j < l.size(); j++) {
+                CHECK_EQ(LCSDistance::lcs(l[i], l[j]), exact[i][j]);
+                CHECK_EQ(LCSDistance::lcs(u[i], u[j]), reference::lcs(u[i], u[j]));
+                CHECK_NEAR(cached.compare(l[j]), l[i].size() + l[j].size() - 2.0 * exact[i][j]);
+                for (int min_length : { 1, 3, 40, 70 }) {
+                    int length = LCSDistance::lcs(l[i], l[j], min_length);
+                    CHECK((exact[i][j] >= min_length) ? (length == exact[i][j]) : (length < min_length));
+                }
+            }
+        }
+    });
+}
+
+TEST_CASE(hamming_kernels) {
+    vector<string> l = test::sampleStrings(9);
+    test::forEachCpuLevel([&] {
+        for (size_t i = 0; i < l.size(); i++) {
+            for (size_t j = 0; j < l.size(); j++) {
+                int n = min(l[i].size(), l[j].size());
+                int exact = 0;
+                for (int k = 0; k < n; k++) {
+                    exact += (l[i][k] != l[j][k]);
+                }
+                CHECK_EQ(Hamming::mismatches(l[i].data(), l[j].data(), n), exact);
+                CHECK_EQ(Hamming::hamming(l[i], l[j]), reference::hamming(l[i], l[j]));
+            }
+        }
+
+        // Every length around the widths of vector registers, with mismatches at the ends.
+        for (int n = 0; n <= 200; n++) {
+            string s(n, 'a');
+            string t(n, 'a');
+            int exact = 0;
+            for (int k = 0; k < n; k += 1 + k % 7) {
+                t[k] = 'b';
+                exact++;
+            }
+            if (n > 0 && t[n - 1] == 'a') {
+                t[n - 1] = 'c';
+                exact++;
+            }
+            CHECK_EQ(Hamming::mismatches(s.data(), t.data(), n), exact);
+        }
+    });
+}
+
+TEST_CASE(cpu_levels) {
+    CpuLevel detected = detectCpuLevel();
+    for (int level = CPU_SCALAR; level <= CPU_AVX512; level++) {
+        setCpuLevel(CpuLevel(level));
+        CHECK_EQ((int)cpuLevel(), min(level, (int)detected));
+    }
+    setCpuLevel(CPU_AVX512);
+    CHECK_EQ((int)cpuLevel(), (int)detected);
+
+    CHECK_EQ(string(cpuLevelName(CPU_SCALAR)), string("scalar"));
+    CHECK_EQ(string(cpuLevelName(CPU_SSE42)), string("sse4.2"));
+    CHECK_EQ(string(cpuLevelName(CPU_AVX2)), string("avx2"));
+    CHECK_EQ(string(cpuLevelName(CPU_AVX512)), string("avx512"));
+}
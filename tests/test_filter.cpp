@@ -0,0 +1,135 @@
+/**
+ * @file test_filter.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Tests of filter cascades against exact comparisons.
+ * @date 2022-04-24
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include "stringcompare/distance/filter.h"
+#include "stringcompare/utils/stringcolumn.h"
+
+#include "reference.h"
+#include "test.h"
+
+using namespace std;
+using namespace stringcompare;
+
+namespace {
+
+    /**
+     * @brief Check comparisons with a cutoff: values beating the cutoff are exact, and others do not beat it.
+     */
+    void checkCutoff(double value, double exact, double cutoff, bool similarity) {
+        if (reference::beats(exact, cutoff, similarity)) {
+            CHECK_NEAR(value, exact);
+        }
+        else {
+            CHECK(!reference::beats(value, cutoff, similarity) || test::near(value, exact));
+        }
+    }
+
+    void checkStats(const FilterStats& stats, size_t pairs, size_t stages) {
+        CHECK_EQ(stats.pairs, pairs);
+        CHECK_EQ(stats.pruned.size(), stages);
+        size_t sum = stats.compared;
+        for (size_t count : stats.pruned) {
+            sum += count;
+        }
+        CHECK_EQ(sum, pairs);
+    }
+
+    /**
+     * @brief Check a filter cascade over `comparator` against exact values `exact(s, t)` from naive references, for
+     * each set of stages and cutoff.
+     */
+    template<class C, class Exact>
+    void checkCascade(const C& comparator, const Exact& exact, const vector<double>& cutoffs) {
+        vector<string> l = test::sampleStrings(5, 30);
+        vector<string> reversed(l.rbegin(), l.rend());
+        StringColumn column(l);
+        size_t n = l.size();
+        bool similarity = comparator.isSimilarity();
+
+        vector<vector<double>> expected(n, vector<double>(n));
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                expected[i][j] = exact(l[i], l[j]);
+            }
+        }
+
+        vector<vector<FilterStage>> stage_sets = { {}, { LENGTH_FILTER }, { HISTOGRAM_FILTER }, { LENGTH_FILTER, HISTOGRAM_FILTER } };
+        for (const auto& stages : stage_sets) {
+            FilterCascade<C> cascade(comparator, stages);
+            CHECK_EQ(cascade.isSimilarity(), similarity);
+            for (size_t i = 0; i < n; i++) {
+                CHECK_NEAR(cascade.compare(l[i], l[(i * 5) % n]), expected[i][(i * 5) % n]);
+            }
+
+            for (double cutoff : cutoffs) {
+                FilterStats stats;
+                Mat<double> pairwise = cascade.pairwise(l, l, cutoff, 3, &stats);
+                checkStats(stats, n * n, stages.size());
+                for (size_t i = 0; i < n; i++) {
+                    for (size_t j = 0; j < n; j++) {
+                        checkCutoff(pairwise[i][j], expected[i][j], cutoff, similarity);
+                        // Rejected pairs get the comparator's own value.
+                        CHECK_NEAR(pairwise[i][j], comparator.compare(l[i], l[j], cutoff));
+                    }
+                }
+
+                FilterStats condensed_stats;
+                vector<double> condensed = cascade.condensed(column, cutoff, 1, &condensed_stats);
+                checkStats(condensed_stats, n * (n - 1) / 2, stages.size());
+                for (size_t i = 0; i < n; i++) {
+                    for (size_t j = i + 1; j < n; j++) {
+                        CHECK_NEAR(condensed[condensedIndex(n, i, j)], pairwise[i][j]);
+                    }
+                }
+
+                vector<double> elementwise = cascade.elementwise(l, reversed, cutoff, 2);
+                for (size_t i = 0; i < n; i++) {
+                    CHECK_NEAR(elementwise[i], pairwise[i][n - 1 - i]);
+                    CHECK_NEAR(cascade.compare(l[i], reversed[i], cutoff), pairwise[i][n - 1 - i]);
+                }
+            }
+        }
+        CHECK_THROWS(FilterCascade<C>(comparator).elementwise(l, vector<string>{}, cutoffs[0]));
+    }
+
+}
+
+TEST_CASE(filter_edit_distances) {
+    for (bool normalize : { true, false }) {
+        for (bool similarity : { false, true }) {
+            vector<double> cutoffs = normalize ? vector<double>{ 0.0, 0.2, 0.5, 0.8, 1.0 } : vector<double>{ 0.0, 1.0, 3.0, 10.0 };
+            checkCascade(Levenshtein(normalize, similarity), [&](const string& s, const string& t) {
+                return reference::editScore(reference::levenshtein(s, t), s.size() + t.size(), normalize, similarity);
+            }, cutoffs);
+            checkCascade(DamerauLevenshtein(normalize, similarity), [&](const string& s, const string& t) {
+                return reference::editScore(reference::osa(s, t), s.size() + t.size(), normalize, similarity);
+            }, cutoffs);
+            checkCascade(LCSDistance(normalize, similarity), [&](const string& s, const string& t) {
+                double len = s.size() + t.size();
+                return reference::editScore(len - 2 * reference::lcs(s, t), len, normalize, similarity);
+            }, cutoffs);
+        }
+    }
+}
+
+TEST_CASE(filter_jaro) {
+    for (bool similarity : { false, true }) {
+        vector<double> cutoffs = { 0.0, 0.3, 0.7, 0.9, 1.0 };
+        checkCascade(Jaro(similarity), [&](const string& s, const string& t) {
+            double sim = reference::jaro(s, t);
+            return similarity ? sim : 1 - sim;
+        }, cutoffs);
+        checkCascade(JaroWinkler(similarity), [&](const string& s, const string& t) {
+            double sim = reference::jaroWinkler(s, t);
+            return similarity ? sim : 1 - sim;
+        }, cutoffs);
+    }
+}
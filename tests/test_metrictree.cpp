@@ -0,0 +1,148 @@
+/**
+ * @file test_metrictree.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Tests of the BK-tree and vantage-point tree against brute-force search.
+ * @date 2022-04-24
+ *
+ */
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "stringcompare/distance/dameraulevenshtein.h"
+#include "stringcompare/distance/levenshtein.h"
+#include "stringcompare/index/bktree.h"
+#include "stringcompare/index/vptree.h"
+
+#include "reference.h"
+#include "test.h"
+
+using namespace std;
+using namespace stringcompare;
+
+namespace {
+
+    typedef vector<pair<size_t, double>> Matches;
+
+    bool closer(const pair<size_t, double>& a, const pair<size_t, double>& b) {
+        return (a.second < b.second) || (a.second == b.second && a.first < b.first);
+    }
+
+    /**
+     * @brief All strings with their distance to `query`, sorted by distance and then id.
+     */
+    template<class Distance>
+    Matches bruteForce(const vector<string>& l, const string& query, const Distance& distance) {
+        Matches result;
+        for (size_t id = 0; id < l.size(); id++) {
+            result.emplace_back(id, distance(query, l[id]));
+        }
+        sort(result.begin(), result.end(), closer);
+        return result;
+    }
+
+    Matches within(const Matches& all, double r) {
+        Matches result;
+        for (const auto& match : all) {
+            if (match.second <= r) {
+                result.push_back(match);
+            }
+        }
+        return result;
+    }
+
+    Matches first(const Matches& all, size_t n) {
+        return Matches(all.begin(), all.begin() + min(n, all.size()));
+    }
+
+    vector<string> indexedStrings(unsigned seed) {
+        mt19937 gen(seed);
+        vector<string> l = test::edgeStrings();
+        for (const string& s : test::randomStrings(gen, 200, 10, 3)) {
+            l.push_back(s);
+        }
+        for (const string& s : test::randomStrings(gen, 20, 90, 3)) {
+            l.push_back(s);
+        }
+        return l;
+    }
+
+    vector<string> queries(unsigned seed) {
+        mt19937 gen(seed);
+        vector<string> result = { "", "a", "héllo", "日本", string(64, 'a'), string(66, 'a') + "c" };
+        for (const string& s : test::randomStrings(gen, 25, 12, 3)) {
+            result.push_back(s);
+        }
+        return result;
+    }
+
+    template<class C, class Distance>
+    void checkBKTree(const C& comparator, const Distance& distance) {
+        vector<string> l = indexedStrings(41);
+        BKTree<C> tree(comparator);
+        tree.insert(l);
+        CHECK_EQ(tree.size(), l.size());
+
+        for (const string& query : queries(42)) {
+            Matches all = bruteForce(l, query, distance);
+            for (int k : { -1, 0, 1, 2, 3, 6, 70 }) {
+                CHECK(tree.range(query, k) == within(all, k));
+            }
+            for (size_t n : { 0, 1, 3, 10, 1000 }) {
+                CHECK(tree.nearest(query, n) == first(all, n));
+            }
+        }
+    }
+
+}
+
+TEST_CASE(bktree_levenshtein) {
+    checkBKTree(Levenshtein(false, false), [](const string& s, const string& t) {
+        return (double)reference::levenshtein(s, t);
+    });
+    CHECK_THROWS(BKTree<Levenshtein>(Levenshtein(false, true)));
+
+    BKTree<Levenshtein> empty;
+    CHECK(empty.range("a", 3).empty());
+    CHECK(empty.nearest("a", 3).empty());
+}
+
+TEST_CASE(bktree_damerau_levenshtein) {
+    checkBKTree(DamerauLevenshtein(false, false, 100, true), [](const string& s, const string& t) {
+        return (double)reference::damerauLevenshtein(s, t);
+    });
+}
+
+TEST_CASE(vptree_levenshtein) {
+    vector<string> l = indexedStrings(43);
+    Levenshtein comparator;
+    VPTree<Levenshtein> tree(l, comparator);
+    CHECK_EQ(tree.size(), l.size());
+
+    for (const string& query : queries(44)) {
+        // Expected matches use the comparator's own distances, so that ties are broken as in the tree, and these
+        // distances are checked against the reference.
+        Matches all = bruteForce(l, query, [&](const string& s, const string& t) {
+            return comparator.compare(s, t);
+        });
+        for (const auto& match : all) {
+            const string& t = l[match.first];
+            CHECK_NEAR(match.second, reference::editScore(reference::levenshtein(query, t), query.size() + t.size(), true, false));
+        }
+
+        for (double r : { -1.0, 0.0, 0.1, 0.25, 0.5, 1.0 }) {
+            CHECK(tree.range(query, r) == within(all, r));
+        }
+        for (size_t n : { 0, 1, 3, 10, 1000 }) {
+            CHECK(tree.nearest(query, n) == first(all, n));
+        }
+    }
+
+    CHECK_THROWS(VPTree<Levenshtein>(l, Levenshtein(true, true)));
+    VPTree<Levenshtein> empty(vector<string>{});
+    CHECK(empty.range("a", 0.5).empty());
+    CHECK(empty.nearest("a", 3).empty());
+}
@@ -0,0 +1,136 @@
+/**
+ * @file test_qgram.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Tests of the q-gram index against brute-force range search.
+ * @date 2022-04-24
+ *
+ */
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "stringcompare/index/qgram.h"
+
+#include "reference.h"
+#include "test.h"
+
+using namespace std;
+using namespace stringcompare;
+
+namespace {
+
+    /**
+     * @brief Check the searches of an index whose string `i` is `strings[i]` if `alive[i]`, against brute force.
+     */
+    void checkSearches(const QGramIndex& index, const vector<string>& strings, const vector<bool>& alive, const vector<string>& queries) {
+        for (const string& query : queries) {
+            for (int k : { 0, 1, 2, 4 }) {
+                vector<pair<size_t, int>> expected;
+                vector<pair<size_t, int>> expected_damerau;
+                for (size_t id = 0; id < strings.size(); id++) {
+                    if (!alive[id]) {
+                        continue;
+                    }
+                    int dist = reference::levenshtein(query, strings[id]);
+                    if (dist <= k) {
+                        expected.emplace_back(id, dist);
+                    }
+                    int osa = reference::osa(query, strings[id]);
+                    if (osa <= k) {
+                        expected_damerau.emplace_back(id, osa);
+                    }
+                }
+
+                CHECK(index.search(query, k) == expected);
+                CHECK(index.searchDamerau(query, k) == expected_damerau);
+
+                // Candidates are sorted, alive, and include all matches.
+                vector<size_t> candidates = index.candidates(query, k);
+                CHECK(is_sorted(candidates.begin(), candidates.end()));
+                for (size_t id : candidates) {
+                    CHECK(alive[id]);
+                }
+                for (const auto& match : expected) {
+                    CHECK(binary_search(candidates.begin(), candidates.end(), match.first));
+                }
+            }
+        }
+    }
+
+}
+
+TEST_CASE(qgram_search) {
+    mt19937 gen(31);
+    vector<string> strings = test::edgeStrings();
+    for (const string& s : test::randomStrings(gen, 150, 14, 3)) {
+        strings.push_back(s);
+    }
+    vector<string> queries = test::randomStrings(gen, 15, 14, 3);
+    queries.push_back("");
+    queries.push_back("héllo");
+    queries.push_back(string(65, 'a'));
+
+    for (int q : { 1, 2, 3 }) {
+        QGramIndex index(q);
+        index.insert(strings);
+        CHECK_EQ(index.size(), strings.size());
+        checkSearches(index, strings, vector<bool>(strings.size(), true), queries);
+    }
+    CHECK_THROWS(QGramIndex(0));
+}
+
+TEST_CASE(qgram_remove) {
+    mt19937 gen(32);
+    vector<string> strings = test::edgeStrings();
+    for (const string& s : test::randomStrings(gen, 150, 14, 3)) {
+        strings.push_back(s);
+    }
+    vector<string> queries = test::randomStrings(gen, 8, 14, 3);
+
+    for (int q : { 1, 2 }) {
+        QGramIndex index(q);
+        vector<string> indexed;
+        vector<bool> alive;
+        size_t count = 0;
+        for (int step = 0; step < 600; step++) {
+            if (count > 0 && gen() % 3 == 0) {
+                size_t id;
+                do {
+                    id = gen() % indexed.size();
+                } while (!alive[id]);
+                index.remove(id);
+                alive[id] = false;
+                count--;
+                CHECK(!index.contains(id));
+                CHECK_THROWS(index.remove(id));
+                CHECK_THROWS(index.get(id));
+            }
+            else {
+                const string& s = strings[gen() % strings.size()];
+                CHECK_EQ(index.insert(s), indexed.size());
+                indexed.push_back(s);
+                alive.push_back(true);
+                count++;
+            }
+
+            CHECK_EQ(index.size(), count);
+            CHECK(index.stale_entries <= index.entries);
+            CHECK(2 * index.stale_entries <= index.entries);
+            if (step % 100 == 99) {
+                checkSearches(index, indexed, alive, queries);
+            }
+        }
+
+        index.compact();
+        CHECK_EQ(index.stale_entries, 0ul);
+        checkSearches(index, indexed, alive, queries);
+        for (size_t id = 0; id < indexed.size(); id++) {
+            if (alive[id]) {
+                CHECK_EQ(index.get(id), indexed[id]);
+            }
+        }
+    }
+}
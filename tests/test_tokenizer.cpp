@@ -0,0 +1,161 @@
+/**
+ * @file test_tokenizer.cpp
+ * @author Olivier Binette (https://olivierbinette.ca)
+ * @brief Tests of zero-copy tokenizers and of the token vocabulary.
+ * @date 2022-04-24
+ *
+ */
+
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "stringcompare/preprocessing/tokenizer.h"
+#include "stringcompare/preprocessing/vocabulary.h"
+#include "stringcompare/utils/stringcolumn.h"
+
+#include "test.h"
+
+using namespace std;
+using namespace stringcompare;
+
+namespace {
+
+    vector<string> splitTokens(const string& s, const string& delim) {
+        vector<string> result;
+        size_t pos = 0;
+        while (pos <= s.size()) {
+            size_t match = s.find(delim, pos);
+            if (match == string::npos) {
+                match = s.size();
+            }
+            if (match > pos) {
+                result.push_back(s.substr(pos, match - pos));
+            }
+            pos = match + delim.size();
+        }
+        return result;
+    }
+
+    vector<string> ngramTokens(const string& s, size_t n) {
+        vector<string> result;
+        for (size_t i = 0; i + n <= s.size(); i++) {
+            result.push_back(s.substr(i, n));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Sentences of words separated by single or repeated spaces and commas.
+     */
+    vector<string> sentences() {
+        mt19937 gen(21);
+        vector<string> words = test::edgeStrings();
+        vector<string> result = { "", " ", "  ", ",", "a", " a ", "a  b", "a, b,, c" };
+        for (int i = 0; i < 200; i++) {
+            string s;
+            size_t n = gen() % 8;
+            for (size_t k = 0; k < n; k++) {
+                s += words[gen() % words.size()];
+                s += (gen() % 3 == 0) ? ", " : string(1 + gen() % 2, ' ');
+            }
+            result.push_back(s);
+        }
+        return result;
+    }
+
+    void checkTokens(const Tokenizer& tokenizer, const string& s, const vector<string>& expected) {
+        vector<string_view> tokens = tokenizer.tokens(s);
+        CHECK_EQ(tokens.size(), expected.size());
+        for (size_t k = 0; k < min(tokens.size(), expected.size()); k++) {
+            CHECK_EQ(string(tokens[k]), expected[k]);
+            CHECK(tokens[k].data() >= s.data() && tokens[k].data() + tokens[k].size() <= s.data() + s.size());
+        }
+
+        map<string, count_t> counts;
+        for (const string& token : expected) {
+            counts[token]++;
+        }
+        CHECK(tokenizer.tokenize(s).getDict() == counts);
+    }
+
+}
+
+TEST_CASE(tokenizer_tokens) {
+    for (const string& s : sentences()) {
+        checkTokens(WhitespaceTokenizer(), s, splitTokens(s, " "));
+        checkTokens(DelimTokenizer(", "), s, splitTokens(s, ", "));
+        for (size_t n : { 1, 2, 3, 5 }) {
+            checkTokens(NGramTokenizer(n), s, ngramTokens(s, n));
+        }
+    }
+    CHECK(NGramTokenizer(0).tokens("abc").empty());
+    CHECK_THROWS(DelimTokenizer(""));
+}
+
+TEST_CASE(vocabulary_ids) {
+    Vocabulary vocabulary;
+    map<string, token_id> ref;
+    mt19937 gen(22);
+    vector<string> tokens = test::edgeStrings();
+    for (const string& s : test::randomStrings(gen, 3000, 6, 6)) {
+        tokens.push_back(s);
+    }
+
+    for (const string& token : tokens) {
+        auto it = ref.find(token);
+        token_id expected = (it == ref.end()) ? ref.size() : it->second;
+        ref.emplace(token, expected);
+        CHECK_EQ(vocabulary.id(token), expected);
+    }
+    CHECK_EQ(vocabulary.size(), ref.size());
+    for (const auto& entry : ref) {
+        CHECK(vocabulary.contains(entry.first));
+        CHECK_EQ(vocabulary.find(entry.first), entry.second);
+        CHECK_EQ(string(vocabulary.token(entry.second)), entry.first);
+    }
+    CHECK(!vocabulary.contains("not a token"));
+    CHECK_THROWS(vocabulary.find("not a token"));
+
+    Vocabulary copy = vocabulary;
+    vocabulary.clear();
+    CHECK_EQ(vocabulary.size(), 0ul);
+    CHECK_EQ(copy.size(), ref.size());
+    for (const auto& entry : ref) {
+        CHECK_EQ(copy.find(entry.first), entry.second);
+    }
+}
+
+TEST_CASE(tokenizer_ids) {
+    vector<string> l = sentences();
+    StringColumn column(l);
+    NGramTokenizer tokenizer(2);
+
+    Vocabulary vocabulary;
+    IdCounterBatch batch = tokenizer.batchTokenizeIds(l, vocabulary);
+    IdCounterBatch column_batch = tokenizer.batchTokenizeIds(column, vocabulary);
+    CHECK_EQ(batch.size(), l.size());
+    CHECK_EQ(column_batch.size(), l.size());
+
+    for (size_t i = 0; i < l.size(); i++) {
+        StringCounter counter = tokenizer.tokenize(l[i]);
+        IdCounter ids = tokenizer.tokenizeIds(l[i], vocabulary);
+        CHECK_EQ(ids.total(), counter.total());
+        CHECK_EQ(ids.unique(), counter.unique());
+        for (const CounterEntry& entry : counter.getEntries()) {
+            CHECK_EQ(ids.count(vocabulary.find(entry.element)), entry.count);
+            CHECK_EQ(batch[i].count(vocabulary.find(entry.element)), entry.count);
+            CHECK_EQ(column_batch[i].count(vocabulary.find(entry.element)), entry.count);
+        }
+        CHECK_EQ(batch[i].total(), counter.total());
+        CHECK_EQ(batch[i].unique(), counter.unique());
+
+        size_t j = (i * 7) % l.size();
+        StringCounter other = tokenizer.tokenize(l[j]);
+        CHECK_EQ(batch[i].intersectionCount(batch[j]), counter.intersectionCount(other));
+        CHECK_EQ(batch[i].unionCount(batch[j]), counter.unionCount(other));
+        CHECK_EQ(ids.intersectionCount(tokenizer.tokenizeIds(l[j], vocabulary)), counter.intersectionCount(other));
+    }
+}